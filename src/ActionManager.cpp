@@ -5,14 +5,15 @@
 */
 
 #include <stdio.h>
+#include <vector>
+#include <algorithm>
 #include "ActionManager.h"
+#include "Scene.h"
+#include "Clock.h"
 
 // TODO decommentare per abilitare il debug
 //#define ACTIONMANAGER_DEBUG
 
-// this is the maximum number of actions dealt by a single sequence  
-#define ACTIONMANAGER_MAX_SEQUENCE_ACTIONS		32
-
 /*
 	This class (AMSequence) is used internally by the ActionManager
 	DON'T SUBCLASS IN THE GAME!
@@ -22,59 +23,190 @@ class AMSequence {
 public:
 	// constructor
 	AMSequence( unsigned int tag );
+	// reset all data of the sequence
+	void			Init( unsigned int tag );
 	// unique identifier of sequence (for any possible delete operation)
 	unsigned int	tag;
 	// pointer to previous item in the linked list
 	AMSequence		*prev;
 	// pointer to next item in the linked list
 	AMSequence		*next;
-	// list of actions
-	Action			*actions[ ACTIONMANAGER_MAX_SEQUENCE_ACTIONS ];
+	// list of actions (array owned by the sequence object or the template the sequence comes from)
+	Action			**actions;
+	// storage of the action of sequences made of a single action
+	Action			*singleAction;
+	// sequence object that owns the list of actions (NULL if the actions have not been given as a sequence)
+	ActionsSequence	*owner;
 	// index of current action
 	unsigned int	currentAction;
 	// total number of actions in this sequence
 	unsigned int	totalActions;
+	// list (timing wheel slot or due list) containing the sequence while it is sleeping, NULL if active
+	AMSequence		**sleepList;
+	// timeline time (milliseconds) when the sequence has been parked
+	double			parkTime;
+	// timeline time (milliseconds) when the sequence must wake up
+	double			wakeTime;
+	// time slept (milliseconds) to pass to the delay action once the sequence is active again (negative if not woken up)
+	double			sleptTime;
+	// template the actions have been taken from (NULL if the actions belong to the sequence)
+	SequenceTemplate *source;
+	// true if the sequence is waiting for its start time (see RunTemplate)
+	bool			delayedStart;
 };
 
-// current total number of active sequences
-long				totalSequences = 0;
-// this is the head of the list of current active sequences
-AMSequence			*sequencesList = NULL;
+#define ACTIONMANAGER_WHEEL_SLOT_MASK		( ACTIONMANAGER_WHEEL_SLOTS - 1 )
+// total number of ticks covered by the wheel
+#define ACTIONMANAGER_WHEEL_SPAN			( (Uint64)1 << ( ACTIONMANAGER_WHEEL_SLOT_BITS * ACTIONMANAGER_WHEEL_LEVELS ) )
+
+// all existing timelines (the global one and one for each scene), it must be defined before the global timeline
+// because the constructor of the global timeline registers it here
+static std::vector<ActionTimeline*>	timelines;
+
+// this is the timeline of sequences not related to any scene (always updated)
+static ActionTimeline	globalTimeline;
 
+// ended sequences kept for reuse (linked by next pointer), shared by all timelines
+static AMSequence		*freeSequences = NULL;
 
 AMSequence::AMSequence( unsigned int tag )
+{
+	Init( tag );
+}
+
+void AMSequence::Init( unsigned int tag )
 {
 	prev	= NULL;
 	next	= NULL;
 	this->tag = tag;
 	totalActions	= 0;
 	currentAction	= 0;
-	for( int i = 0; i < ACTIONMANAGER_MAX_SEQUENCE_ACTIONS; i++ ) {
-		actions[ i ] = NULL;
+	sleepList		= NULL;
+	parkTime		= 0;
+	wakeTime		= 0;
+	sleptTime		= -1;
+	source			= NULL;
+	delayedStart	= false;
+	actions			= NULL;
+	singleAction	= NULL;
+	owner			= NULL;
+}
+
+// get a sequence from the free list (or allocate a new one)
+static AMSequence* NewSequence( unsigned int tag )
+{
+	AMSequence *seq = freeSequences;
+	if( seq == NULL ) {
+		return new AMSequence( tag );
 	}
+	freeSequences = seq->next;
+	seq->Init( tag );
+	return seq;
 }
 
-// reset ActionManager data
-void ActionManager::Initialize()
+// release actions of an ended sequence and keep the sequence for reuse
+static void FreeSequence( AMSequence *seq )
 {
-	sequencesList	= NULL;
-	totalSequences	= 0;
+	if( seq->source != NULL ) {
+		// actions taken from a template go back to its pool
+		seq->source->Release( seq->actions );
+	} else {
+		// delete all action objects of this sequece
+		for( unsigned int i = 0; i < seq->totalActions; i++ ) {
+			delete seq->actions[ i ];
+		}
+		// and the sequence object that contains the list of actions
+		delete seq->owner;
+	}
+	seq->prev		= NULL;
+	seq->next		= freeSequences;
+	freeSequences	= seq;
 }
 
-static AMSequence* DeleteSequence( AMSequence *seq )
+ActionTimeline::ActionTimeline()
 {
-#ifdef ACTIONMANAGER_DEBUG
-	printf( "DeleteSequence %p\n", seq );
-#endif
-	// delete all action objects of this sequece
-	for( unsigned int i = 0; i < seq->totalActions; i++ ) {
-		delete seq->actions[ i ];
+	Reset();
+	// register the timeline, the ActionManager needs all of them to search sequences by tag
+	timelines.push_back( this );
+}
+
+// release all sequences of a list of the timeline
+static void FreeSequenceList( AMSequence *list )
+{
+	while( list != NULL ) {
+		AMSequence *p_Next = list->next;
+		FreeSequence( list );
+		list = p_Next;
+	}
+}
+
+ActionTimeline::~ActionTimeline()
+{
+	Clear();
+	// unregister the timeline
+	std::vector<ActionTimeline*>::iterator it = std::find( timelines.begin(), timelines.end(), this );
+	if( it != timelines.end() ) {
+		timelines.erase( it );
 	}
+}
+
+void ActionTimeline::Clear()
+{
+	// release all sequences still running or sleeping
+	FreeSequenceList( sequencesList );
+	FreeSequenceList( dueList );
+	for( int level = 0; level < ACTIONMANAGER_WHEEL_LEVELS; level++ ) {
+		for( int slot = 0; slot < ACTIONMANAGER_WHEEL_SLOTS; slot++ ) {
+			FreeSequenceList( wheel[ level ][ slot ] );
+		}
+	}
+	Reset();
+}
+
+void ActionTimeline::Reset()
+{
+	sequencesList			= NULL;
+	sequencesTail			= NULL;
+	totalSequences			= 0;
+	paused					= false;
+	// reset the timing wheel
+	for( int level = 0; level < ACTIONMANAGER_WHEEL_LEVELS; level++ ) {
+		for( int slot = 0; slot < ACTIONMANAGER_WHEEL_SLOTS; slot++ ) {
+			wheel[ level ][ slot ] = NULL;
+		}
+	}
+	dueList					= NULL;
+	wheelTick				= 0;
+	totalSleepingSequences	= 0;
+	time					= 0;
+}
+
+void ActionTimeline::SetPaused( bool state )
+{
+	paused = state;
+}
+
+bool ActionTimeline::IsPaused()
+{
+	return paused;
+}
+
+double ActionTimeline::GetTime()
+{
+	return time;
+}
+
+long ActionTimeline::GetTotalSequences()
+{
+	return totalSequences + totalSleepingSequences;
+}
+
+// remove a sequence from the active list, returns a pointer to the next sequence (or NULL)
+AMSequence* ActionTimeline::UnlinkSequence( AMSequence *seq )
+{
 	// we must store previous and next item of current (pointed by *seq)
 	AMSequence *p_Prev = seq->prev;
 	AMSequence *p_Next = seq->next;
-	// delete current Sequence
-	delete seq;
 	// and reset previous and next pointers of neighbors:
 	// if we have a previous item...
 	if( p_Prev != NULL ) {
@@ -97,6 +229,12 @@ static AMSequence* DeleteSequence( AMSequence *seq )
 			sequencesList = NULL;
 		}
 	}
+	// if we removed the last item the tail is now the previous one
+	if( sequencesTail == seq ) {
+		sequencesTail = p_Prev;
+	}
+	seq->prev = NULL;
+	seq->next = NULL;
 
 	// decrement total number of sequences
 	totalSequences -= 1;
@@ -104,18 +242,174 @@ static AMSequence* DeleteSequence( AMSequence *seq )
 	return p_Next;
 }
 
-void ActionManager::Update()
+AMSequence* ActionTimeline::DeleteSequence( AMSequence *seq )
+{
+#ifdef ACTIONMANAGER_DEBUG
+	printf( "DeleteSequence %p\n", seq );
+#endif
+	// remove sequence from the active list
+	AMSequence *p_Next = UnlinkSequence( seq );
+	// delete actions and current Sequence
+	FreeSequence( seq );
+
+	return p_Next;
+}
+
+void ActionTimeline::AddSequence( AMSequence *seq )
+{
+#ifdef ACTIONMANAGER_DEBUG
+	printf( "AddSequence %p\n", seq );
+#endif
+	if( sequencesTail != NULL ) {
+		// sequencesList is not empty, the last item's next item becomes the new one
+		sequencesTail->next = seq;
+		// and the previous parameter of the new item is the last item, now
+		// the last item is the new one added to the bottom of the list
+		seq->prev = sequencesTail;
+	} else {
+		// this is the first element of the list pointed by sequencesList, it has
+		// no previous and no next item to set
+		sequencesList = seq;
+	}
+	sequencesTail = seq;
+
+	// increment total number of sequences
+	totalSequences += 1;
+}
+
+// insert a sleeping sequence into a list of the timing wheel
+void ActionTimeline::PushSleepingSequence( AMSequence **list, AMSequence *seq )
+{
+	seq->prev		= NULL;
+	seq->next		= *list;
+	seq->sleepList	= list;
+	if( *list != NULL ) {
+		(*list)->prev = seq;
+	}
+	*list = seq;
+}
+
+// remove a sleeping sequence from its list of the timing wheel
+void ActionTimeline::PopSleepingSequence( AMSequence *seq )
+{
+	if( seq->prev != NULL ) {
+		seq->prev->next = seq->next;
+	} else {
+		*seq->sleepList = seq->next;
+	}
+	if( seq->next != NULL ) {
+		seq->next->prev = seq->prev;
+	}
+	seq->prev		= NULL;
+	seq->next		= NULL;
+	seq->sleepList	= NULL;
+}
+
+// find the slot of the timing wheel for a sleeping sequence according to its wake up time
+void ActionTimeline::InsertIntoWheel( AMSequence *seq )
+{
+	Uint64 wakeTick = (Uint64)seq->wakeTime;
+	// if the slot has already been reached the sequence is due
+	if( wakeTick <= wheelTick ) {
+		PushSleepingSequence( &dueList, seq );
+		return;
+	}
+	Uint64 delta = wakeTick - wheelTick;
+	// waits longer than the wheel are parked in the farthest slot, they will be re-inserted once reached
+	if( delta >= ACTIONMANAGER_WHEEL_SPAN ) {
+		delta		= ACTIONMANAGER_WHEEL_SPAN - 1;
+		wakeTick	= wheelTick + delta;
+	}
+	// search the level: level n holds waits shorter than 64^(n+1) ticks
+	int level = 0;
+	while( delta >= ( (Uint64)1 << ( ACTIONMANAGER_WHEEL_SLOT_BITS * ( level + 1 ) ) ) ) {
+		level += 1;
+	}
+	int slot = (int)( ( wakeTick >> ( ACTIONMANAGER_WHEEL_SLOT_BITS * level ) ) & ACTIONMANAGER_WHEEL_SLOT_MASK );
+	PushSleepingSequence( &wheel[ level ][ slot ], seq );
+}
+
+// move a sequence from the active list to the timing wheel, returns a pointer to the next active sequence (or NULL)
+AMSequence* ActionTimeline::ParkSequence( AMSequence *seq, float sleepTime )
+{
+	AMSequence *p_Next = UnlinkSequence( seq );
+	seq->parkTime	= time;
+	seq->wakeTime	= time + sleepTime;
+	InsertIntoWheel( seq );
+	totalSleepingSequences += 1;
+	return p_Next;
+}
+
+// advance the timing wheel up to current timeline time and wake up all expired sequences
+void ActionTimeline::UpdateTimingWheel()
+{
+	Uint64 nowTick = (Uint64)time;
+	// if nobody is sleeping we can simply move the wheel forward
+	if( totalSleepingSequences == 0 ) {
+		wheelTick = nowTick;
+		return;
+	}
+	while( wheelTick < nowTick ) {
+		wheelTick += 1;
+		// each time a level completes a turn, spread the current slot of the upper level into lower levels
+		for( int level = 1; level < ACTIONMANAGER_WHEEL_LEVELS; level++ ) {
+			if( ( wheelTick & ( ( (Uint64)1 << ( ACTIONMANAGER_WHEEL_SLOT_BITS * level ) ) - 1 ) ) != 0 ) {
+				break;
+			}
+			int slot = (int)( ( wheelTick >> ( ACTIONMANAGER_WHEEL_SLOT_BITS * level ) ) & ACTIONMANAGER_WHEEL_SLOT_MASK );
+			AMSequence *p_Sequence = wheel[ level ][ slot ];
+			wheel[ level ][ slot ] = NULL;
+			while( p_Sequence != NULL ) {
+				AMSequence *p_Next = p_Sequence->next;
+				InsertIntoWheel( p_Sequence );
+				p_Sequence = p_Next;
+			}
+		}
+		// sequences of the reached slot of level 0 are due
+		int slot = (int)( wheelTick & ACTIONMANAGER_WHEEL_SLOT_MASK );
+		AMSequence *p_Sequence = wheel[ 0 ][ slot ];
+		wheel[ 0 ][ slot ] = NULL;
+		while( p_Sequence != NULL ) {
+			AMSequence *p_Next = p_Sequence->next;
+			PushSleepingSequence( &dueList, p_Sequence );
+			p_Sequence = p_Next;
+		}
+	}
+	// wake up due sequences whose wake up time is reached: they go back to the active list and their 
+	// delay action will receive the whole time slept
+	AMSequence *p_Sequence = dueList;
+	while( p_Sequence != NULL ) {
+		AMSequence *p_Next = p_Sequence->next;
+		if( p_Sequence->wakeTime <= time ) {
+			PopSleepingSequence( p_Sequence );
+			totalSleepingSequences -= 1;
+			if( p_Sequence->delayedStart ) {
+				// a delayed sequence starts now and its first action receives only the time elapsed after its start time
+				p_Sequence->delayedStart	= false;
+				p_Sequence->sleptTime		= time - p_Sequence->wakeTime;
+				p_Sequence->actions[ 0 ]->Start();
+			} else {
+				p_Sequence->sleptTime		= time - p_Sequence->parkTime;
+			}
+			AddSequence( p_Sequence );
+		}
+		p_Sequence = p_Next;
+	}
+}
+
+void ActionTimeline::Update( double deltaTime )
 {
-	static Uint64	lastTime = 0;
-	Uint64			now; 
-	double			deltaTime;
 	AMSequence		*p_Sequence;
 	ExecuteResult_t	result;
 
-	now = SDL_GetPerformanceCounter();
-	deltaTime = (double)((now - lastTime)*1000 / (double)SDL_GetPerformanceFrequency() );
-	lastTime = now;
-	//printf("deltaTime %f\n", deltaTime ); 
+	// a paused timeline is frozen: its time doesn't advance
+	if( paused ) {
+		return;
+	}
+
+	// update timeline time and wake up sleeping sequences (if any)
+	time += deltaTime;
+	UpdateTimingWheel();
 
 	// initizialize pointer to scan all active sequences
 	p_Sequence = sequencesList;
@@ -125,6 +419,13 @@ void ActionManager::Update()
 #ifdef ACTIONMANAGER_DEBUG
 		printf( "Check sequence %p Tag %d Total actions %d\n", p_Sequence, p_Sequence->tag, p_Sequence->totalActions );
 #endif
+		// a sequence just woken up executes its delay action with the whole time slept
+		double sequenceDeltaTime = deltaTime;
+		if( p_Sequence->sleptTime >= 0 ) {
+			sequenceDeltaTime		= p_Sequence->sleptTime;
+			p_Sequence->sleptTime	= -1;
+		}
+
 		// the control flow below is a little messy but it's necessary to have correct actions timings:
 		// if in the sequence there are consecutive instant actions they must be executed all immediately until the
 		// end of the sequence or the next interval action
@@ -139,7 +440,7 @@ void ActionManager::Update()
 				actionIntervalDone = true;
 			}
 			// execute action and get result 
-			result = p_Sequence->actions[ p_Sequence->currentAction ]->Execute( deltaTime );
+			result = p_Sequence->actions[ p_Sequence->currentAction ]->Execute( sequenceDeltaTime );
 
 #ifdef ACTIONMANAGER_DEBUG
 			printf( "Current Action Type %d Result %d actionIntervalDone %d\n", p_Sequence->actions[ p_Sequence->currentAction ]->GetType(), result, actionIntervalDone );
@@ -217,12 +518,39 @@ void ActionManager::Update()
 			// continue to the top (if p_Sequence points to NULL exit, if points to a valid sequence proceed normally) 
 			continue;
 		}
+		// if the sequence is now waiting on a delay we park it into the timing wheel until the delay expires
+		float sleepTime = p_Sequence->actions[ p_Sequence->currentAction ]->GetSleepTime();
+		if( sleepTime > 0 ) {
+			p_Sequence = ParkSequence( p_Sequence, sleepTime );
+			continue;
+		}
 		// go ahead and check current sequence (if any) of actions
 		p_Sequence = p_Sequence->next;
 	}
 }
 
-void ActionManager::DeleteSequenceByTag( int tag )
+// delete a sleeping sequence
+void ActionTimeline::DeleteSleepingSequence( AMSequence *seq )
+{
+	PopSleepingSequence( seq );
+	totalSleepingSequences -= 1;
+	// delete actions and current Sequence
+	FreeSequence( seq );
+}
+
+// search a sequence by tag in a list of sleeping sequences
+static AMSequence* FindSleepingSequence( AMSequence *list, int tag )
+{
+	while( list != NULL ) {
+		if( list->tag == tag ) {
+			break;
+		}
+		list = list->next;
+	}
+	return list;
+}
+
+bool ActionTimeline::DeleteSequenceByTag( int tag )
 {
 	AMSequence		*p_Sequence;
 	// initizialize pointer to scan all active sequences
@@ -230,59 +558,154 @@ void ActionManager::DeleteSequenceByTag( int tag )
 	while( p_Sequence != NULL ) {
 		if( p_Sequence->tag == tag ) {
 			DeleteSequence( p_Sequence );
-			break;
+			return true;
 		}
 		// go ahead and check current sequence (if any) of actions
 		p_Sequence = p_Sequence->next;
 	}
+	// the sequence may be sleeping: check the due list and all the slots of the timing wheel
+	p_Sequence = FindSleepingSequence( dueList, tag );
+	for( int level = 0; ( p_Sequence == NULL ) && ( level < ACTIONMANAGER_WHEEL_LEVELS ); level++ ) {
+		for( int slot = 0; ( p_Sequence == NULL ) && ( slot < ACTIONMANAGER_WHEEL_SLOTS ); slot++ ) {
+			p_Sequence = FindSleepingSequence( wheel[ level ][ slot ], tag );
+		}
+	}
+	if( p_Sequence != NULL ) {
+		DeleteSleepingSequence( p_Sequence );
+		return true;
+	}
+	return false;
 }
 
-static void AddSequence( AMSequence *seq )
+// returns the timeline that must own sequences of the target: the one of the scene containing the target
+// or the global one if the target doesn't belong to any scene
+static ActionTimeline* GetTargetTimeline( Node *target )
 {
-#ifdef ACTIONMANAGER_DEBUG
-	printf( "AddSequence %p\n", seq );
-#endif
-	if( sequencesList != NULL ) {
-		// sequencesList is not empty, we must find the last element
-		AMSequence *p_Sequence = sequencesList;
-		// we detect the last item by next parameter that must be NULL
-		while( p_Sequence->next != NULL ) {
-			p_Sequence = p_Sequence->next;
+	Scene *scene = Engine::GetNodeScene( target );
+	if( scene != NULL ) {
+		return scene->GetActionTimeline();
+	}
+	return &globalTimeline;
+}
+
+// reset action manager data
+void ActionManager::Initialize()
+{
+	globalTimeline.Reset();
+}
+
+void ActionManager::Terminate()
+{
+	// sequences still running go back to the free list...
+	globalTimeline.Clear();
+	// ...that is deleted
+	while( freeSequences != NULL ) {
+		AMSequence *seq = freeSequences;
+		freeSequences = seq->next;
+		delete seq;
+	}
+}
+
+void ActionManager::Update( Scene *scene )
+{
+	// sequences not related to any scene are always updated
+	globalTimeline.Update( Clock::GetDeltaTime() );
+	// only the timeline of the current scene is updated, timelines of other scenes are frozen
+	if( scene != NULL ) {
+		scene->GetActionTimeline()->Update( Clock::GetSceneDeltaTime() );
+	}
+}
+
+void ActionManager::DeleteSequenceByTag( int tag )
+{
+	// search the sequence in all timelines
+	for( size_t i = 0; i < timelines.size(); i++ ) {
+		if( timelines[ i ]->DeleteSequenceByTag( tag ) ) {
+			break;
 		}
-		// now p_Sequence points to the last item, his next item becomes the new one
-		p_Sequence->next = seq;
-		// and the previous parameter of the new item is the last item we found, now
-		// the last item is the new one added to the bottom of the list
-		seq->prev = p_Sequence;
-	} else {
-		// this is the first element of the list pointed by sequencesList, it has
-		// no previous and no next item to set
-		sequencesList = seq;
 	}
+}
 
-	// increment total number of sequences
-	totalSequences += 1;
+void ActionTimeline::RunAction( Action *action )
+{
+	AMSequence *seq = NewSequence( action->GetTag() );
+	seq->singleAction	= action;
+	seq->actions		= &seq->singleAction;
+	seq->totalActions	= 1;
+	AddSequence( seq );
 }
 
+void ActionTimeline::RunSequence( ActionsSequence *sequence )
+{
+	// an empty sequence has nothing to do
+	if( sequence->totalActions == 0 ) {
+		delete sequence;
+		return;
+	}
+	AMSequence *seq = NewSequence( sequence->GetTag() );
+	// the list of actions of the sequence object is used directly, the object will be deleted 
+	// together with its actions when the sequence ends
+	seq->actions		= sequence->actions;
+	seq->totalActions	= sequence->totalActions;
+	seq->owner			= sequence;
+	AddSequence( seq );
+}
+
+void ActionTimeline::RunTemplate( SequenceTemplate *sequenceTemplate, Node *target, float timeOffset )
+{
+	if( sequenceTemplate->GetTotalActions() == 0 ) {
+		printf( "RunTemplate: no actions in template %d\n", sequenceTemplate->GetTag() );
+		return;
+	}
+	AMSequence *seq = NewSequence( sequenceTemplate->GetTag() );
+	seq->actions		= sequenceTemplate->Acquire( target );
+	seq->totalActions	= sequenceTemplate->GetTotalActions();
+	seq->source			= sequenceTemplate;
+	if( timeOffset <= 0 ) {
+		// start immediately: the first action reads the current state of the target
+		seq->actions[ 0 ]->Start();
+		AddSequence( seq );
+	} else {
+		// the sequence waits for its start time into the timing wheel
+		seq->delayedStart	= true;
+		seq->parkTime		= time;
+		seq->wakeTime		= time + timeOffset;
+		InsertIntoWheel( seq );
+		totalSleepingSequences += 1;
+	}
+}
 
 void ActionManager::RunAction( Action *action )
 {
-	AMSequence *seq = new AMSequence( action->GetTag() );
-	seq->actions[ 0 ] = action;
-	seq->totalActions = 1;
-	AddSequence( seq );
+	GetTargetTimeline( action->GetTarget() )->RunAction( action );
 }
 
 void ActionManager::RunSequence( ActionsSequence *sequence )
 {
-	AMSequence *seq = new AMSequence( sequence->GetTag() );
-	for( unsigned int i = 0; i < sequence->totalActions; i++ ) {
-		seq->actions[ i ] = sequence->actions[ i ];	
+	GetTargetTimeline( sequence->GetTarget() )->RunSequence( sequence );
+}
+
+void ActionManager::RunGlobalAction( Action *action )
+{
+	globalTimeline.RunAction( action );
+}
+
+void ActionManager::RunGlobalSequence( ActionsSequence *sequence )
+{
+	globalTimeline.RunSequence( sequence );
+}
+
+void ActionManager::RunTemplate( SequenceTemplate *sequenceTemplate, Node *target, float timeOffset )
+{
+	GetTargetTimeline( target )->RunTemplate( sequenceTemplate, target, timeOffset );
+}
+
+void ActionManager::RunTemplateBatch( SequenceTemplate *sequenceTemplate, Node **targets, unsigned int totalTargets, float *timeOffsets )
+{
+	// make room in the pool for all sequences at once
+	sequenceTemplate->Reserve( totalTargets );
+	for( unsigned int i = 0; i < totalTargets; i++ ) {
+		RunTemplate( sequenceTemplate, targets[ i ], ( timeOffsets != NULL ? timeOffsets[ i ] : 0 ) );
 	}
-	seq->totalActions = sequence->totalActions;
-	AddSequence( seq );
-	// delete sequence object, no longer needed: all data has been tranferred
-	// into the ActionManager sequences list
-	delete sequence;
 }
 
@@ -10,6 +10,108 @@
 #include "Actions.h"
 #include "Engine.h"
 
+/*
+	Sequences whose current action is a pure delay (DelayTime) are removed from the active list and parked
+	into a hierarchical timing wheel keyed on their wake up time (one tick = 1 millisecond):
+	- level 0 has a slot for each of the next 64 ms
+	- level 1 has a slot for each of the next 64 groups of 64 ms (about 4 seconds)
+	- level 2 and 3 go on the same way (about 4.5 minutes and 4.6 hours); longer waits are parked in
+	  the last level and re-inserted when their slot is reached
+	each time a lower level completes a turn the following slot of the upper level is spread (cascade) into 
+	the lower levels; when a slot of level 0 is reached its sequences are moved to the due list and woken up 
+	(appended again to the active list) as soon as the timeline time reaches their wake up time.
+	Per frame cost then depends on active sequences only, not on the total number of scheduled ones.
+*/
+#define ACTIONMANAGER_WHEEL_LEVELS			4
+#define ACTIONMANAGER_WHEEL_SLOT_BITS		6
+#define ACTIONMANAGER_WHEEL_SLOTS			( 1 << ACTIONMANAGER_WHEEL_SLOT_BITS )
+
+// used internally by the ActionManager
+class AMSequence;
+
+/*
+	ActionTimeline is a list of sequences updated together with their own time. 
+	Each Scene owns a timeline for the sequences of its objects, the ActionManager owns a global one for 
+	the sequences not related to any scene. Only the timeline of the current scene (and the global one) is 
+	updated each frame, timelines of the other scenes are frozen and resume from the same point when their
+	scene is displayed again.
+*/
+class ActionTimeline {
+
+public:
+
+	// constructor
+	ActionTimeline();
+	// destructor, all sequences of the timeline are deleted
+	~ActionTimeline();
+
+	// reset timeline data
+	void			Reset();
+
+	// delete all sequences of the timeline and reset it
+	void			Clear();
+
+	// add a single action to the timeline
+	void			RunAction( Action *action );
+
+	// add a sequence of actions to the timeline
+	void			RunSequence( ActionsSequence *sequence );
+
+	// add a sequence made from a template bound to target, started after timeOffset milliseconds
+	void			RunTemplate( SequenceTemplate *sequenceTemplate, Node *target, float timeOffset );
+
+	// delete a sequence identified by tag, returns true if the sequence has been found
+	bool			DeleteSequenceByTag( int tag );
+
+	// pause or resume the timeline (a paused timeline is frozen even if updated)
+	void			SetPaused( bool state );
+	bool			IsPaused();
+
+	// returns current time of the timeline (milliseconds)
+	double			GetTime();
+
+	// returns total number of sequences (active and sleeping)
+	long			GetTotalSequences();
+
+	// update all active sequences, called each frame by the ActionManager
+	void			Update( double deltaTime );
+
+private:
+
+	// this is the head of the list of current active sequences
+	AMSequence		*sequencesList;
+	// this is the tail of the list of current active sequences (new sequences are appended here)
+	AMSequence		*sequencesTail;
+	// current total number of active sequences
+	long			totalSequences;
+	// if true the timeline is frozen
+	bool			paused;
+	// time of the timeline (milliseconds), sum of all delta times of its updates
+	double			time;
+
+	// slots of the timing wheel, each one is the head of a list of sleeping sequences
+	AMSequence		*wheel[ ACTIONMANAGER_WHEEL_LEVELS ][ ACTIONMANAGER_WHEEL_SLOTS ];
+	// sequences whose slot has been reached, they will wake up as soon as the timeline time reaches their wake up time
+	AMSequence		*dueList;
+	// current tick of the timing wheel
+	Uint64			wheelTick;
+	// current total number of sleeping sequences
+	long			totalSleepingSequences;
+
+	// active list management
+	void			AddSequence( AMSequence *seq );
+	AMSequence*		UnlinkSequence( AMSequence *seq );
+	AMSequence*		DeleteSequence( AMSequence *seq );
+
+	// timing wheel management
+	void			PushSleepingSequence( AMSequence **list, AMSequence *seq );
+	void			PopSleepingSequence( AMSequence *seq );
+	void			InsertIntoWheel( AMSequence *seq );
+	AMSequence*		ParkSequence( AMSequence *seq, float sleepTime );
+	void			DeleteSleepingSequence( AMSequence *seq );
+	void			UpdateTimingWheel();
+};
+
 /*
 	This is the ActionManager, it take cares of animation made by sequences of action
 */
@@ -18,17 +120,33 @@ namespace ActionManager {
 	// reset action manager data
 	void Initialize();
 
-	// add a single action to the sequences list
+	// delete the sequences of the global timeline and the sequences kept for reuse
+	void Terminate();
+
+	// add a single action to the timeline of the scene containing its target (or to the global one)
 	void RunAction( Action *action );
 
-	// add a sequence of actions to the sequences list
+	// add a sequence of actions to the timeline of the scene containing its target (or to the global one)
 	void RunSequence( ActionsSequence *sequence );
 
+	// add a single action to the global timeline (always updated, whatever scene is displayed)
+	void RunGlobalAction( Action *action );
+
+	// add a sequence of actions to the global timeline (always updated, whatever scene is displayed)
+	void RunGlobalSequence( ActionsSequence *sequence );
+
+	// run a sequence made from a template on target (in the timeline of the scene containing the target),
+	// the sequence starts after timeOffset milliseconds
+	void RunTemplate( SequenceTemplate *sequenceTemplate, Node *target, float timeOffset = 0 );
+
+	// run a template on many targets, each one starting after its own time offset (timeOffsets may be NULL)
+	void RunTemplateBatch( SequenceTemplate *sequenceTemplate, Node **targets, unsigned int totalTargets, float *timeOffsets );
+
 	// delete a sequence identified by tag
 	void DeleteSequenceByTag( int tag );
 
-	// This function is called each frame by the engine and update textures of all active streamings
-	void Update();
+	// This function is called each frame by the engine and update the global timeline and the one of the current scene
+	void Update( Scene *scene );
 };
 
 #endif
\ No newline at end of file
@@ -7,6 +7,7 @@
 #include <stdio.h>
 #include <time.h>
 #include <stdlib.h>
+#include <algorithm>
 
 
 #define _USE_MATH_DEFINES
@@ -17,10 +18,6 @@
 #include "Misc.h"
 #include "Sprite.h"
 
-#ifndef M_PI_X_2
-#define M_PI_X_2 (float)M_PI * 2.0f
-#endif
-
 
 Action::Action()
 {
@@ -29,11 +26,25 @@ Action::Action()
 	this->type		= ACTIONTYPE_UNKNOWN;
 }
 
+Action::~Action()
+{
+}
+
 unsigned int Action::GetTag()
 {
 	return tag;
 }
 
+Node* Action::GetTarget()
+{
+	return target;
+}
+
+void Action::SetTarget( Node *target )
+{
+	this->target = target;
+}
+
 ActionType_t Action::GetType()
 {
 	return type;
@@ -50,42 +61,77 @@ void Action::Start()
 	// overridden by action
 }
 
+float Action::GetSleepTime()
+{
+	// overridden by actions that only wait (DelayTime)
+	return 0;
+}
+
+Action* Action::Clone() const
+{
+	// overridden by ACTION_CLONEABLE
+	return NULL;
+}
+
+void Action::CopyFrom( const Action * )
+{
+	// overridden by ACTION_CLONEABLE
+}
+
 
 
 ActionsSequence::ActionsSequence( unsigned int tag, Node* target, ... )
 {
-	int	actionsCount = 0;
+	unsigned int	actionsCount = 0;
+	va_list			ap;
 	// set tag and target object
 	this->tag		= tag;
 	this->target	= target;
-	// reset all action buffer to NULL
-    for( int i = 0; i <= ACTIONSSEQUENCE_MAX_SEQUENCE_ACTIONS; i++ ) {
-		this->actions[ i ] = NULL;
-    }
-	// insert actions into ActionsSequence'list
-    va_list ap;
+	// count actions until a NULL is found
     va_start( ap, target );
-	do {
-		// extract until a NULL is found
-		Action *pAction = va_arg( ap, Action* );
-		if( !pAction ) {
-			break;
-		}
-		// insert action into ActionsSequence'list
-		this->actions[ actionsCount ] = pAction;
-		// increment actions counter
+	while( va_arg( ap, Action* ) != NULL ) {
 		actionsCount += 1;
-	} while( true );
+	}
+    va_end( ap );
+	// allocate the array of actions
+	this->actions		= new Action*[ actionsCount > 0 ? actionsCount : 1 ];
+	this->ownsStorage	= true;
+	// insert actions into ActionsSequence'list
+    va_start( ap, target );
+	for( unsigned int i = 0; i < actionsCount; i++ ) {
+		this->actions[ i ] = va_arg( ap, Action* );
+	}
     va_end( ap );
 	// set total number of action
 	this->totalActions = actionsCount;
 }
 
+ActionsSequence::ActionsSequence( unsigned int tag, Node* target, Action **storage, unsigned int totalActions )
+{
+	this->tag			= tag;
+	this->target		= target;
+	this->actions		= storage;
+	this->totalActions	= totalActions;
+	this->ownsStorage	= false;
+}
+
+ActionsSequence::~ActionsSequence()
+{
+	if( ownsStorage ) {
+		delete [] actions;
+	}
+}
+
 unsigned int ActionsSequence::GetTag()
 {
 	return tag;
 }
 
+Node* ActionsSequence::GetTarget()
+{
+	return target;
+}
+
 // return total number of action in the sequence
 unsigned int ActionsSequence::GetTotalActions()
 {
@@ -94,6 +140,144 @@ unsigned int ActionsSequence::GetTotalActions()
 
 
 
+SequenceTemplate::SequenceTemplate( unsigned int tag )
+{
+	this->tag			= tag;
+	this->totalActions	= 0;
+	for( int i = 0; i < ACTIONSSEQUENCE_MAX_SEQUENCE_ACTIONS; i++ ) {
+		this->actions[ i ] = NULL;
+	}
+	this->pool			= NULL;
+	this->poolSize		= 0;
+	this->poolCapacity	= 0;
+}
+
+SequenceTemplate::~SequenceTemplate()
+{
+	// delete the copies in the pool
+	ClearPool();
+	delete [] pool;
+	// delete the actions of the template
+	for( unsigned int i = 0; i < totalActions; i++ ) {
+		delete actions[ i ];
+	}
+}
+
+unsigned int SequenceTemplate::GetTag()
+{
+	return tag;
+}
+
+Node* SequenceTemplate::GetTarget()
+{
+	return &placeholder;
+}
+
+unsigned int SequenceTemplate::GetTotalActions()
+{
+	return totalActions;
+}
+
+bool SequenceTemplate::AddAction( Action *action )
+{
+	if( totalActions >= ACTIONSSEQUENCE_MAX_SEQUENCE_ACTIONS ) {
+		printf( "SequenceTemplate::AddAction: too many actions in template %d\n", tag );
+		return false;
+	}
+	// the action must be copied each time the template is run
+	Action *test = action->Clone();
+	if( test == NULL ) {
+		printf( "SequenceTemplate::AddAction: action can't be copied (ACTION_CLONEABLE missing) in template %d\n", tag );
+		return false;
+	}
+	delete test;
+	// the pool contains copies of the previous actions only, so it must be emptied
+	ClearPool();
+	actions[ totalActions ] = action;
+	totalActions += 1;
+	return true;
+}
+
+void SequenceTemplate::ClearPool()
+{
+	for( unsigned int i = 0; i < poolSize; i++ ) {
+		for( unsigned int j = 0; j < totalActions; j++ ) {
+			delete pool[ i ][ j ];
+		}
+		delete [] pool[ i ];
+	}
+	poolSize = 0;
+}
+
+void SequenceTemplate::GrowPool( unsigned int capacity )
+{
+	if( capacity <= poolCapacity ) {
+		return;
+	}
+	Action ***newPool = new Action**[ capacity ];
+	for( unsigned int i = 0; i < poolSize; i++ ) {
+		newPool[ i ] = pool[ i ];
+	}
+	delete [] pool;
+	pool			= newPool;
+	poolCapacity	= capacity;
+}
+
+Action** SequenceTemplate::NewInstance()
+{
+	Action **instance = new Action*[ totalActions ];
+	for( unsigned int i = 0; i < totalActions; i++ ) {
+		instance[ i ] = actions[ i ]->Clone();
+	}
+	return instance;
+}
+
+void SequenceTemplate::Reserve( unsigned int instances )
+{
+	GrowPool( instances );
+	// create the missing copies
+	while( poolSize < instances ) {
+		pool[ poolSize ] = NewInstance();
+		poolSize += 1;
+	}
+}
+
+Action** SequenceTemplate::Acquire( Node *target )
+{
+	Action **instance;
+	// if the pool is empty a new array of copies is created (the pool will keep it once released)
+	if( poolSize == 0 ) {
+		instance = NewInstance();
+	} else {
+		// take the last array of copies of the pool
+		poolSize -= 1;
+		instance = pool[ poolSize ];
+		// reset parameters and state of the copies
+		for( unsigned int i = 0; i < totalActions; i++ ) {
+			instance[ i ]->CopyFrom( actions[ i ] );
+		}
+	}
+	// bind the actions to the real target
+	for( unsigned int i = 0; i < totalActions; i++ ) {
+		if( actions[ i ]->GetTarget() == &placeholder ) {
+			instance[ i ]->SetTarget( target );
+		}
+	}
+	return instance;
+}
+
+void SequenceTemplate::Release( Action **instance )
+{
+	// the pool grows by doubling so releasing is almost always a plain store
+	if( poolSize >= poolCapacity ) {
+		GrowPool( ( std::max )( poolCapacity * 2, (unsigned int)8 ) );
+	}
+	pool[ poolSize ] = instance;
+	poolSize += 1;
+}
+
+
+
 
 // ================================== Action Instant =============================================
 ActionInstant::ActionInstant()
@@ -408,168 +592,6 @@ ExecuteResult_t ReleaseButton::Execute( float deltaTime )
 
 // ================================== Action Interval =============================================
 
-// Linear
-static float InterpolatorLinear( float percentage )
-{
-	return percentage;
-}
-
-// Sine Ease
-static float InterpolatorSineEaseIn(float time)
-{
-    return -1 * cosf(time * (float)M_PI_2) + 1;
-}
-    
-static float InterpolatorSineEaseOut(float time)
-{
-    return sinf(time * (float)M_PI_2);
-}
-    
-static float InterpolatorSineEaseInOut(float time)
-{
-    return -0.5f * (cosf((float)M_PI * time) - 1);
-}
-
-// Expo Ease
-static float InterpolatorExpoEaseIn(float time)
-{
-    return time == 0 ? 0 : powf(2, 10 * (time/1 - 1)) - 1 * 0.001f;
-}
-
-static float InterpolatorExpoEaseOut(float time)
-{
-    return time == 1 ? 1 : (-powf(2, -10 * time / 1) + 1);
-}
-
-static float InterpolatorExpoEaseInOut(float time)
-{
-    if(time == 0 || time == 1) 
-        return time;
-    
-    if (time < 0.5f)
-        return 0.5f * powf(2, 10 * (time * 2 - 1));
-
-    return 0.5f * (-powf(2, -10 * (time * 2 - 1)) + 2);
-}
-
-// Bounce Ease
-static float InterpolatorBounceTime(float time)
-{
-    if (time < 1 / 2.75f)
-    {
-        return 7.5625f * time * time;
-    }
-    else if (time < 2 / 2.75f)
-    {
-        time -= 1.5f / 2.75f;
-        return 7.5625f * time * time + 0.75f;
-    }
-    else if(time < 2.5f / 2.75f)
-    {
-        time -= 2.25f / 2.75f;
-        return 7.5625f * time * time + 0.9375f;
-    }
-
-    time -= 2.625f / 2.75f;
-    return 7.5625f * time * time + 0.984375f;
-}
-
-static float InterpolatorBounceEaseIn(float time)
-{
-    return 1 - InterpolatorBounceTime(1 - time);
-}
-
-static float InterpolatorBounceEaseOut(float time)
-{
-    return InterpolatorBounceTime(time);
-}
-
-static float InterpolatorBounceEaseInOut(float time)
-{
-    float newT = 0;
-    if (time < 0.5f)
-    {
-        time = time * 2;
-        newT = (1 - InterpolatorBounceTime(1 - time)) * 0.5f;
-    }
-    else
-    {
-        newT = InterpolatorBounceTime(time * 2 - 1) * 0.5f + 0.5f;
-    }
-
-    return newT;
-}
-
-// Elastic Ease (0.9 ~ 0.1)
-static float period = 0.3f;
-
-static float InterpolatorElasticEaseIn(float time)
-{
-
-    float newT = 0;
-    if (time == 0 || time == 1)
-    {
-        newT = time;
-    }
-    else
-    {
-        float s = period / 4;
-        time = time - 1;
-        newT = -powf(2, 10 * time) * sinf((time - s) * M_PI_X_2 / period);
-    }
-
-    return newT;
-}
-static float InterpolatorElasticEaseOut(float time)
-{
-
-    float newT = 0;
-    if (time == 0 || time == 1)
-    {
-        newT = time;
-    }
-    else
-    {
-        float s = period / 4;
-        newT = powf(2, -10 * time) * sinf((time - s) * M_PI_X_2 / period) + 1;
-    }
-
-    return newT;
-}
-static float InterpolatorElasticEaseInOut(float time)
-{
-
-    float newT = 0;
-    if (time == 0 || time == 1)
-    {
-        newT = time;
-    }
-    else
-    {
-        time = time * 2;
-        if (! period)
-        {
-            period = 0.3f * 1.5f;
-        }
-
-        float s = period / 4;
-
-        time = time - 1;
-        if (time < 0)
-        {
-            newT = -0.5f * powf(2, 10 * time) * sinf((time -s) * M_PI_X_2 / period);
-        }
-        else
-        {
-            newT = powf(2, -10 * time) * sinf((time - s) * M_PI_X_2 / period) * 0.5f + 1;
-        }
-    }
-    return newT;
-}
-
-
-
-
 ActionInterval::ActionInterval()
 {
 	elapsed			= 0;
@@ -597,208 +619,29 @@ void ActionInterval::SetInterpolation( Interpolation_t interpolation )
 	}
 }
 
-float ActionInterval::GetElapsedPercentage()
-{
-	float percentage = 0;
-	if( duration > 0 ) {
-		percentage = elapsed / duration;
-		if( percentage > 1 ) {
-			percentage = 1;
-		}
-	} else {
-		percentage = 1;
-	}
-	return percentage;
-}
-
-
-
-
-
 MoveTo::MoveTo( unsigned int tag, Node* target, float dstX, float dstY, float duration )
+	: TweenTo< PositionProperty >( tag, target, MakeCoord( dstX, dstY ), duration )
 {
-	this->tag		= tag;
-	this->target	= target;
-	this->duration	= duration;
-
-	dst.x = dstX;
-	dst.y = dstY;
-	Start();
-}
-
-void MoveTo::Start()
-{
-	this->elapsed	= 0;
-	Coord_t point	= target->GetPosition();
-	src.x			= point.x;
-	src.y			= point.y;
-	diff.x			= dst.x - src.x;
-	diff.y			= dst.y - src.y;
-}
-
-ExecuteResult_t MoveTo::Execute( float deltaTime )
-{
-	float			percentage;
-	float			interpolated_percentage;
-	float			cur_x, cur_y;
-	// update elapsed time from start of action
-	this->elapsed += deltaTime;
-	// get execution percentage (from 0.0 to 1.0) of action (elapsed/duration)
-	percentage = GetElapsedPercentage();
-	// get percentage modified by interpolation
-	interpolated_percentage = Interpolator( percentage );
-	// calculate current position by time percentage
-	cur_x = src.x + diff.x * interpolated_percentage;
-	cur_y = src.y + diff.y * interpolated_percentage;
-	// set target position 
-	target->SetPosition( cur_x, cur_y );
-	// return proper result
-	return ( percentage >= 1 ? EXECUTERESULT_DONE : EXECUTERESULT_IN_PROGRESS );
 }
 
-
 RotateTo::RotateTo( unsigned int tag, Node* target, float finalAngle, float duration )
+	: TweenTo< AngleProperty >( tag, target, finalAngle, duration )
 {
-	this->tag		= tag;
-	this->target	= target;
-	this->duration	= duration;
-
-	this->finalAngle = finalAngle;
-	Start();
-}
-
-void RotateTo::Start()
-{
-	this->elapsed	= 0;
-	startAngle		= target->GetAngle();
-	diffAngle		= finalAngle - startAngle;
-}
-
-ExecuteResult_t RotateTo::Execute( float deltaTime )
-{
-	float			percentage;
-	float			interpolated_percentage;
-	float			curAngle;
-	// update elapsed time from start of action
-	this->elapsed += deltaTime;
-	// get execution percentage (from 0.0 to 1.0) of action (elapsed/duration)
-	percentage = GetElapsedPercentage();
-	// get percentage modified by interpolation
-	interpolated_percentage = Interpolator( percentage );
-	// calculate current angle by time percentage
-	curAngle = startAngle + diffAngle * interpolated_percentage;
-	// set target position 
-	target->SetAngle( curAngle );
-	// return proper result
-	return ( percentage >= 1 ? EXECUTERESULT_DONE : EXECUTERESULT_IN_PROGRESS );
 }
 
 ScaleTo::ScaleTo( unsigned int tag, Node* target, float finalSize, float duration )
+	: TweenTo< SizeRateProperty >( tag, target, finalSize, duration )
 {
-	this->tag		= tag;
-	this->target	= target;
-	this->duration	= duration;
-
-	this->finalSize = finalSize;
-	Start();
-}
-
-void ScaleTo::Start()
-{
-	this->elapsed	= 0;
-	startSize	= target->GetSizeRate();
-	diffSize	= finalSize - startSize;
-}
-
-ExecuteResult_t ScaleTo::Execute( float deltaTime )
-{
-	float			percentage;
-	float			interpolated_percentage;
-	float			curSize;
-	// update elapsed time from start of action
-	this->elapsed += deltaTime;
-	// get execution percentage (from 0.0 to 1.0) of action (elapsed/duration)
-	percentage = GetElapsedPercentage();
-	// get percentage modified by interpolation
-	interpolated_percentage = Interpolator( percentage );
-	// calculate current size by time percentage
-	curSize = startSize + diffSize * interpolated_percentage;
-	// set target position 
-	target->SetSizeRate( curSize );
-	// return proper result
-	return ( percentage >= 1 ? EXECUTERESULT_DONE : EXECUTERESULT_IN_PROGRESS );
 }
 
 ScaleXTo::ScaleXTo( unsigned int tag, Node* target, float finalSize, float duration )
+	: TweenTo< XSizeRateProperty >( tag, target, finalSize, duration )
 {
-	this->tag		= tag;
-	this->target	= target;
-	this->duration	= duration;
-
-	this->finalSize = finalSize;
-	Start();
-}
-
-void ScaleXTo::Start()
-{
-	this->elapsed	= 0;
-	startSize	= target->GetXSizeRate();
-	diffSize	= finalSize - startSize;
-}
-
-ExecuteResult_t ScaleXTo::Execute( float deltaTime )
-{
-	float			percentage;
-	float			interpolated_percentage;
-	float			curSize;
-	// update elapsed time from start of action
-	this->elapsed += deltaTime;
-	// get execution percentage (from 0.0 to 1.0) of action (elapsed/duration)
-	percentage = GetElapsedPercentage();
-	// get percentage modified by interpolation
-	interpolated_percentage = Interpolator( percentage );
-	// calculate current size by time percentage
-	curSize = startSize + diffSize * interpolated_percentage;
-	// set target position 
-	target->SetXSizeRate( curSize );
-	// return proper result
-	return ( percentage >= 1 ? EXECUTERESULT_DONE : EXECUTERESULT_IN_PROGRESS );
 }
 
 ScaleYTo::ScaleYTo( unsigned int tag, Node* target, float finalSize, float duration )
+	: TweenTo< YSizeRateProperty >( tag, target, finalSize, duration )
 {
-	this->tag		= tag;
-	this->target	= target;
-	this->duration	= duration;
-
-	this->finalSize = finalSize;
-	Start();
-}
-
-void ScaleYTo::Start()
-{
-	this->elapsed	= 0;
-	startSize	= target->GetYSizeRate();
-	diffSize	= finalSize - startSize;
-}
-
-ExecuteResult_t ScaleYTo::Execute( float deltaTime )
-{
-	float			percentage;
-	float			interpolated_percentage;
-	float			curSize;
-	// update elapsed time from start of action
-	this->elapsed += deltaTime;
-	// get execution percentage (from 0.0 to 1.0) of action (elapsed/duration)
-	percentage = GetElapsedPercentage();
-	// get percentage modified by interpolation
-	interpolated_percentage = Interpolator( percentage );
-	// calculate current size by time percentage
-	curSize = startSize + diffSize * interpolated_percentage;
-	// set target position 
-	target->SetYSizeRate( curSize );
-	// return proper result
-	return ( percentage >= 1 ? EXECUTERESULT_DONE : EXECUTERESULT_IN_PROGRESS );
 }
 
 Blink::Blink( unsigned int tag, Node* target, int blinks, float duration )
@@ -834,39 +677,8 @@ ExecuteResult_t Blink::Execute( float deltaTime )
 }
 
 AlphaTo::AlphaTo( unsigned int tag, Node* target, int finalAlpha, float duration )
+	: TweenTo< AlphaProperty >( tag, target, finalAlpha, duration )
 {
-	this->tag		= tag;
-	this->target	= target;
-	this->duration	= duration;
-
-	this->finalAlpha = finalAlpha;
-	Start();
-}
-
-void AlphaTo::Start()
-{
-	this->elapsed	= 0;
-	startAlpha = target->GetAlpha();
-	diffAlpha = finalAlpha - startAlpha;
-}
-
-ExecuteResult_t AlphaTo::Execute( float deltaTime )
-{
-	float			percentage;
-	float			interpolated_percentage;
-	float			curAlpha;
-	// update elapsed time from start of action
-	this->elapsed += deltaTime;
-	// get execution percentage (from 0.0 to 1.0) of action (elapsed/duration)
-	percentage = GetElapsedPercentage();
-	// get percentage modified by interpolation
-	interpolated_percentage = Interpolator( percentage );
-	// calculate current alpha by time percentage
-	curAlpha = startAlpha + diffAlpha * interpolated_percentage;
-	// set target position 
-	target->SetAlpha( curAlpha );
-	// return proper result
-	return ( percentage >= 1 ? EXECUTERESULT_DONE : EXECUTERESULT_IN_PROGRESS );
 }
 
 DelayTime::DelayTime( float duration )
@@ -887,105 +699,128 @@ ExecuteResult_t DelayTime::Execute( float deltaTime )
 	return ( percentage >= 1 ? EXECUTERESULT_DONE : EXECUTERESULT_IN_PROGRESS );
 }
 
+float DelayTime::GetSleepTime()
+{
+	// remaining time of the delay
+	return ( elapsed < duration ? duration - elapsed : 0 );
+}
 
-SplineTo::SplineTo( unsigned int tag, Node* target, unsigned int totalPoints, Coord_t *pointsArray, float tension, float duration )
+
+SplineTo::SplineTo( unsigned int tag, Node* target, SplinePath *path, float duration, bool orientToPath )
 {
 	this->tag			= tag;
 	this->target		= target;
 	this->duration		= duration;
-	this->tension		= tension;
-	this->totalPoints	= totalPoints;
-	this->deltaT		= (float) 1 / totalPoints;
+	this->path			= path;
+	this->orientToPath	= orientToPath;
+	this->path->Retain();
+	if( !IsTemplateTarget( target ) ) {
+		Start();
+	}
+}
 
-	for( unsigned int i = 0; i < totalPoints; i++ ) {
-		this->points[ i ] = pointsArray[ i ];
+SplineTo::SplineTo( unsigned int tag, Node* target, unsigned int totalPoints, Coord_t *pointsArray, float tension, float duration )
+{
+	this->tag			= tag;
+	this->target		= target;
+	this->duration		= duration;
+	this->orientToPath	= false;
+	// the path is owned by this action only (the reference of the creator)
+	this->path			= new SplinePath( totalPoints, pointsArray, tension );
+	if( !IsTemplateTarget( target ) ) {
+		Start();
 	}
-	Start();
 }
 
-void SplineTo::Start()
+SplineTo::SplineTo( const SplineTo &source ) : ActionInterval( source )
 {
-	this->elapsed	= 0;
-	this->target->SetPosition( points[ 0 ].x, points[ 0 ].y );
+	path			= source.path;
+	cursor			= source.cursor;
+	orientToPath	= source.orientToPath;
+	path->Retain();
 }
 
-Coord_t SplineTo::GetPointAt( unsigned int index )
+SplineTo::~SplineTo()
 {
-    index = min( totalPoints - 1, max( index, 0 ) );
-	return points[ index ];	
+	path->Release();
 }
 
-Coord_t	SplineTo::GetSplinePointAt( Coord_t p0, Coord_t p1, Coord_t p2, Coord_t p3, float tension, float t )
+SplineTo& SplineTo::operator=( const SplineTo &source )
 {
-    float	t2 = t * t;
-    float	t3 = t2 * t;
-	Coord_t	result;
+	ActionInterval::operator=( source );
+	source.path->Retain();
+	path->Release();
+	path			= source.path;
+	cursor			= source.cursor;
+	orientToPath	= source.orientToPath;
+	return *this;
+}
 
-    float s = (1 - tension) / 2;
-	
-    float b1 = s * ((-t3 + (2 * t2)) - t);                      // s(-t3 + 2 t2 - t)P1
-    float b2 = s * (-t3 + t2) + (2 * t3 - 3 * t2 + 1);          // s(-t3 + t2)P2 + (2 t3 - 3 t2 + 1)P2
-    float b3 = s * (t3 - 2 * t2 + t) + (-2 * t3 + 3 * t2);      // s(t3 - 2 t2 + t)P3 + (-2 t3 + 3 t2)P3
-    float b4 = s * (t3 - t2);                                   // s(t3 - t2)P4
-    
-    float newX = (p0.x*b1 + p1.x*b2 + p2.x*b3 + p3.x*b4);
-    float newY = (p0.y*b1 + p1.y*b2 + p2.y*b3 + p3.y*b4);
-	
-	result.x = newX;
-	result.y = newY;
+void SplineTo::Start()
+{
+	this->elapsed	= 0;
+	this->cursor	= 0;
+	SetTargetAt( 0 );
+}
 
-	return result;
+void SplineTo::SetTargetAt( float distance )
+{
+	Coord_t tangent;
+	Coord_t position = path->GetPositionAt( distance, &tangent, &cursor );
+	target->SetPosition( position.x, position.y );
+	if( orientToPath ) {
+		target->SetAngle( atan2f( tangent.y, tangent.x ) * 180.0f / (float)M_PI );
+	}
 }
 
 ExecuteResult_t SplineTo::Execute( float deltaTime )
 {
 	float			percentage;
 	float			interpolated_percentage;
-    unsigned int	p;
-    float			lt;
-
 	// update elapsed time from start of action
 	this->elapsed += deltaTime;
 	// get execution percentage (from 0.0 to 1.0) of action (elapsed/duration)
 	percentage = GetElapsedPercentage();
 	// get percentage modified by interpolation
 	interpolated_percentage = Interpolator( percentage );
-	// calculate current point and lt(??)
-	if( percentage == 1 ) {
-        p	= totalPoints - 1;
-        lt	= 1;
-    } else {
-        p	= percentage / deltaT;
-        lt	= ( percentage - deltaT * (float)p) / deltaT;
-    }
-    Coord_t pp0 = GetPointAt( p - 1 );
-    Coord_t pp1 = GetPointAt( p + 0 );
-    Coord_t pp2 = GetPointAt( p + 1 );
-    Coord_t pp3 = GetPointAt( p + 2 );
-	Coord_t newPos = GetSplinePointAt( pp0, pp1, pp2, pp3, tension, lt );
-	// set new position of target
-	target->SetPosition( newPos.x, newPos.y );
+	// the percentage is converted into a distance along the path, so the speed is constant
+	SetTargetAt( interpolated_percentage * path->GetLength() );
 	// return proper result
 	return ( percentage >= 1 ? EXECUTERESULT_DONE : EXECUTERESULT_IN_PROGRESS );
 }
 
 
 
-Shake::Shake( unsigned int tag, Node* target, float radius, float duration )
+// the stream is set at start, a default constructed one would take a stream id (see RandomStream)
+Shake::Shake( unsigned int tag, Node* target, float radius, float duration ) : random( tag, 0 )
 {
 	this->tag		= tag;
 	this->target	= target;
 	this->duration	= duration;
 
 	this->radius			= radius;
-	this->originalPosition	= target->GetPosition();
-	Start();
+	this->randomSeed		= tag;
+	this->totalStarts		= 0;
+	if( !IsTemplateTarget( target ) ) {
+		Start();
+	}
 }
 
 void Shake::Start()
 {
 	this->elapsed	= 0;
-	this->seed		= rand();
+	this->random.SetSeed( randomSeed, totalStarts );
+	this->totalStarts += 1;
+	// the position is taken at start, so the action can also be bound to another target (see SequenceTemplate)
+	this->originalPosition	= target->GetPosition();
+}
+
+void Shake::SetRandomSeed( Uint32 seed )
+{
+	// a started action restarts its current shake from the first stream of the seed
+	this->randomSeed	= seed;
+	this->random.SetSeed( seed, 0 );
+	this->totalStarts	= ( totalStarts > 0 ? 1 : 0 );
 }
 
 ExecuteResult_t Shake::Execute( float deltaTime )
@@ -1006,8 +841,8 @@ ExecuteResult_t Shake::Execute( float deltaTime )
 		curPosition.y = originalPosition.y;
 		result = EXECUTERESULT_DONE;
 	} else {
-		curPosition.x = originalPosition.x + Misc::RANDOM_M11(&seed) * radius;
-		curPosition.y = originalPosition.y + Misc::RANDOM_M11(&seed) * radius;
+		curPosition.x = originalPosition.x + random.NextSigned() * radius;
+		curPosition.y = originalPosition.y + random.NextSigned() * radius;
 		result = EXECUTERESULT_IN_PROGRESS;
 	}
 	// set target position 
@@ -1032,9 +867,33 @@ TintTo::TintTo( unsigned int tag, SDL_Texture* texture, unsigned char r, unsigne
 	Start();
 }
 
+SpriteTintTo::SpriteTintTo( unsigned int tag, Node* target, unsigned char r, unsigned char g, unsigned char b, float duration )
+{	
+	this->tag		= tag;
+	this->target	= target;
+	this->duration	= duration;
+
+	this->targetTexture	= NULL;
+	finalColor.r = r;
+	finalColor.g = g;
+	finalColor.b = b;
+
+	if( !IsTemplateTarget( target ) ) {
+		Start();
+	}
+}
+
 void TintTo::Start()
 {
 	this->elapsed	= 0;
+	// if the target is a sprite we tint its current texture
+	if( target != NULL ) {
+		Sprite *sprite = dynamic_cast< Sprite* >( target );
+		targetTexture = ( sprite != NULL ? sprite->GetTexture() : NULL );
+	}
+	if( targetTexture == NULL ) {
+		return;
+	}
 
 	SDL_GetTextureColorMod( targetTexture, &startColor.r, &startColor.g, &startColor.b );
 	diffR = (int)finalColor.r - startColor.r;
@@ -1053,6 +912,10 @@ ExecuteResult_t TintTo::Execute( float deltaTime )
 	percentage = GetElapsedPercentage();
 	// get percentage modified by interpolation
 	interpolated_percentage = Interpolator( percentage );
+	// nothing to tint
+	if( targetTexture == NULL ) {
+		return ( percentage >= 1 ? EXECUTERESULT_DONE : EXECUTERESULT_IN_PROGRESS );
+	}
 	// calculate current color by time percentage
 	curColor.r = startColor.r + diffR * interpolated_percentage;
 	curColor.g = startColor.g + diffG * interpolated_percentage;
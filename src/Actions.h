@@ -8,6 +8,9 @@
 #include "EngineCommon.h"
 #include "Node.h"
 #include "Buttons.h"
+#include "Interpolators.h"
+#include "SplinePath.h"
+#include "Random.h"
 
 
 #ifndef _ACTION_H_INCLUDE
@@ -55,6 +58,14 @@ typedef enum {
 	ACTIONTYPE_UNKNOWN,
 } ActionType_t;
 
+/*
+	Declares the functions used by sequence templates (see SequenceTemplate) to copy an action:
+	it must be inserted in the public section of each action class that can be used in a template
+*/
+#define ACTION_CLONEABLE( className ) \
+	Action* Clone() const { return new className( *this ); } \
+	void CopyFrom( const Action *source ) { *this = *static_cast< const className* >( source ); }
+
 // base class for actions
 class Action {
 	
@@ -62,9 +73,15 @@ public:
 
 	// constructor
 	Action();
+	// destructor
+	virtual ~Action();
 
 	// get unique action identifier
 	unsigned int			GetTag();
+
+	// get/set target of action (may be NULL)
+	Node*					GetTarget();
+	void					SetTarget( Node *target );
 	
 	// returns type of action (interval or instant)
 	ActionType_t			GetType();
@@ -75,6 +92,15 @@ public:
 	// this function may be overridden by actions
 	virtual void			Start();
 
+	// returns how long (milliseconds) the action will do nothing but wait, or 0 if the action is not a pure delay;
+	// the ActionManager uses this information to park sleeping sequences outside the per-frame update
+	virtual float			GetSleepTime();
+
+	// returns a new copy of the action, NULL if the action class doesn't declare ACTION_CLONEABLE
+	virtual Action*			Clone() const;
+
+	// copy parameters and state of another action of the same class (declared by ACTION_CLONEABLE)
+	virtual void			CopyFrom( const Action *source );
 
 protected:
 	// target of action
@@ -87,34 +113,166 @@ protected:
 
 
 
-// base class for sequence of actions
+/*
+	Base class for sequence of actions.
+	The list of actions of the constructor must be terminated by NULL, to build sequences with a list of 
+	actions checked by the compiler use MakeSequence() below.
+	The sequence must be allocated with new: the ActionManager takes it and deletes it when it ends.
+*/
 class ActionsSequence {
 	
 public:
 
 	// constructor
 	ActionsSequence( unsigned int tag, Node* target, ... );
+	// destructor (actions are deleted by the ActionManager, not by the sequence)
+	virtual ~ActionsSequence();
 
 	// get unique action identifier
 	unsigned int			GetTag();
 
+	// get target of the sequence
+	Node*					GetTarget();
+
 	// return total number of action in the sequence
 	unsigned int			GetTotalActions();
 
-	// pointer to actions
-	Action					*actions[ ACTIONSSEQUENCE_MAX_SEQUENCE_ACTIONS ];
+	// pointer to actions (the ActionManager uses this array directly while the sequence runs)
+	Action					**actions;
 	// total number of actions
 	unsigned int			totalActions;
 
 protected:
+	// constructor used by sequences with their own storage of actions
+	ActionsSequence( unsigned int tag, Node* target, Action **storage, unsigned int totalActions );
+
 	// target of action
 	Node*					target;		
 	// unique identifier for action
 	unsigned int			tag;		
 
 private:
+	// true if actions array has been allocated by the sequence
+	bool					ownsStorage;
+
+	// sequences can't be copied (the array of actions would be shared)
+	ActionsSequence( const ActionsSequence & );
+	ActionsSequence& operator=( const ActionsSequence & );
+};
+
+// sequence of actions whose array of actions is stored inside the object itself (see MakeSequence)
+template< unsigned int N >
+class InlineActionsSequence : public ActionsSequence {
+
+public:
+
+	InlineActionsSequence( unsigned int tag, Node* target, Action *const ( &actionsList )[ N ] )
+		: ActionsSequence( tag, target, storage, N )
+	{
+		for( unsigned int i = 0; i < N; i++ ) {
+			storage[ i ] = actionsList[ i ];
+		}
+	}
+
+private:
+	Action					*storage[ N ];
+};
 
+/*
+	Build a sequence from an array of actions: the number of actions is known at compile time and the 
+	sequence object and its actions array are a single allocation, used by the ActionManager without copies.
+	Example:
+		Action *actions[] = { new MoveTo( 0, coin, 100, 50, 400 ), new DelayTime( 100 ), new Hide( coin ) };
+		ActionManager::RunSequence( MakeSequence( TAG_COIN, coin, actions ) );
+*/
+template< unsigned int N >
+inline ActionsSequence* MakeSequence( unsigned int tag, Node* target, Action *const ( &actionsList )[ N ] )
+{
+	return new InlineActionsSequence< N >( tag, target, actionsList );
+}
 
+
+// node used by SequenceTemplate as placeholder of the real target: actions created with it as target are not
+// started by their constructor, they are started by the ActionManager once bound to the real target
+class TemplateTarget : public Node {
+};
+
+// returns true if the target is the placeholder of a template
+inline bool IsTemplateTarget( Node *target )
+{
+	return ( dynamic_cast< TemplateTarget* >( target ) != NULL );
+}
+
+/*
+	SequenceTemplate is an immutable sequence of actions defined once and run on any number of nodes.
+	Actions must be created with GetTarget() as target: when the template is run, those actions are 
+	bound to the real target, while actions with no target (delays, callbacks...) or with a different 
+	target are left as they are.
+	Each run takes a copy of the actions from a pool owned by the template and the ActionManager gives 
+	it back when the sequence ends, so after the pool has grown (or has been reserved) running a template 
+	doesn't allocate nor construct any object.
+	Example:
+		SequenceTemplate *coinFly = new SequenceTemplate( TAG_COIN_FLY );
+		coinFly->AddAction( new MoveTo( 0, coinFly->GetTarget(), 100, 50, 400 ) );
+		coinFly->AddAction( new Hide( coinFly->GetTarget() ) );
+		coinFly->Reserve( 20 );
+		...
+		ActionManager::RunTemplate( coinFly, coinSprite, 0 );
+	The template must not be modified nor deleted while its sequences are running.
+*/
+class SequenceTemplate {
+
+public:
+
+	// constructor
+	SequenceTemplate( unsigned int tag );
+	// destructor (deletes the actions of the template and the pool)
+	~SequenceTemplate();
+
+	// get unique identifier of the sequences run from the template
+	unsigned int			GetTag();
+
+	// returns the node that must be used as target by actions that will be bound to the real target
+	Node*					GetTarget();
+
+	// add an action at the end of the template (the template owns the action), returns false if the 
+	// template is full or the action can't be copied (see ACTION_CLONEABLE)
+	bool					AddAction( Action *action );
+
+	// return total number of action in the template
+	unsigned int			GetTotalActions();
+
+	// prepare the copies of the actions for a number of sequences running at the same time
+	void					Reserve( unsigned int instances );
+
+	// used by the ActionManager: returns an array with a copy of the actions of the template bound to target
+	Action**				Acquire( Node *target );
+
+	// used by the ActionManager: give back the array of actions of an ended sequence to the pool
+	void					Release( Action **actions );
+
+private:
+	// unique identifier of the sequences
+	unsigned int			tag;
+	// node used as placeholder of the real target
+	TemplateTarget			placeholder;
+	// actions of the template (never executed)
+	Action					*actions[ ACTIONSSEQUENCE_MAX_SEQUENCE_ACTIONS ];
+	// total number of actions
+	unsigned int			totalActions;
+	// pool of arrays of copies of actions ready to be used, one array for each sequence
+	Action					***pool;
+	// current number of arrays in the pool
+	unsigned int			poolSize;
+	// maximum number of arrays that the pool can contain before growing
+	unsigned int			poolCapacity;
+
+	// make room in the pool for a number of arrays
+	void					GrowPool( unsigned int capacity );
+	// create a new array of copies of the actions
+	Action**				NewInstance();
+	// delete all arrays of the pool
+	void					ClearPool();
 };
 
 
@@ -134,6 +292,7 @@ public:
 class Show : public ActionInstant {
 public:
 	Show( Node* target );
+	ACTION_CLONEABLE( Show )
 	ExecuteResult_t Execute( float deltaTime );
 };
 
@@ -141,6 +300,7 @@ public:
 class Hide : public ActionInstant {
 public:
 	Hide( Node* target );
+	ACTION_CLONEABLE( Hide )
 	ExecuteResult_t Execute( float deltaTime );
 };
 
@@ -148,6 +308,7 @@ public:
 class Place : public ActionInstant {
 public:
 	Place( Node* target, float dstX, float dstY );
+	ACTION_CLONEABLE( Place )
 	ExecuteResult_t Execute( float deltaTime );
 private:
 	Coord_t		position;
@@ -157,6 +318,7 @@ private:
 class PlaceX : public ActionInstant {
 public:
 	PlaceX( Node* target, float dstX );
+	ACTION_CLONEABLE( PlaceX )
 	ExecuteResult_t Execute( float deltaTime );
 private:
 	float		dstX;
@@ -166,6 +328,7 @@ private:
 class PlaceY : public ActionInstant {
 public:
 	PlaceY( Node* target, float dstY );
+	ACTION_CLONEABLE( PlaceY )
 	ExecuteResult_t Execute( float deltaTime );
 private:
 	float		dstY;
@@ -175,6 +338,7 @@ private:
 class Rotate : public ActionInstant {
 public:
 	Rotate( Node* target, float angle );
+	ACTION_CLONEABLE( Rotate )
 	ExecuteResult_t Execute( float deltaTime );
 private:
 	float		angle;
@@ -184,6 +348,7 @@ private:
 class Scale : public ActionInstant {
 public:
 	Scale( Node* target, float scale );
+	ACTION_CLONEABLE( Scale )
 	ExecuteResult_t Execute( float deltaTime );
 private:
 	float		scale;
@@ -193,6 +358,7 @@ private:
 class Alpha : public ActionInstant {
 public:
 	Alpha( Node* target, int alpha );
+	ACTION_CLONEABLE( Alpha )
 	ExecuteResult_t Execute( float deltaTime );
 private:
 	int			alpha;
@@ -202,6 +368,7 @@ private:
 class ZOrderChange : public ActionInstant {
 public:
 	ZOrderChange( Node* target, int newZOrder );
+	ACTION_CLONEABLE( ZOrderChange )
 	ExecuteResult_t Execute( float deltaTime );
 private:
 	int			newZOrder;
@@ -212,6 +379,7 @@ private:
 class TextureChange : public ActionInstant {
 public:
 	TextureChange( Node* target, SDL_Texture *newTexture );
+	ACTION_CLONEABLE( TextureChange )
 	ExecuteResult_t Execute( float deltaTime );
 private:
 	SDL_Texture		*newTexture;
@@ -221,6 +389,7 @@ private:
 class PlayFx : public ActionInstant {
 public:
 	PlayFx( int tag, Mix_Chunk *soundFx, int audioChannel );
+	ACTION_CLONEABLE( PlayFx )
 	void SetSound( Mix_Chunk *soundFx );
 	ExecuteResult_t Execute( float deltaTime );
 private:
@@ -233,6 +402,7 @@ private:
 class RepeatForever : public ActionInstant {
 public:
 	RepeatForever();
+	ACTION_CLONEABLE( RepeatForever )
 	ExecuteResult_t Execute( float deltaTime );
 };
 
@@ -240,6 +410,7 @@ public:
 class RepeatCount : public ActionInstant {
 public:
 	RepeatCount( unsigned int times );
+	ACTION_CLONEABLE( RepeatCount )
 	ExecuteResult_t Execute( float deltaTime );
 private:
 	unsigned int times;
@@ -250,6 +421,7 @@ private:
 class RepeatBackCount : public ActionInstant {
 public:
 	RepeatBackCount( unsigned int nActions, unsigned int times );
+	ACTION_CLONEABLE( RepeatBackCount )
 	ExecuteResult_t Execute( float deltaTime );
 private:
 	unsigned int nActions;
@@ -265,6 +437,7 @@ private:
 class RepeatCondition : public ActionInstant {
 public:
 	RepeatCondition( int tag, bool ( *conditionCallback )( int ) );
+	ACTION_CLONEABLE( RepeatCondition )
 	ExecuteResult_t Execute( float deltaTime );
 private:
 	bool ( *conditionCallback )( int );
@@ -279,6 +452,7 @@ private:
 class RepeatBackCondition : public ActionInstant {
 public:
 	RepeatBackCondition( int tag, unsigned int nActions, bool ( *conditionCallback )( int ) );
+	ACTION_CLONEABLE( RepeatBackCondition )
 	ExecuteResult_t Execute( float deltaTime );
 private:
 	bool ( *conditionCallback )( int );
@@ -293,6 +467,7 @@ private:
 class Callback : public ActionInstant {
 public:
 	Callback( int tag, void ( *callback )( int ) );
+	ACTION_CLONEABLE( Callback )
 	ExecuteResult_t Execute( float deltaTime );
 private:
 	void ( *callback )( int );
@@ -302,6 +477,7 @@ private:
 class CallbackInteger : public ActionInstant {
 public:
 	CallbackInteger( int tag, void ( *callback )( int, int ), int value );
+	ACTION_CLONEABLE( CallbackInteger )
 	ExecuteResult_t Execute( float deltaTime );
 private:
 	void ( *callback )( int, int );
@@ -318,6 +494,7 @@ private:
 class ReleaseButton : public ActionInstant {
 public:
 	ReleaseButton( Button *target );
+	ACTION_CLONEABLE( ReleaseButton )
 	ExecuteResult_t Execute( float deltaTime );
 };
 
@@ -347,88 +524,236 @@ protected:
 	// total duration of action in milliseconds
 	float			duration;		
 	// calculate the percentage (0.0 to 1.0) of the action (=elapsed/duration)
-	float			GetElapsedPercentage();
+	float			GetElapsedPercentage()
+	{
+		float percentage = 0;
+		if( duration > 0 ) {
+			percentage = elapsed / duration;
+			if( percentage > 1 ) {
+				percentage = 1;
+			}
+		} else {
+			percentage = 1;
+		}
+		return percentage;
+	}
 	// interpolatore function pointer (default is linear)
 	float			( *Interpolator )( float );
 };
 
+
+// ================================== Templated tweens ============================================
+// TweenTo interpolates any property of a Node from its current value (read when the action starts) to
+// a final value; the property and the easing are template parameters so the whole update step 
+// (elapsed time, easing, interpolation and setter) is expanded inline by the compiler.
+//
+// A property is a structure with:
+// - Target		-> class of the target object (Node or any subclass)
+// - Value		-> type of the value (float, int, Coord_t)
+// - Get		-> static function that reads the value from the target
+// - Set		-> static function that writes the interpolated value (of type Value) to the target
+//
+// e.g. a custom property of a game object
+//
+//	struct GlowProperty {
+//		typedef MyNode	Target;
+//		typedef float	Value;
+//		static float	Get( MyNode *node ) { return node->GetGlow(); }
+//		static void		Set( MyNode *node, float value ) { node->SetGlow( value ); }
+//	};
+//	TweenTo< GlowProperty, EaseSineOut > *glow = new TweenTo< GlowProperty, EaseSineOut >( 0, myNode, 1.0f, 500 );
+
+// build a coordinate from its components
+inline Coord_t MakeCoord( float x, float y )
+{
+	Coord_t result = { x, y };
+	return result;
+}
+
+// difference between final and start value of a tween
+inline float	TweenDiff( float finalValue, float startValue )		{ return finalValue - startValue; }
+inline int		TweenDiff( int finalValue, int startValue )			{ return finalValue - startValue; }
+inline Coord_t	TweenDiff( Coord_t finalValue, Coord_t startValue )	{ return MakeCoord( finalValue.x - startValue.x, finalValue.y - startValue.y ); }
+
+// value of a tween given start value, difference and interpolated percentage (same type of the values,
+// integers are rounded to the nearest value)
+inline float	TweenLerp( float startValue, float diffValue, float t )		{ return startValue + diffValue * t; }
+inline int		TweenLerp( int startValue, int diffValue, float t )			{ float value = startValue + diffValue * t; return (int)( value + ( value < 0 ? -0.5f : 0.5f ) ); }
+inline Coord_t	TweenLerp( Coord_t startValue, Coord_t diffValue, float t )	{ return MakeCoord( startValue.x + diffValue.x * t, startValue.y + diffValue.y * t ); }
+
+// position of the object (relative to parent)
+struct PositionProperty {
+	typedef Node	Target;
+	typedef Coord_t	Value;
+	static Coord_t	Get( Node *node )					{ return node->GetPosition(); }
+	static void		Set( Node *node, Coord_t value )	{ node->SetPosition( value.x, value.y ); }
+};
+
+// rotation angle of the object
+struct AngleProperty {
+	typedef Node	Target;
+	typedef float	Value;
+	static float	Get( Node *node )					{ return node->GetAngle(); }
+	static void		Set( Node *node, float value )		{ node->SetAngle( value ); }
+};
+
+// size rate of the object
+struct SizeRateProperty {
+	typedef Node	Target;
+	typedef float	Value;
+	static float	Get( Node *node )					{ return node->GetSizeRate(); }
+	static void		Set( Node *node, float value )		{ node->SetSizeRate( value ); }
+};
+
+// horizontal size rate of the object
+struct XSizeRateProperty {
+	typedef Node	Target;
+	typedef float	Value;
+	static float	Get( Node *node )					{ return node->GetXSizeRate(); }
+	static void		Set( Node *node, float value )		{ node->SetXSizeRate( value ); }
+};
+
+// vertical size rate of the object
+struct YSizeRateProperty {
+	typedef Node	Target;
+	typedef float	Value;
+	static float	Get( Node *node )					{ return node->GetYSizeRate(); }
+	static void		Set( Node *node, float value )		{ node->SetYSizeRate( value ); }
+};
+
+// transparency of the object
+struct AlphaProperty {
+	typedef Node	Target;
+	typedef int		Value;
+	static int		Get( Node *node )					{ return node->GetAlpha(); }
+	static void		Set( Node *node, int value )		{ node->SetAlpha( (unsigned char)value ); }
+};
+
+// easing chosen at runtime with SetInterpolation (default, linear unless changed)
+struct EaseSelectable {
+	static float Apply( float percentage, float ( *interpolator )( float ) ) { return interpolator( percentage ); }
+};
+
+// easings fixed at compile time (SetInterpolation has no effect on them)
+#define TWEEN_EASING( name, function )																		\
+	struct name {																							\
+		static float Apply( float percentage, float ( * )( float ) ) { return function( percentage ); }		\
+	};
+
+TWEEN_EASING( EaseLinear,				InterpolatorLinear )
+TWEEN_EASING( EaseSineIn,				InterpolatorSineEaseIn )
+TWEEN_EASING( EaseSineOut,				InterpolatorSineEaseOut )
+TWEEN_EASING( EaseSineInOut,			InterpolatorSineEaseInOut )
+TWEEN_EASING( EaseExpoIn,				InterpolatorExpoEaseIn )
+TWEEN_EASING( EaseExpoOut,				InterpolatorExpoEaseOut )
+TWEEN_EASING( EaseExpoInOut,			InterpolatorExpoEaseInOut )
+TWEEN_EASING( EaseBounceIn,				InterpolatorBounceEaseIn )
+TWEEN_EASING( EaseBounceOut,			InterpolatorBounceEaseOut )
+TWEEN_EASING( EaseBounceInOut,			InterpolatorBounceEaseInOut )
+TWEEN_EASING( EaseElasticIn,			InterpolatorElasticEaseIn )
+TWEEN_EASING( EaseElasticOut,			InterpolatorElasticEaseOut )
+TWEEN_EASING( EaseElasticInOut,			InterpolatorElasticEaseInOut )
+
+#undef TWEEN_EASING
+
+// tween a property to a final value
+template< class Property, class Easing = EaseSelectable >
+class TweenTo : public ActionInterval {
+public:
+	typedef typename Property::Value	Value;
+	typedef typename Property::Target	Target;
+
+	ACTION_CLONEABLE( TweenTo )
+
+	TweenTo( unsigned int tag, Target* target, Value finalValue, float duration )
+	{
+		this->tag			= tag;
+		this->target		= target;
+		this->duration		= duration;
+		this->finalValue	= finalValue;
+		// actions of a template are started once bound to the real target
+		if( !IsTemplateTarget( target ) ) {
+			Start();
+		}
+	}
+
+	void Start()
+	{
+		this->elapsed	= 0;
+		startValue		= Property::Get( static_cast<Target*>( target ) );
+		diffValue		= TweenDiff( finalValue, startValue );
+	}
+
+	ExecuteResult_t Execute( float deltaTime )
+	{
+		float			percentage;
+		float			interpolated_percentage;
+		// update elapsed time from start of action
+		this->elapsed += deltaTime;
+		// get execution percentage (from 0.0 to 1.0) of action (elapsed/duration)
+		percentage = GetElapsedPercentage();
+		// get percentage modified by interpolation
+		interpolated_percentage = Easing::Apply( percentage, Interpolator );
+		// calculate current value by time percentage and set it to the target
+		Property::Set( static_cast<Target*>( target ), TweenLerp( startValue, diffValue, interpolated_percentage ) );
+		// return proper result
+		return ( percentage >= 1 ? EXECUTERESULT_DONE : EXECUTERESULT_IN_PROGRESS );
+	}
+
+protected:
+	Value		startValue;
+	Value		diffValue;
+	Value		finalValue;
+};
+
 // move to a position
-class MoveTo : public ActionInterval {
+class MoveTo : public TweenTo< PositionProperty > {
 public:
 	MoveTo( unsigned int tag, Node* target, float dstX, float dstY, float duration );
-	ExecuteResult_t Execute( float deltaTime );
-	void Start();
-private:
-	Coord_t		src;
-	Coord_t		diff;
-	Coord_t		dst;
+	ACTION_CLONEABLE( MoveTo )
 };
 
 // rotate to an angle
-class RotateTo : public ActionInterval {
+class RotateTo : public TweenTo< AngleProperty > {
 public:
 	RotateTo( unsigned int tag, Node* target, float finalAngle, float duration );
-	ExecuteResult_t Execute( float deltaTime );
-	void Start();
-private:
-	float		startAngle;
-	float		diffAngle;
-	float		finalAngle;
+	ACTION_CLONEABLE( RotateTo )
 };
 
 // resize object to a size
-class ScaleTo : public ActionInterval {
+class ScaleTo : public TweenTo< SizeRateProperty > {
 public:
 	ScaleTo( unsigned int tag, Node* target, float finalSize, float duration );
-	ExecuteResult_t Execute( float deltaTime );
-	void Start();
-private:
-	float		startSize;
-	float		diffSize;
-	float		finalSize;
+	ACTION_CLONEABLE( ScaleTo )
 };
 
 // resize object horizontally to a size
-class ScaleXTo : public ActionInterval {
+class ScaleXTo : public TweenTo< XSizeRateProperty > {
 public:
 	ScaleXTo( unsigned int tag, Node* target, float finalSize, float duration );
-	ExecuteResult_t Execute( float deltaTime );
-	void Start();
-private:
-	float		startSize;
-	float		diffSize;
-	float		finalSize;
+	ACTION_CLONEABLE( ScaleXTo )
 };
 
 // resize object vertically to a size
-class ScaleYTo : public ActionInterval {
+class ScaleYTo : public TweenTo< YSizeRateProperty > {
 public:
 	ScaleYTo( unsigned int tag, Node* target, float finalSize, float duration );
-	ExecuteResult_t Execute( float deltaTime );
-	void Start();
-private:
-	float		startSize;
-	float		diffSize;
-	float		finalSize;
+	ACTION_CLONEABLE( ScaleYTo )
 };
 
 
 // set alpha
-class AlphaTo : public ActionInterval {
+class AlphaTo : public TweenTo< AlphaProperty > {
 public:
 	AlphaTo( unsigned int tag, Node* target, int finalAlpha, float duration );
-	ExecuteResult_t Execute( float deltaTime );
-	void Start();
-private:
-	int			startAlpha;
-	int			diffAlpha;
-	int			finalAlpha;
+	ACTION_CLONEABLE( AlphaTo )
 };
 
 // blink
 class Blink : public ActionInterval {
 public:
 	Blink( unsigned int tag, Node* target, int blinks, float duration );
+	ACTION_CLONEABLE( Blink )
 	ExecuteResult_t Execute( float deltaTime );
 	void Start();
 private:
@@ -439,44 +764,62 @@ private:
 class DelayTime : public ActionInterval {
 public:
 	DelayTime( float duration );
+	ACTION_CLONEABLE( DelayTime )
 	ExecuteResult_t Execute( float deltaTime );
+	float GetSleepTime();
 };
 
-// spline
+// move along a spline at constant speed (if orientToPath is true the target is also rotated along the path)
 class SplineTo : public ActionInterval {
 public:
+	// follow a path shared with other actions
+	SplineTo( unsigned int tag, Node* target, SplinePath *path, float duration, bool orientToPath = false );
+	// follow a path built from an array of points
 	SplineTo( unsigned int tag, Node* target, unsigned int totalPoints, Coord_t *pointsArray, float tension, float duration );
+	SplineTo( const SplineTo &source );
+	~SplineTo();
+	SplineTo& operator=( const SplineTo &source );
+	ACTION_CLONEABLE( SplineTo )
 	ExecuteResult_t Execute( float deltaTime );
 	void Start();
 private:
-	#define ACTIONSPLINETO_MAX_POINTS	48
-	Coord_t			points[ ACTIONSPLINETO_MAX_POINTS ];
-	unsigned int	totalPoints;
-	float			tension;
-	float			deltaT;
-	Coord_t			GetPointAt( unsigned int index );
-	Coord_t			GetSplinePointAt( Coord_t p0, Coord_t p1, Coord_t p2, Coord_t p3, float tension, float t );
+	SplinePath		*path;
+	// position of the target on the path (see SplinePath::GetPositionAt)
+	unsigned int	cursor;
+	bool			orientToPath;
+	void			SetTargetAt( float distance );
 };
 
 // shake
 class Shake : public ActionInterval {
 public:
 	Shake( unsigned int tag, Node* target, float radius, float duration );
+	ACTION_CLONEABLE( Shake )
 	ExecuteResult_t Execute( float deltaTime );
 	void Start();
+	// set the seed of the random generator (default is the tag): each start of the action takes the next
+	// stream of the seed, so actions with the same seed shake the same way (copies of a template start
+	// from the stream of the template)
+	void SetRandomSeed( Uint32 seed );
 private:
 	Coord_t			originalPosition;
 	float			radius;
-	uint32_t		seed;
+	// random generator of the action, the stream id is the number of previous starts
+	RandomStream	random;
+	Uint32			randomSeed;
+	Uint32			totalStarts;
 };
 
-// TintTo (for SDL_Texture objects only!, not Node*)
+// TintTo (for SDL_Texture objects only!, not Node*, see SpriteTintTo)
 class TintTo : public ActionInterval {
 public:
 	TintTo( unsigned int tag, SDL_Texture* texture, unsigned char r, unsigned char g, unsigned char b, float duration );
+	ACTION_CLONEABLE( TintTo )
 	ExecuteResult_t Execute( float deltaTime );
 	void Start();
-private:
+protected:
+	// constructor for subclasses, that set the target and the final color
+	TintTo() {}
 	SDL_Texture		*targetTexture;
 	Color_t			startColor;
 	Color_t			finalColor;
@@ -485,6 +828,14 @@ private:
 	int				diffB;
 };
 
+// SpriteTintTo (TintTo for the texture of a Sprite, the texture is taken from the target at start,
+// nothing is done if the target is not a Sprite)
+class SpriteTintTo : public TintTo {
+public:
+	SpriteTintTo( unsigned int tag, Node* target, unsigned char r, unsigned char g, unsigned char b, float duration );
+	ACTION_CLONEABLE( SpriteTintTo )
+};
+
 
 
 #endif
\ No newline at end of file
@@ -8,6 +8,10 @@
 #include <SDL.h>
 #include "AnimatedSprite.h"
 #include "Engine.h"
+#include "Clock.h"
+
+// time (milliseconds) each frame of the animation is displayed
+#define ANIMATEDSPRITE_FRAME_TIME		20
 
 
 AnimatedSprite::AnimatedSprite( SDL_Texture **textures, unsigned int n_frames, unsigned int tag, unsigned int zOrder )
@@ -21,6 +25,7 @@ AnimatedSprite::AnimatedSprite( SDL_Texture **textures, unsigned int n_frames, u
 	this->isPlaying		= false;
 	this->current_loop	= 0;
 	this->total_loops	= 0;
+	this->frame_elapsed	= 0;
 }
 
 void AnimatedSprite::PlayOnce()
@@ -72,14 +77,12 @@ void AnimatedSprite::Draw()
 		// if animation is active...
 		if( isPlaying ) {
 
-			// whatever FPS we don't update stream if at least 20 ms elapsed from last update
-			static Uint32	lastUpdateTicks	= 0;
-			Uint32 now  = Engine::GetDrawSceneTicks();
-			Uint32 diff = now - lastUpdateTicks;
-			if( diff < 20 ) {
+			// whatever FPS we don't go to the next frame until at least 20 ms elapsed from last change
+			frame_elapsed += Clock::GetSceneDeltaTime();
+			if( frame_elapsed < ANIMATEDSPRITE_FRAME_TIME ) {
 				return; 
 			}
-			lastUpdateTicks = now;
+			frame_elapsed = 0;
 
 			// incremnt current index
 			current_frame += 1;
@@ -53,6 +53,7 @@ private:
 	bool			isPlaying;		// animation in progress 
 	int				current_loop;	// number of executed loops
 	int				total_loops;	// total number of loops
+	double			frame_elapsed;	// time elapsed since the current frame has been displayed
 };
 
 
@@ -50,7 +50,8 @@ void Button::StartPushAnimation()
 	DelayTime		*delayTime		= new DelayTime( 100 );
 	ReleaseButton	*releaseButton	= new ReleaseButton( this );
 	ActionsSequence *releaseSeq = new ActionsSequence( 0, this, delayTime, releaseButton, NULL );
-	ActionManager::RunSequence( releaseSeq );
+	// the release runs on the global timeline: if the scene changes meanwhile the button must be released anyway
+	ActionManager::RunGlobalSequence( releaseSeq );
 
 	// create a sequence that animates button: it become a little bigger and return back to default size
 	if( defaultAnimation ) {
@@ -0,0 +1,134 @@
+/*
+ 	The information contained herein is confidential.
+ 	The use, copying, transfer or disclosure of such information is proibited
+ 	except by press written agreement with the author
+*/
+
+#include <stdio.h>
+#include <algorithm>
+#include "Clock.h"
+#include "Scene.h"
+
+// longest delta time (milliseconds) accepted for a single frame: after a breakpoint or a window drag
+// all subsystems would otherwise jump ahead in a single step
+#define CLOCK_MAX_DELTA_TIME		250.0
+
+// performance counter value at the previous frame (0 before the first frame)
+static Uint64		lastCounter		= 0;
+// global time scale
+static float		timeScale		= 1.0f;
+// if true the time is stopped
+static bool			paused			= false;
+// fixed step of each frame in manual step mode (0 for real time)
+static double		manualStep		= 0;
+// time elapsed from the previous frame without any scaling
+static double		realDeltaTime	= 0;
+// scaled time elapsed from the previous frame
+static double		deltaTime		= 0;
+// scaled time elapsed from the previous frame for the current scene
+static double		sceneDeltaTime	= 0;
+// total scaled time
+static double		totalTime		= 0;
+// total number of frames
+static Uint32		frameCount		= 0;
+
+// reset clock data
+void Clock::Initialize()
+{
+	lastCounter		= 0;
+	timeScale		= 1.0f;
+	paused			= false;
+	manualStep		= 0;
+	realDeltaTime	= 0;
+	deltaTime		= 0;
+	sceneDeltaTime	= 0;
+	totalTime		= 0;
+	frameCount		= 0;
+}
+
+// advance the clock by one frame
+void Clock::Tick( Scene *scene )
+{
+	Uint64 now = SDL_GetPerformanceCounter();
+	// the first frame has no previous frame to measure from
+	if( lastCounter == 0 ) {
+		realDeltaTime = 0;
+	} else {
+		realDeltaTime = (double)( now - lastCounter ) * 1000 / (double)SDL_GetPerformanceFrequency();
+	}
+	lastCounter = now;
+
+	if( paused ) {
+		deltaTime = 0;
+	} else if( manualStep > 0 ) {
+		// in manual step mode the real time is ignored
+		deltaTime = manualStep * timeScale;
+	} else {
+		deltaTime = ( std::min )( realDeltaTime, CLOCK_MAX_DELTA_TIME ) * timeScale;
+	}
+	// objects of the current scene also follow the time scale of the scene
+	sceneDeltaTime = deltaTime;
+	if( scene != NULL ) {
+		sceneDeltaTime *= scene->GetTimeScale();
+	}
+	totalTime	+= deltaTime;
+	frameCount	+= 1;
+}
+
+void Clock::SetTimeScale( float scale )
+{
+	if( scale < 0 ) {
+		scale = 0;
+	}
+	timeScale = scale;
+}
+
+float Clock::GetTimeScale()
+{
+	return timeScale;
+}
+
+void Clock::SetPaused( bool state )
+{
+	paused = state;
+}
+
+bool Clock::IsPaused()
+{
+	return paused;
+}
+
+void Clock::SetManualStep( double stepTime )
+{
+	manualStep = ( stepTime > 0 ? stepTime : 0 );
+}
+
+double Clock::GetManualStep()
+{
+	return manualStep;
+}
+
+double Clock::GetDeltaTime()
+{
+	return deltaTime;
+}
+
+double Clock::GetSceneDeltaTime()
+{
+	return sceneDeltaTime;
+}
+
+double Clock::GetRealDeltaTime()
+{
+	return realDeltaTime;
+}
+
+double Clock::GetTime()
+{
+	return totalTime;
+}
+
+Uint32 Clock::GetFrameCount()
+{
+	return frameCount;
+}
@@ -0,0 +1,60 @@
+/*
+ 	The information contained herein is confidential.
+ 	The use, copying, transfer or disclosure of such information is proibited
+ 	except by press written agreement with the author
+*/
+
+#ifndef _CLOCK_H_INCLUDE
+#define _CLOCK_H_INCLUDE
+
+#include <SDL.h>
+
+class Scene;
+
+/*
+	This is the Clock, the single source of time of the engine: it is advanced by the engine once per frame 
+	(see Engine::DrawScene) and all subsystems (actions, animated sprites, particles, movies) read the time
+	elapsed from the previous frame from here.
+	All times are in milliseconds.
+	- the time can be scaled (slow motion / fast forward) globally and for each scene (see Scene::SetTimeScale)
+	- the time can be paused: all subsystems get a zero elapsed time
+	- in manual step mode each frame advances the time by a fixed step whatever the real elapsed time is, so
+	  benchmarks and replays produce identical results frame by frame
+*/
+namespace Clock {
+
+	// reset clock data
+	void Initialize();
+
+	// advance the clock by one frame, called by the engine before updating the current scene
+	void Tick( Scene *scene );
+
+	// set/get global time scale (1.0 = real time, 0.5 = half speed, ...)
+	void SetTimeScale( float scale );
+	float GetTimeScale();
+
+	// pause or resume the time
+	void SetPaused( bool state );
+	bool IsPaused();
+
+	// set manual step mode: each frame advances the time exactly by stepTime milliseconds (0 to return to real time)
+	void SetManualStep( double stepTime );
+	double GetManualStep();
+
+	// returns the time elapsed from the previous frame (scaled by the global time scale), used by global subsystems
+	double GetDeltaTime();
+
+	// returns the time elapsed from the previous frame for objects of the current scene (scaled by global and scene time scale)
+	double GetSceneDeltaTime();
+
+	// returns the time elapsed from the previous frame without scaling, pause or manual step
+	double GetRealDeltaTime();
+
+	// returns total time (sum of all scaled delta times) from clock initialization
+	double GetTime();
+
+	// returns total number of frames from clock initialization
+	Uint32 GetFrameCount();
+};
+
+#endif
@@ -8,6 +8,12 @@
 #include "MovieManager.h"
 #include "FontManager.h"
 #include "ActionManager.h"
+#include "Clock.h"
+#include "ParticleManager.h"
+#include "ThreadPool.h"
+#include "TextCache.h"
+#include "TextBatch.h"
+#include "Labels.h"
 
 // maximum number of scene we can add
 #define ENGINE_MAX_SCENES	24
@@ -47,6 +53,10 @@ void Engine::Initialize( Config_t *config )
 	currentScene = NULL;
 	// reset software button pressed flag
 	buttonCurrentlyPressed = false;
+	// reset the time of the engine
+	Clock::Initialize();
+	// start worker threads (one for each core except the main one)
+	ThreadPool::Initialize( 0 );
 }
 
 // close the engine before quit
@@ -60,6 +70,12 @@ void Engine::Terminate()
 	for( int i = 0; i < totalScenes; i++ ) {
 		scenes[ i ]->Delete();
 	}
+	// destroy textures of texts
+	TextCache::Terminate();
+	// delete sequences of the global timeline and the pool of sequences
+	ActionManager::Terminate();
+	// stop worker threads
+	ThreadPool::Terminate();
 }
 
 // get current ticks (SDL_GetTicks()) when the scene is redrawn
@@ -74,11 +90,21 @@ void Engine::DrawScene()
 	// update ticks of call
 	drawSceneTicks = SDL_GetTicks();
 
+	// advance the time of the engine by one frame, every subsystem reads its delta time from the clock
+	Clock::Tick( currentScene );
+
 	// update textures of all active streamings
 	MovieManager::Update();
 
 	// update active actions
-	ActionManager::Update();
+	// update the global actions and the actions of the current scene (the other scenes are frozen)
+	ActionManager::Update( currentScene );
+
+	// simulate particle systems of the current scene (on worker threads), drawing only uses the result
+	ParticleManager::Update( currentScene );
+
+	// rasterize the labels changed since previous frame
+	Label::UpdatePendingLabels();
 
 	// clear renderer surface
 	SDL_RenderClear( engineConfig.renderer );
@@ -90,6 +116,8 @@ void Engine::DrawScene()
 			currentScene->children[ i ]->Visit();
 		}
 	} 
+	// draw the glyphs of the last labels
+	TextBatch::Flush();
 
 	// copy render to video
 	SDL_RenderPresent( engineConfig.renderer );
@@ -138,6 +166,25 @@ bool Engine::SetCurrentScene( unsigned int sceneId )
 	return result;
 }
 
+// return the scene containing the node
+Scene* Engine::GetNodeScene( Node *node )
+{
+	if( node == NULL ) {
+		return NULL;
+	}
+	// go up to the root of the tree of the node...
+	while( node->GetParent() != NULL ) {
+		node = node->GetParent();
+	}
+	// ...that must be one of the scenes added to the engine
+	for( int i = 0; i < totalScenes; i++ ) {
+		if( scenes[ i ] == node ) {
+			return scenes[ i ];
+		}
+	}
+	return NULL;
+}
+
 void Engine::Touch( int x, int y )
 {
 	// scan all clickable objects of current scene
@@ -40,6 +40,9 @@ namespace Engine {
 	// set scene to render
 	bool SetCurrentScene( unsigned int sceneId );
 
+	// return the scene containing the node (NULL if the node doesn't belong to any scene)
+	Scene* GetNodeScene( Node *node );
+
 	// called when the player touches the screen
 	void Touch( int x, int y );
 
@@ -7,6 +7,8 @@
 #include <stdio.h>
 #include "FontManager.h"
 #include "Engine.h"
+#include "GlyphAtlas.h"
+#include "Misc.h"
 
 
 // this is the maximum number of true type fonts
@@ -44,22 +46,71 @@ static long				totalBMPFonts			= 0;
 // data of alla available bitmap fonts
 static BMPFontData_t	BMPFontsData[ FONTMANAGER_MAX_BMP_FONTS ];
 
+// remove all characters and kerning data of a bitmap font
+static void ClearBMPFontData( BMPFontData_t *fontData )
+{
+	fontData->fontId		= -1;	// empty slots are not found by GetBMPFontData
+	fontData->lineHeight	= 0;
+	memset( &fontData->padding, 0, sizeof( BMPFontPadding_t ) );
+	fontData->totalChars	= 0;
+	fontData->charsData.clear();
+	for( int i = 0; i < BMPFONT_DIRECT_CHARS; i++ ) {
+		fontData->directChars[ i ] = -1;
+	}
+	fontData->otherChars.clear();
+	fontData->totalKerningItems	= 0;
+	fontData->kerning.clear();
+	fontData->texture		= NULL;
+	fontData->totalPages	= 0;
+	for( int i = 0; i < BMPFONT_MAX_PAGES; i++ ) {
+		fontData->pages[ i ]		= NULL;
+		fontData->loadedPages[ i ]	= false;
+	}
+}
+
+// destroy the pages of a bitmap font loaded by FontManager (the others belong to the game)
+static void ReleaseBMPFontPages( BMPFontData_t *fontData )
+{
+	for( int i = 0; i < BMPFONT_MAX_PAGES; i++ ) {
+		if( fontData->loadedPages[ i ] ) {
+			SDL_DestroyTexture( fontData->pages[ i ] );
+		}
+		fontData->pages[ i ]		= NULL;
+		fontData->loadedPages[ i ]	= false;
+	}
+	fontData->texture = NULL;
+}
+
+// key of the kerning map
+static Uint64 KerningKey( unsigned int firstCharID, unsigned int secondCharID )
+{
+	return ( (Uint64)firstCharID << 32 ) | secondCharID;
+}
+
 // reset font manager data
 void FontManager::Reset()
 {
 	// total number of allocated fonts by FontManager
 	memset( &TTFontsData, 0, sizeof( TTFontsData ) ); 
 	// reset data for each bitmap font
-	memset( &BMPFontsData, 0, sizeof( BMPFontsData ) ); 
+	for( int i = 0; i < FONTMANAGER_MAX_BMP_FONTS; i++ ) {
+		ClearBMPFontData( &BMPFontsData[ i ] );
+	}
 }
 
 // free allocated resources
 void FontManager::Terminate()
 {
+	// destroy the glyph atlases (they use the fonts)
+	GlyphAtlas::ReleaseAll();
 	// close all opened fonts and free memory
 	for( int i = 0; i < totalTTFonts; i++ ) {
 		TTF_CloseFont( TTFontsData[ i ].font );
 	}	
+	// destroy pages of bitmap fonts loaded by FontManager
+	for( int i = 0; i < totalBMPFonts; i++ ) {
+		ReleaseBMPFontPages( &BMPFontsData[ i ] );
+	}
 }
 
 // setup Font Manager with all avalaible True Type fonts files
@@ -112,6 +163,37 @@ TTF_Font* FontManager::GetTTFont( int fontId, int fontSize )
 
 
 
+// add a character to a bitmap font (if a character is defined twice the first definition is used)
+static void AddBMPChar( BMPFontData_t *fontData, const CharData_t *charData )
+{
+	if( FontManager::GetBMPChar( fontData, charData->charID ) != NULL ) {
+		return;
+	}
+	int index = (int)fontData->charsData.size();
+	fontData->charsData.push_back( *charData );
+	if( charData->charID < BMPFONT_DIRECT_CHARS ) {
+		fontData->directChars[ charData->charID ] = index;
+	} else {
+		fontData->otherChars[ charData->charID ] = index;
+	}
+	fontData->totalChars += 1;
+}
+
+// add a kerning couple to a bitmap font (if a couple is defined twice the first definition is used)
+static void AddBMPKerning( BMPFontData_t *fontData, const KerningData_t *kerningItem )
+{
+	Uint64 key = KerningKey( kerningItem->firstCharID, kerningItem->secondCharID );
+	if( fontData->kerning.find( key ) == fontData->kerning.end() ) {
+		fontData->kerning[ key ] = kerningItem->amount;
+		fontData->totalKerningItems += 1;
+	}
+}
+
+#ifdef FONTMANAGER_BENCHMARK
+
+// ============================== line by line parser, used before the single pass loader ==============================
+// (kept to compare the two in BenchmarkBMPFontParsers)
+
 static void ParseInfoArguments( string line, BMPFontPadding_t *padding )
 {
     // padding
@@ -207,7 +289,7 @@ static void ParseKerningEntry( string line, KerningData_t *kerningItem )
 }
 
 
-static bool ParseBMPFontFile( const char *filename, BMPFontData_t *fontData )
+static bool ParseBMPFontFileLegacy( const char *filename, BMPFontData_t *fontData )
 {
 	string		line;
 	ifstream	fontfile( filename );	// open the bitmap descriptor font file 
@@ -217,6 +299,8 @@ static bool ParseBMPFontFile( const char *filename, BMPFontData_t *fontData )
 		printf( "Cannot open input file.\n" );
 		return false;
 	}
+	// characters of a previous load are removed
+	ClearBMPFontData( fontData );
 
 	/*
 		read the file line by line, a typical file should appear like this 
@@ -246,21 +330,17 @@ static bool ParseBMPFontFile( const char *filename, BMPFontData_t *fontData )
 			// we found the fourth line, indicating total number of chars
 			// TODO we could use this value for double checking extracted data
 		} else if( line.substr( 0, strlen( "char" ) ) == "char" ) {
-			// we find a line describing a character, if we have not reached maximum chars number..
-			if( fontData->totalChars < MAX_BMPFONT_CHARS ) {
-				// parse the content of the line
-				ParseCharacterDefinition( line, &fontData->charsData[ fontData->totalChars ] );
-				// increase total number of chars
-				fontData->totalChars += 1;
-			}
+			// we find a line describing a character, parse the content of the line
+			CharData_t charData;
+			memset( &charData, 0, sizeof( CharData_t ) );
+			ParseCharacterDefinition( line, &charData );
+			AddBMPChar( fontData, &charData );
 		} else if( line.substr( 0, strlen( "kerning first" ) ) == "kerning first" ) {
-			// we find a line describing a kerning case, if we have not reached maximum number of cases..
-			if( fontData->totalKerningItems < MAX_KERNING_DATA ) {
-				// parse the content of the line
-				ParseKerningEntry( line, &fontData->kerning[ fontData->totalKerningItems ] );
-				// increase total number of cases
-				fontData->totalKerningItems += 1;
-			}
+			// we find a line describing a kerning case, parse the content of the line
+			KerningData_t kerningItem;
+			memset( &kerningItem, 0, sizeof( KerningData_t ) );
+			ParseKerningEntry( line, &kerningItem );
+			AddBMPKerning( fontData, &kerningItem );
 		}
 	}
 	// close the file
@@ -269,26 +349,349 @@ static bool ParseBMPFontFile( const char *filename, BMPFontData_t *fontData )
 	return true;
 }
 
+#endif
+
+// ============================== single pass loader ==============================
+
+// portion of the mapped file (text is never copied)
+typedef struct {
+	const char		*begin;
+	const char		*end;
+} Token_t;
+
+// returns true if the token is equal to a text
+static bool TokenIs( const Token_t *token, const char *text )
+{
+	size_t length = strlen( text );
+	return ( ( size_t )( token->end - token->begin ) == length ) && ( memcmp( token->begin, text, length ) == 0 );
+}
+
+// returns the integer value of a token, for list of values separated by comma (e.g. "2,2,2,2") index selects the value
+static int TokenToInt( const Token_t *token, int index )
+{
+	const char	*p			= token->begin;
+	int			value		= 0;
+	bool		negative	= false;
+
+	for( ; ( index > 0 ) && ( p < token->end ); p++ ) {
+		if( *p == ',' ) {
+			index -= 1;
+		}
+	}
+	if( ( p < token->end ) && ( *p == '-' ) ) {
+		negative = true;
+		p++;
+	}
+	for( ; ( p < token->end ) && ( *p >= '0' ) && ( *p <= '9' ); p++ ) {
+		value = value * 10 + ( *p - '0' );
+	}
+	return ( negative ? -value : value );
+}
+
+static bool IsBlank( char c )
+{
+	return ( c == ' ' ) || ( c == '\t' ) || ( c == '\r' );
+}
+
+/*
+	parse a text file with a single pass, each line is made of a tag followed by key=value pairs:
+
+	info face="font" size=72 bold=1 italic=0 charset="" unicode=1 stretchH=100 smooth=1 aa=1 padding=2,2,2,2 spacing=0,0
+	common lineHeight=80 base=53 scaleW=383 scaleH=512 pages=1 packed=0
+	page id=0 file="font.png"
+	chars count=55
+	char id=65 x=2 y=2 width=61 height=61 xoffset=0 yoffset=1 xadvance=52 page=0 chnl=15
+	kernings count=10
+	kerning first=121 second=44 amount=-7
+*/
+static bool ParseBMPFontText( const char *data, const char *end, BMPFontData_t *fontData, vector<string> *pageFiles )
+{
+	const char		*p = data;
+	Token_t			tag, key, value;
+	CharData_t		charData;
+	KerningData_t	kerningItem;
+	int				pageId;
+
+	while( p < end ) {
+		// tag of the line
+		while( ( p < end ) && ( IsBlank( *p ) || ( *p == '\n' ) ) ) {
+			p++;
+		}
+		tag.begin = p;
+		while( ( p < end ) && !IsBlank( *p ) && ( *p != '\n' ) ) {
+			p++;
+		}
+		tag.end = p;
+		memset( &charData, 0, sizeof( CharData_t ) );
+		memset( &kerningItem, 0, sizeof( KerningData_t ) );
+		pageId = -1;
+		// values of the line
+		while( ( p < end ) && ( *p != '\n' ) ) {
+			if( IsBlank( *p ) ) {
+				p++;
+				continue;
+			}
+			key.begin = p;
+			while( ( p < end ) && ( *p != '=' ) && !IsBlank( *p ) && ( *p != '\n' ) ) {
+				p++;
+			}
+			key.end = p;
+			if( ( p >= end ) || ( *p != '=' ) ) {
+				continue;
+			}
+			p++;
+			if( ( p < end ) && ( *p == '"' ) ) {
+				value.begin = ++p;
+				while( ( p < end ) && ( *p != '"' ) && ( *p != '\n' ) ) {
+					p++;
+				}
+				value.end = p;
+				if( ( p < end ) && ( *p == '"' ) ) {
+					p++;
+				}
+			} else {
+				value.begin = p;
+				while( ( p < end ) && !IsBlank( *p ) && ( *p != '\n' ) ) {
+					p++;
+				}
+				value.end = p;
+			}
+			// store the value
+			if( TokenIs( &tag, "char" ) ) {
+				if( TokenIs( &key, "id" ) )					charData.charID		= TokenToInt( &value, 0 );
+				else if( TokenIs( &key, "x" ) )				charData.rect.x		= TokenToInt( &value, 0 );
+				else if( TokenIs( &key, "y" ) )				charData.rect.y		= TokenToInt( &value, 0 );
+				else if( TokenIs( &key, "width" ) )			charData.rect.w		= TokenToInt( &value, 0 );
+				else if( TokenIs( &key, "height" ) )		charData.rect.h		= TokenToInt( &value, 0 );
+				else if( TokenIs( &key, "xoffset" ) )		charData.xOffset	= TokenToInt( &value, 0 );
+				else if( TokenIs( &key, "yoffset" ) )		charData.yOffset	= TokenToInt( &value, 0 );
+				else if( TokenIs( &key, "xadvance" ) )		charData.xAdvance	= TokenToInt( &value, 0 );
+				else if( TokenIs( &key, "page" ) )			charData.page		= TokenToInt( &value, 0 );
+			} else if( TokenIs( &tag, "kerning" ) ) {
+				if( TokenIs( &key, "first" ) )				kerningItem.firstCharID		= TokenToInt( &value, 0 );
+				else if( TokenIs( &key, "second" ) )		kerningItem.secondCharID	= TokenToInt( &value, 0 );
+				else if( TokenIs( &key, "amount" ) )		kerningItem.amount			= TokenToInt( &value, 0 );
+			} else if( TokenIs( &tag, "info" ) ) {
+				if( TokenIs( &key, "padding" ) ) {
+					fontData->padding.top		= TokenToInt( &value, 0 );
+					fontData->padding.right		= TokenToInt( &value, 1 );
+					fontData->padding.bottom	= TokenToInt( &value, 2 );
+					fontData->padding.left		= TokenToInt( &value, 3 );
+				}
+			} else if( TokenIs( &tag, "common" ) ) {
+				if( TokenIs( &key, "lineHeight" ) )			fontData->lineHeight = TokenToInt( &value, 0 );
+			} else if( TokenIs( &tag, "page" ) ) {
+				if( TokenIs( &key, "id" ) ) {
+					pageId = TokenToInt( &value, 0 );
+				} else if( TokenIs( &key, "file" ) && ( pageId >= 0 ) && ( pageId < BMPFONT_MAX_PAGES ) ) {
+					if( (int)pageFiles->size() <= pageId ) {
+						pageFiles->resize( pageId + 1 );
+					}
+					( *pageFiles )[ pageId ].assign( value.begin, value.end );
+				}
+			} else if( TokenIs( &tag, "chars" ) ) {
+				if( TokenIs( &key, "count" ) )				fontData->charsData.reserve( TokenToInt( &value, 0 ) );
+			}
+		}
+		// a line describing a character or a kerning case is complete
+		if( TokenIs( &tag, "char" ) ) {
+			AddBMPChar( fontData, &charData );
+		} else if( TokenIs( &tag, "kerning" ) ) {
+			AddBMPKerning( fontData, &kerningItem );
+		}
+	}
+	return true;
+}
+
+// BMFont binary format: "BMF", version and blocks made of type (1 byte), size (4 bytes) and data
+#define BMFONT_BINARY_VERSION		3
+#define BMFONT_BLOCK_INFO			1
+#define BMFONT_BLOCK_COMMON			2
+#define BMFONT_BLOCK_PAGES			3
+#define BMFONT_BLOCK_CHARS			4
+#define BMFONT_BLOCK_KERNING		5
+#define BMFONT_CHAR_SIZE			20
+#define BMFONT_KERNING_SIZE			10
+
+// values are little endian and not aligned
+static Uint16 ReadU16( const unsigned char *p )
+{
+	return (Uint16)( p[ 0 ] | ( p[ 1 ] << 8 ) );
+}
+
+static Uint32 ReadU32( const unsigned char *p )
+{
+	return (Uint32)p[ 0 ] | ( (Uint32)p[ 1 ] << 8 ) | ( (Uint32)p[ 2 ] << 16 ) | ( (Uint32)p[ 3 ] << 24 );
+}
+
+static bool ParseBMPFontBinary( const unsigned char *data, unsigned int size, BMPFontData_t *fontData, vector<string> *pageFiles )
+{
+	const unsigned char	*p		= data + 4;
+	const unsigned char	*end	= data + size;
+	CharData_t			charData;
+	KerningData_t		kerningItem;
+
+	if( data[ 3 ] != BMFONT_BINARY_VERSION ) {
+		printf( "FontManager: unsupported version %d of binary font\n", data[ 3 ] );
+		return false;
+	}
+	while( p + 5 <= end ) {
+		int		type		= p[ 0 ];
+		Uint32	blockSize	= ReadU32( p + 1 );
+		p += 5;
+		if( blockSize > (Uint32)( end - p ) ) {
+			printf( "FontManager: invalid block in binary font\n" );
+			return false;
+		}
+		switch( type ) {
+			case BMFONT_BLOCK_INFO:
+				// fontSize (2), bitField, charSet, stretchH (2), aa, padding (up, right, down, left), ...
+				if( blockSize >= 11 ) {
+					fontData->padding.top		= p[ 7 ];
+					fontData->padding.right		= p[ 8 ];
+					fontData->padding.bottom	= p[ 9 ];
+					fontData->padding.left		= p[ 10 ];
+				}
+			break;
+			case BMFONT_BLOCK_COMMON:
+				// lineHeight (2), base (2), scaleW (2), scaleH (2), pages (2), ...
+				if( blockSize >= 2 ) {
+					fontData->lineHeight = ReadU16( p );
+				}
+			break;
+			case BMFONT_BLOCK_PAGES:
+				// null terminated names
+				for( const unsigned char *name = p; ( name < p + blockSize ) && ( (int)pageFiles->size() < BMPFONT_MAX_PAGES ); ) {
+					const unsigned char *nameEnd = (const unsigned char *)memchr( name, 0, p + blockSize - name );
+					if( nameEnd == NULL ) {
+						nameEnd = p + blockSize;
+					}
+					pageFiles->push_back( string( (const char *)name, (const char *)nameEnd ) );
+					name = nameEnd + 1;
+				}
+			break;
+			case BMFONT_BLOCK_CHARS:
+				// id (4), x, y, width, height (2 each), xoffset, yoffset, xadvance (2 each, signed), page, channel
+				fontData->charsData.reserve( blockSize / BMFONT_CHAR_SIZE );
+				for( Uint32 i = 0; i + BMFONT_CHAR_SIZE <= blockSize; i += BMFONT_CHAR_SIZE ) {
+					const unsigned char *c = p + i;
+					memset( &charData, 0, sizeof( CharData_t ) );
+					charData.charID		= ReadU32( c );
+					charData.rect.x		= ReadU16( c + 4 );
+					charData.rect.y		= ReadU16( c + 6 );
+					charData.rect.w		= ReadU16( c + 8 );
+					charData.rect.h		= ReadU16( c + 10 );
+					charData.xOffset	= (short)ReadU16( c + 12 );
+					charData.yOffset	= (short)ReadU16( c + 14 );
+					charData.xAdvance	= (short)ReadU16( c + 16 );
+					charData.page		= c[ 18 ];
+					AddBMPChar( fontData, &charData );
+				}
+			break;
+			case BMFONT_BLOCK_KERNING:
+				// first (4), second (4), amount (2, signed)
+				for( Uint32 i = 0; i + BMFONT_KERNING_SIZE <= blockSize; i += BMFONT_KERNING_SIZE ) {
+					const unsigned char *k = p + i;
+					memset( &kerningItem, 0, sizeof( KerningData_t ) );
+					kerningItem.firstCharID		= ReadU32( k );
+					kerningItem.secondCharID	= ReadU32( k + 4 );
+					kerningItem.amount			= (short)ReadU16( k + 8 );
+					AddBMPKerning( fontData, &kerningItem );
+				}
+			break;
+		}
+		p += blockSize;
+	}
+	return true;
+}
+
+// parse a text or binary font file mapped in memory, names of the pages are returned in pageFiles
+static bool ParseBMPFontFile( const char *filename, BMPFontData_t *fontData, vector<string> *pageFiles )
+{
+	Misc::MappedFile_t	file;
+	bool				result;
+
+	if( !Misc::MapFile( filename, &file ) ) {
+		printf( "Cannot open input file.\n" );
+		return false;
+	}
+	// pages and characters of a previous load are removed
+	ReleaseBMPFontPages( fontData );
+	ClearBMPFontData( fontData );
+	pageFiles->clear();
+	if( ( file.size >= 4 ) && ( memcmp( file.data, "BMF", 3 ) == 0 ) ) {
+		result = ParseBMPFontBinary( file.data, file.size, fontData, pageFiles );
+	} else {
+		result = ParseBMPFontText( (const char *)file.data, (const char *)file.data + file.size, fontData, pageFiles );
+	}
+	Misc::UnmapFile( &file );
+	return result;
+}
+
+// returns the directory of a file (including the final separator)
+static string GetDirectory( const char *filename )
+{
+	string path( filename );
+	size_t separator = path.find_last_of( "/\\" );
+	return ( separator == string::npos ? string() : path.substr( 0, separator + 1 ) );
+}
+
+// set the pages of a font: the first one is given by the game (if not NULL), the others are loaded from their files;
+// returns false if the first page is missing (characters of the other missing pages are drawn from the first one)
+static bool LoadBMPFontPages( BMPFontData_t *fontData, const char *filename, const vector<string> &pageFiles, SDL_Texture *texture )
+{
+	fontData->totalPages = ( pageFiles.empty() ? 1 : (int)pageFiles.size() );
+	for( int i = 0; i < fontData->totalPages; i++ ) {
+		if( ( i == 0 ) && ( texture != NULL ) ) {
+			fontData->pages[ i ] = texture;
+		} else if( ( i < (int)pageFiles.size() ) && !pageFiles[ i ].empty() ) {
+			string path = GetDirectory( filename ) + pageFiles[ i ];
+			fontData->pages[ i ] = IMG_LoadTexture( Engine::GetRenderer(), path.c_str() );
+			if( fontData->pages[ i ] != NULL ) {
+				fontData->loadedPages[ i ] = true;
+			} else {
+				printf( "FontManager: unable to load %s\n", path.c_str() );
+			}
+		}
+	}
+	fontData->texture = fontData->pages[ 0 ];
+	if( fontData->texture == NULL ) {
+		printf( "FontManager: no texture for the first page of %s\n", filename );
+		ReleaseBMPFontPages( fontData );
+		return false;
+	}
+	return true;
+}
+
 bool FontManager::LoadBMPFontsFiles( long totalBMPFontsFiles, BMPFontResource_t *BMPFontResources )
 {
 	BMPFontResource_t *pBMPFontResource;
+	bool result = true;
 	// point to the first item of the table containing bitmap fonts data
 	pBMPFontResource = BMPFontResources;
 	// scan all bitmap font initialization data
 	for( int i = 0; i < totalBMPFontsFiles; i++ ) {
+		vector<string> pageFiles;
 		// try to parse the configuration file 
-		if( ParseBMPFontFile( pBMPFontResource->filename, &BMPFontsData[ i ] ) ) {
+		// store the resource texture (first page) and load the other pages, a font without the first page is not loaded
+		if( ParseBMPFontFile( pBMPFontResource->filename, &BMPFontsData[ i ], &pageFiles ) &&
+			LoadBMPFontPages( &BMPFontsData[ i ], pBMPFontResource->filename, pageFiles, ( pBMPFontResource->texture != NULL ? *pBMPFontResource->texture : NULL ) ) ) {
 			// if we have no problems with the file, store the id of the bitmap font
 			BMPFontsData[ i ].fontId = i;
-			// store the resource texture 
-			BMPFontsData[ i ].texture = *pBMPFontResource->texture;
 			// point to the nexe item
 			pBMPFontResource++;
-			// increment the total number of available bitmap fonts
-			totalBMPFonts += 1;
-		} 
+		} else {
+			// a previous font in the slot is removed, the slot can't be found by id
+			ReleaseBMPFontPages( &BMPFontsData[ i ] );
+			ClearBMPFontData( &BMPFontsData[ i ] );
+			result = false;
+		}
+		// update the total number of used slots (fonts are loaded again in the same slots)
+		if( i >= totalBMPFonts ) {
+			totalBMPFonts = i + 1;
+		}
 	}
-	return true;
+	return result;
 }
 
 BMPFontData_t*	FontManager::GetBMPFontData( int fontId )
@@ -305,3 +708,185 @@ BMPFontData_t*	FontManager::GetBMPFontData( int fontId )
 	}
 	return result;
 }
+
+const CharData_t* FontManager::GetBMPChar( const BMPFontData_t *fontData, unsigned int charID )
+{
+	int index = -1;
+	if( charID < BMPFONT_DIRECT_CHARS ) {
+		index = fontData->directChars[ charID ];
+	} else {
+		BMPCharIndex_t::const_iterator item = fontData->otherChars.find( charID );
+		if( item != fontData->otherChars.end() ) {
+			index = item->second;
+		}
+	}
+	return ( index >= 0 ? &fontData->charsData[ index ] : NULL );
+}
+
+short FontManager::GetBMPKerning( const BMPFontData_t *fontData, unsigned int firstCharID, unsigned int secondCharID )
+{
+	if( fontData->kerning.empty() ) {
+		return 0;
+	}
+	BMPKerning_t::const_iterator item = fontData->kerning.find( KerningKey( firstCharID, secondCharID ) );
+	return ( item != fontData->kerning.end() ? item->second : 0 );
+}
+
+SDL_Texture* FontManager::GetBMPPage( const BMPFontData_t *fontData, int page )
+{
+	if( ( page > 0 ) && ( page < fontData->totalPages ) && ( fontData->pages[ page ] != NULL ) ) {
+		return fontData->pages[ page ];
+	}
+	return fontData->texture;
+}
+
+#ifdef FONTMANAGER_BENCHMARK
+
+// ====================================== benchmark ======================================
+
+// characters and kerning cases of the benchmark font
+#define BENCHMARK_TOTAL_CHARS		200
+#define BENCHMARK_TOTAL_KERNING		100
+#define BENCHMARK_LOADS				200
+
+// write a block of a binary font
+static void BenchmarkWriteBlock( FILE *file, int type, const unsigned char *data, Uint32 size )
+{
+	unsigned char header[ 5 ] = { (unsigned char)type, (unsigned char)( size & 0xff ), (unsigned char)( ( size >> 8 ) & 0xff ), (unsigned char)( ( size >> 16 ) & 0xff ), 0 };
+	fwrite( header, 1, 5, file );
+	fwrite( data, 1, size, file );
+}
+
+// write the same font in text and binary format
+static bool BenchmarkWriteFont( const char *textFilename, const char *binaryFilename )
+{
+	// info: fontSize (2), bitField, charSet, stretchH (2), aa, padding (4), spacing (2), outline, name
+	static const unsigned char info[]	= { 32, 0, 0xc0, 0, 100, 0, 1, 1, 2, 3, 4, 1, 1, 0, 'B', 0 };
+	// common: lineHeight (2), base (2), scaleW (2), scaleH (2), pages (2), bitField, channels (4)
+	static const unsigned char common[]	= { 36, 0, 29, 0, 0, 2, 0, 2, 1, 0, 0, 0, 4, 4, 4 };
+	static const char pages[]			= "benchmark_0.png";
+	unsigned char chars[ BENCHMARK_TOTAL_CHARS * BMFONT_CHAR_SIZE ];
+	unsigned char kerning[ BENCHMARK_TOTAL_KERNING * BMFONT_KERNING_SIZE ];
+
+	FILE *text		= fopen( textFilename, "wb" );
+	FILE *binary	= fopen( binaryFilename, "wb" );
+	if( ( text == NULL ) || ( binary == NULL ) ) {
+		if( text != NULL ) {
+			fclose( text );
+		}
+		if( binary != NULL ) {
+			fclose( binary );
+		}
+		return false;
+	}
+	fprintf( text, "info face=\"Benchmark\" size=32 bold=0 italic=0 charset=\"\" unicode=1 stretchH=100 smooth=1 aa=1 padding=1,2,3,4 spacing=1,1 outline=0\n" );
+	fprintf( text, "common lineHeight=36 base=29 scaleW=512 scaleH=512 pages=1 packed=0 alphaChnl=0 redChnl=4 greenChnl=4 blueChnl=4\n" );
+	fprintf( text, "page id=0 file=\"%s\"\n", pages );
+	fprintf( text, "chars count=%d\n", BENCHMARK_TOTAL_CHARS );
+	// characters of ASCII, Latin-1 and Greek
+	memset( chars, 0, sizeof( chars ) );
+	for( int i = 0; i < BENCHMARK_TOTAL_CHARS; i++ ) {
+		unsigned int id = ( i < 95 ? 32 + i : ( i < 191 ? 160 + i - 95 : 0x391 + i - 191 ) );
+		int x = ( i % 16 ) * 32, y = ( i / 16 ) * 36, w = 10 + i % 20, h = 20 + i % 12;
+		int xoffset = i % 3 - 1, yoffset = i % 9, xadvance = 12 + i % 18;
+		fprintf( text, "char id=%-4u x=%-5d y=%-5d width=%-5d height=%-5d xoffset=%-5d yoffset=%-5d xadvance=%-5d page=0  chnl=15\n", id, x, y, w, h, xoffset, yoffset, xadvance );
+		unsigned char *c = chars + i * BMFONT_CHAR_SIZE;
+		c[ 0 ]	= id & 0xff;
+		c[ 1 ]	= ( id >> 8 ) & 0xff;
+		c[ 4 ]	= x & 0xff;
+		c[ 5 ]	= ( x >> 8 ) & 0xff;
+		c[ 6 ]	= y & 0xff;
+		c[ 7 ]	= ( y >> 8 ) & 0xff;
+		c[ 8 ]	= w;
+		c[ 10 ]	= h;
+		c[ 12 ]	= xoffset & 0xff;
+		c[ 13 ]	= ( xoffset >> 8 ) & 0xff;
+		c[ 14 ]	= yoffset;
+		c[ 16 ]	= xadvance;
+		c[ 19 ]	= 15;
+	}
+	// kerning between capital letters
+	fprintf( text, "kernings count=%d\n", BENCHMARK_TOTAL_KERNING );
+	memset( kerning, 0, sizeof( kerning ) );
+	for( int i = 0; i < BENCHMARK_TOTAL_KERNING; i++ ) {
+		int first = 'A' + i % 26, second = 'A' + i / 26, amount = -( i % 4 ) - 1;
+		fprintf( text, "kerning first=%-3d second=%-3d amount=%-4d\n", first, second, amount );
+		unsigned char *k = kerning + i * BMFONT_KERNING_SIZE;
+		k[ 0 ]	= first;
+		k[ 4 ]	= second;
+		k[ 8 ]	= amount & 0xff;
+		k[ 9 ]	= ( amount >> 8 ) & 0xff;
+	}
+	fwrite( "BMF\3", 1, 4, binary );
+	BenchmarkWriteBlock( binary, BMFONT_BLOCK_INFO, info, sizeof( info ) );
+	BenchmarkWriteBlock( binary, BMFONT_BLOCK_COMMON, common, sizeof( common ) );
+	BenchmarkWriteBlock( binary, BMFONT_BLOCK_PAGES, (const unsigned char *)pages, sizeof( pages ) );
+	BenchmarkWriteBlock( binary, BMFONT_BLOCK_CHARS, chars, sizeof( chars ) );
+	BenchmarkWriteBlock( binary, BMFONT_BLOCK_KERNING, kerning, sizeof( kerning ) );
+	fclose( text );
+	fclose( binary );
+	return true;
+}
+
+// returns true if two fonts have the same characters and kerning
+static bool BenchmarkCompare( const BMPFontData_t *a, const BMPFontData_t *b )
+{
+	if( ( a->totalChars != b->totalChars ) || ( a->totalKerningItems != b->totalKerningItems ) || ( a->lineHeight != b->lineHeight ) ||
+		( memcmp( &a->padding, &b->padding, sizeof( BMPFontPadding_t ) ) != 0 ) || ( a->kerning.size() != b->kerning.size() ) ) {
+		return false;
+	}
+	// unordered maps have no comparison operators
+	for( BMPKerning_t::const_iterator item = a->kerning.begin(); item != a->kerning.end(); ++item ) {
+		BMPKerning_t::const_iterator other = b->kerning.find( item->first );
+		if( ( other == b->kerning.end() ) || ( other->second != item->second ) ) {
+			return false;
+		}
+	}
+	for( int i = 0; i < a->totalChars; i++ ) {
+		const CharData_t *ca = &a->charsData[ i ];
+		const CharData_t *cb = &b->charsData[ i ];
+		if( ( ca->charID != cb->charID ) || ( ca->rect.x != cb->rect.x ) || ( ca->rect.y != cb->rect.y ) || ( ca->rect.w != cb->rect.w ) ||
+			( ca->rect.h != cb->rect.h ) || ( ca->xOffset != cb->xOffset ) || ( ca->yOffset != cb->yOffset ) || ( ca->xAdvance != cb->xAdvance ) ) {
+			return false;
+		}
+	}
+	return true;
+}
+
+void FontManager::BenchmarkBMPFontParsers( const char *workFilename )
+{
+	string			binaryFilename = string( workFilename ) + ".bin";
+	BMPFontData_t	legacyData, textData, binaryData;
+	vector<string>	pageFiles;
+	double			legacyTime = 0, textTime = 0, binaryTime = 0;
+	Uint64			start;
+
+	if( !BenchmarkWriteFont( workFilename, binaryFilename.c_str() ) ) {
+		printf( "FontManager::BenchmarkBMPFontParsers: unable to write %s\n", workFilename );
+		return;
+	}
+	ClearBMPFontData( &legacyData );
+	ClearBMPFontData( &textData );
+	ClearBMPFontData( &binaryData );
+	// loads are alternated so the three parsers find the file in the same state (cached by the system)
+	for( int i = 0; i < BENCHMARK_LOADS; i++ ) {
+		start = SDL_GetPerformanceCounter();
+		ParseBMPFontFileLegacy( workFilename, &legacyData );
+		legacyTime += (double)( SDL_GetPerformanceCounter() - start );
+		start = SDL_GetPerformanceCounter();
+		ParseBMPFontFile( workFilename, &textData, &pageFiles );
+		textTime += (double)( SDL_GetPerformanceCounter() - start );
+		start = SDL_GetPerformanceCounter();
+		ParseBMPFontFile( binaryFilename.c_str(), &binaryData, &pageFiles );
+		binaryTime += (double)( SDL_GetPerformanceCounter() - start );
+	}
+	double scale = 1000.0 / ( (double)SDL_GetPerformanceFrequency() * BENCHMARK_LOADS );
+	printf( "FontManager::BenchmarkBMPFontParsers: %d characters, %d kerning cases, %d loads\n", BENCHMARK_TOTAL_CHARS, BENCHMARK_TOTAL_KERNING, BENCHMARK_LOADS );
+	printf( "  line by line   %8.3f ms/load\n", legacyTime * scale );
+	printf( "  single pass    %8.3f ms/load (%5.1fx)  %s\n", textTime * scale, legacyTime / textTime, ( BenchmarkCompare( &legacyData, &textData ) ? "same result" : "DIFFERENT RESULT" ) );
+	printf( "  binary         %8.3f ms/load (%5.1fx)  %s\n", binaryTime * scale, legacyTime / binaryTime, ( BenchmarkCompare( &legacyData, &binaryData ) ? "same result" : "DIFFERENT RESULT" ) );
+	remove( workFilename );
+	remove( binaryFilename.c_str() );
+}
+
+#endif
@@ -10,6 +10,14 @@
 #include <iostream>
 #include <fstream>
 #include <string>
+#include <vector>
+#include <map>
+// std::tr1::unordered_map is declared by <unordered_map> in VS2008 SP1 and by <tr1/unordered_map> in gcc
+#ifdef _MSC_VER
+#include <unordered_map>
+#else
+#include <tr1/unordered_map>
+#endif
 
 #include <stdio.h>
 #include <SDL_ttf.h>
@@ -19,6 +27,8 @@ using namespace std;
 
 /*
 	structure that game must use for passing data to the engine,
+	files can be in text or binary format (BMFont version 3), the texture is the first page of the font: 
+	if it is NULL or the font has more pages they are loaded from the files indicated by the font,
 	here an example:	
 
 	BMPFontResource_t	BMPFontResources[ BMPFontId_Max ] = 
@@ -46,6 +56,7 @@ typedef struct {
 	short			xOffset;	// the X amount the image should be offset when drawing the image (in pixels)
 	short			yOffset;	// The Y amount the image should be offset when drawing the image (in pixels)
 	short			xAdvance;	// The amount to move the current position after drawing the character (in pixels)
+	short			page;		// texture (page) containing the character
 } CharData_t;
 
 // font kerning data
@@ -55,11 +66,20 @@ typedef struct {
 	short			amount;			// the X amount the image should be offset when drawing the image (in pixels)
 } KerningData_t;
 
-// maximum number of loadable characters for each bitmap font
-#define MAX_BMPFONT_CHARS					100
+// characters with a direct index (ASCII and Latin-1), the others are searched
+#define BMPFONT_DIRECT_CHARS				256
 
-// maximum number of loadable kerning data for each bitmap font
-#define MAX_KERNING_DATA					100
+// hash of the kerning keys, the default hash of VS2008 keeps the low 32 bits only (the second character)
+struct BMPKerningHash {
+	size_t operator()( Uint64 key ) const { return (size_t)( ( key >> 32 ) * 0x9E3779B1u ) ^ (size_t)key; }
+};
+
+// index in charsData by character and kerning amount by couple of characters (first << 32 | second)
+typedef std::tr1::unordered_map<unsigned int, int>				BMPCharIndex_t;
+typedef std::tr1::unordered_map<Uint64, short, BMPKerningHash>	BMPKerning_t;
+
+// maximum number of textures (pages) of a bitmap font
+#define BMPFONT_MAX_PAGES					16
 
 typedef struct {
 	int				top;
@@ -75,10 +95,15 @@ typedef struct {
 	int					lineHeight;
 	BMPFontPadding_t	padding;
 	long				totalChars;
-	CharData_t			charsData[ MAX_BMPFONT_CHARS ];
+	std::vector<CharData_t>			charsData;
+	int					directChars[ BMPFONT_DIRECT_CHARS ];	// index in charsData of characters 0...255, -1 if missing
+	BMPCharIndex_t		otherChars;								// index in charsData of the other characters
 	long				totalKerningItems;
-	KerningData_t		kerning[ MAX_KERNING_DATA ];
-	SDL_Texture			*texture;
+	BMPKerning_t		kerning;								// amount by couple of characters (first << 32 | second)
+	SDL_Texture			*texture;								// first page
+	int					totalPages;
+	SDL_Texture			*pages[ BMPFONT_MAX_PAGES ];
+	bool				loadedPages[ BMPFONT_MAX_PAGES ];		// true if the page has been loaded by FontManager
 } BMPFontData_t;
 
 
@@ -93,12 +118,29 @@ namespace FontManager {
 	// get font with properties (or create it if doesn't exists)
 	TTF_Font *GetTTFont( int fontId, int fontSize );
 
-	// load and parse bitmap font files
+	// load and parse bitmap font files (again in the same slots if called more times), returns false if a font
+	// can't be loaded (its file is invalid or the first page has no texture), its id is then not available
 	bool LoadBMPFontsFiles( long totalBMPFontsFiles, BMPFontResource_t *BMPFontResources );
 
+#ifdef FONTMANAGER_BENCHMARK
+	// measure the load time of a font with 200 characters using the line by line parser (used before the single
+	// pass loader), the single pass loader and the binary format, the result is printed (the font is written
+	// in workFilename and workFilename.bin, both deleted at the end); compiled only with FONTMANAGER_BENCHMARK
+	void BenchmarkBMPFontParsers( const char *workFilename );
+#endif
+
 	// return bitmap font data given the font unique identifier
 	BMPFontData_t*	GetBMPFontData( int fontId );
 
+	// return data of a character of a bitmap font, NULL if the font doesn't contain the character
+	const CharData_t* GetBMPChar( const BMPFontData_t *fontData, unsigned int charID );
+
+	// return the kerning between two characters of a bitmap font (0 if not defined)
+	short GetBMPKerning( const BMPFontData_t *fontData, unsigned int firstCharID, unsigned int secondCharID );
+
+	// return the texture of a page of a bitmap font (the first page if the page doesn't exist)
+	SDL_Texture* GetBMPPage( const BMPFontData_t *fontData, int page );
+
 	// free allocated resources
 	void Terminate();
 };
@@ -0,0 +1,194 @@
+/*
+ 	The information contained herein is confidential.
+ 	The use, copying, transfer or disclosure of such information is proibited
+ 	except by press written agreement with the author
+*/
+
+#include <stdio.h>
+#include "GlyphAtlas.h"
+#include "FontManager.h"
+#include "Engine.h"
+
+// created atlases
+static GlyphAtlas		*atlases[ GLYPHATLAS_MAX_ATLASES ];
+// total number of created atlases
+static int				totalAtlases = 0;
+
+GlyphAtlas* GlyphAtlas::Get( int fontId, int fontSize )
+{
+	for( int i = 0; i < totalAtlases; i++ ) {
+		if( ( atlases[ i ]->fontId == fontId ) && ( atlases[ i ]->fontSize == fontSize ) ) {
+			return atlases[ i ];
+		}
+	}
+	if( totalAtlases >= GLYPHATLAS_MAX_ATLASES ) {
+		printf( "GlyphAtlas: too many atlases\n" );
+		return NULL;
+	}
+	TTF_Font *font = FontManager::GetTTFont( fontId, fontSize );
+	if( font == NULL ) {
+		return NULL;
+	}
+	atlases[ totalAtlases ] = new GlyphAtlas( font, fontId, fontSize );
+	totalAtlases += 1;
+	return atlases[ totalAtlases - 1 ];
+}
+
+void GlyphAtlas::ReleaseAll()
+{
+	for( int i = 0; i < totalAtlases; i++ ) {
+		delete atlases[ i ];
+		atlases[ i ] = NULL;
+	}
+	totalAtlases = 0;
+}
+
+GlyphAtlas::GlyphAtlas( TTF_Font *font, int fontId, int fontSize )
+{
+	this->font		= font;
+	this->fontId	= fontId;
+	this->fontSize	= fontSize;
+	this->height	= TTF_FontHeight( font );
+	this->ascent	= TTF_FontAscent( font );
+	memset( latin, 0, sizeof( latin ) );
+	memset( pages, 0, sizeof( pages ) );
+	this->totalPages	= 0;
+	this->cursorX		= 0;
+	this->cursorY		= 0;
+	this->rowHeight		= 0;
+}
+
+GlyphAtlas::~GlyphAtlas()
+{
+	for( int i = 0; i < totalPages; i++ ) {
+		SDL_DestroyTexture( pages[ i ] );
+	}
+}
+
+void GlyphAtlas::Preload( const Uint16 *text, int length )
+{
+	for( int i = 0; i < length; i++ ) {
+		GetGlyph( text[ i ] );
+	}
+}
+
+int GlyphAtlas::Layout( const Uint16 *text, int length, std::vector<GlyphQuad_t> *quads )
+{
+	int x = 0;
+	quads->clear();
+	for( int i = 0; i < length; i++ ) {
+		Glyph_t *glyph = GetGlyph( text[ i ] );
+		if( glyph->page >= 0 ) {
+			GlyphQuad_t quad;
+			quad.texture			= pages[ glyph->page ];
+			quad.source				= glyph->rect;
+			quad.destination.x		= x + glyph->x;
+			quad.destination.y		= glyph->y;
+			quad.destination.w		= glyph->rect.w;
+			quad.destination.h		= glyph->rect.h;
+			quads->push_back( quad );
+		}
+		x += glyph->advance;
+	}
+	return x;
+}
+
+int GlyphAtlas::GetHeight()
+{
+	return height;
+}
+
+GlyphAtlas::Glyph_t* GlyphAtlas::GetGlyph( Uint16 character )
+{
+	Glyph_t *glyph;
+	if( character < 256 ) {
+		glyph = &latin[ character ];
+	} else {
+		std::map<Uint16, Glyph_t>::iterator item = others.find( character );
+		if( item != others.end() ) {
+			return &item->second;
+		}
+		Glyph_t empty;
+		memset( &empty, 0, sizeof( Glyph_t ) );
+		glyph = &others.insert( std::make_pair( character, empty ) ).first->second;
+	}
+	if( !glyph->loaded ) {
+		Rasterize( character, glyph );
+	}
+	return glyph;
+}
+
+void GlyphAtlas::Rasterize( Uint16 character, Glyph_t *glyph )
+{
+	int minX, maxX, minY, maxY, advance;
+
+	glyph->loaded	= true;
+	glyph->page		= -1;
+	if( TTF_GlyphMetrics( font, character, &minX, &maxX, &minY, &maxY, &advance ) != 0 ) {
+		return;
+	}
+	glyph->advance	= advance;
+	// glyphs without pixels only move the pen
+	if( ( maxX <= minX ) || ( maxY <= minY ) ) {
+		return;
+	}
+	// white glyph, the color of the label is applied when drawing
+	SDL_Color white = { 255, 255, 255, 255 };
+	SDL_Surface *surface = TTF_RenderGlyph_Blended( font, character, white );
+	if( surface == NULL ) {
+		return;
+	}
+	int page, x, y;
+	if( Allocate( surface->w, surface->h, &page, &x, &y ) ) {
+		glyph->page		= page;
+		glyph->rect.x	= x;
+		glyph->rect.y	= y;
+		glyph->rect.w	= surface->w;
+		glyph->rect.h	= surface->h;
+		// same placement of TTF_RenderText: the image starts at minX from the pen, maxY is the distance
+		// of the top of the image from the baseline
+		glyph->x		= minX;
+		glyph->y		= ascent - maxY;
+		SDL_UpdateTexture( pages[ page ], &glyph->rect, surface->pixels, surface->pitch );
+	} else {
+		printf( "GlyphAtlas: atlas of font %d size %d is full\n", fontId, fontSize );
+	}
+	SDL_FreeSurface( surface );
+}
+
+bool GlyphAtlas::Allocate( int w, int h, int *page, int *x, int *y )
+{
+	if( ( w + GLYPHATLAS_PADDING > GLYPHATLAS_PAGE_SIZE ) || ( h + GLYPHATLAS_PADDING > GLYPHATLAS_PAGE_SIZE ) ) {
+		return false;
+	}
+	// next row, then next page
+	if( ( totalPages > 0 ) && ( cursorX + w + GLYPHATLAS_PADDING > GLYPHATLAS_PAGE_SIZE ) ) {
+		cursorX		= 0;
+		cursorY		+= rowHeight;
+		rowHeight	= 0;
+	}
+	if( ( totalPages == 0 ) || ( cursorY + h + GLYPHATLAS_PADDING > GLYPHATLAS_PAGE_SIZE ) ) {
+		if( totalPages >= GLYPHATLAS_MAX_PAGES ) {
+			return false;
+		}
+		SDL_Texture *texture = SDL_CreateTexture( Engine::GetRenderer(), SDL_PIXELFORMAT_ARGB8888, SDL_TEXTUREACCESS_STATIC, GLYPHATLAS_PAGE_SIZE, GLYPHATLAS_PAGE_SIZE );
+		if( texture == NULL ) {
+			return false;
+		}
+		// pages start transparent
+		std::vector<Uint32> clear( GLYPHATLAS_PAGE_SIZE * GLYPHATLAS_PAGE_SIZE, 0 );
+		SDL_UpdateTexture( texture, NULL, &clear[ 0 ], GLYPHATLAS_PAGE_SIZE * sizeof( Uint32 ) );
+		SDL_SetTextureBlendMode( texture, SDL_BLENDMODE_BLEND );
+		pages[ totalPages ] = texture;
+		totalPages	+= 1;
+		cursorX		= 0;
+		cursorY		= 0;
+		rowHeight	= 0;
+	}
+	*page		= totalPages - 1;
+	*x			= cursorX + GLYPHATLAS_PADDING;
+	*y			= cursorY + GLYPHATLAS_PADDING;
+	cursorX		+= w + GLYPHATLAS_PADDING;
+	rowHeight	= ( h + GLYPHATLAS_PADDING > rowHeight ? h + GLYPHATLAS_PADDING : rowHeight );
+	return true;
+}
@@ -0,0 +1,98 @@
+/*
+ 	The information contained herein is confidential.
+ 	The use, copying, transfer or disclosure of such information is proibited
+ 	except by press written agreement with the author
+*/
+
+#ifndef _GLYPHATLAS_H_INCLUDE
+#define _GLYPHATLAS_H_INCLUDE
+
+#include <SDL.h>
+#include <SDL_ttf.h>
+#include <vector>
+#include <map>
+
+// size (pixels) of a texture page of an atlas
+#define GLYPHATLAS_PAGE_SIZE			512
+// maximum number of pages of an atlas
+#define GLYPHATLAS_MAX_PAGES			8
+// maximum number of atlases (one for each font and size)
+#define GLYPHATLAS_MAX_ATLASES			64
+// empty pixels around each glyph (avoid bleeding when glyphs are scaled)
+#define GLYPHATLAS_PADDING				1
+
+// a glyph to draw: portion of a page and position relative to the top left corner of the text
+typedef struct {
+	SDL_Texture		*texture;
+	SDL_Rect		source;
+	SDL_Rect		destination;
+} GlyphQuad_t;
+
+/*
+	GlyphAtlas contains the glyphs of a True Type font of a given size. Each glyph is rasterized (white, so any
+	color can be applied as modulation) the first time it is used and stored into a texture page shared by all
+	labels using the font, so changing a text only requires a new layout: no surface nor texture is created.
+*/
+class GlyphAtlas {
+
+public:
+
+	// returns the atlas of a font and size (created if doesn't exist), NULL if the font is not available
+	static GlyphAtlas*	Get( int fontId, int fontSize );
+
+	// destroy all atlases and their textures
+	static void			ReleaseAll();
+
+	// rasterize the glyphs of a text in advance
+	void				Preload( const Uint16 *text, int length );
+
+	// compute the glyphs to draw for a text (the vector is replaced), returns the width of the text
+	int					Layout( const Uint16 *text, int length, std::vector<GlyphQuad_t> *quads );
+
+	// returns the height of a line of text
+	int					GetHeight();
+
+private:
+
+	// glyph stored in a page
+	typedef struct {
+		bool			loaded;			// true if the glyph has been rasterized (or is not provided by the font)
+		int				page;			// index of the page, -1 for glyphs without pixels (e.g. space)
+		SDL_Rect		rect;			// portion of the page
+		int				x;				// offset of the image from the pen position
+		int				y;				// offset of the image from the top of the line
+		int				advance;		// horizontal advance of the pen
+	} Glyph_t;
+
+	TTF_Font			*font;
+	int					fontId;
+	int					fontSize;
+	int					height;
+	int					ascent;
+
+	// glyphs of the Latin-1 range are indexed directly, the others are searched
+	Glyph_t				latin[ 256 ];
+	std::map<Uint16, Glyph_t>	others;
+
+	// pages and position of the next glyph (glyphs are stored in rows, from top to bottom)
+	SDL_Texture			*pages[ GLYPHATLAS_MAX_PAGES ];
+	int					totalPages;
+	int					cursorX;
+	int					cursorY;
+	int					rowHeight;
+
+	// constructor and destructor (atlases are created by Get and destroyed by ReleaseAll)
+	GlyphAtlas( TTF_Font *font, int fontId, int fontSize );
+	~GlyphAtlas();
+
+	// returns a glyph, rasterized if needed
+	Glyph_t*			GetGlyph( Uint16 character );
+
+	// rasterize a glyph into a page
+	void				Rasterize( Uint16 character, Glyph_t *glyph );
+
+	// find space for a rect in the pages (a new page is created if needed), returns false if the atlas is full
+	bool				Allocate( int w, int h, int *page, int *x, int *y );
+};
+
+#endif
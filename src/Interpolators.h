@@ -0,0 +1,187 @@
+/*
+ 	The information contained herein is confidential.
+ 	The use, copying, transfer or disclosure of such information is proibited
+ 	except by press written agreement with the author
+*/
+
+#ifndef _INTERPOLATORS_H_INCLUDE
+#define _INTERPOLATORS_H_INCLUDE
+
+#include <math.h>
+
+#ifndef M_PI
+#define M_PI		3.14159265358979323846
+#endif
+
+#ifndef M_PI_2
+#define M_PI_2		1.57079632679489661923
+#endif
+
+#ifndef M_PI_X_2
+#define M_PI_X_2 (float)M_PI * 2.0f
+#endif
+
+/*
+	Interpolators (easing functions) used by interval actions: each one maps the percentage of
+	the action (0.0 to 1.0) into the interpolated percentage.
+	They are inline so templated actions (see TweenTo in Actions.h) can expand them in place.
+*/
+
+// Linear
+inline float InterpolatorLinear( float percentage )
+{
+	return percentage;
+}
+
+// Sine Ease
+inline float InterpolatorSineEaseIn(float time)
+{
+    return -1 * cosf(time * (float)M_PI_2) + 1;
+}
+
+inline float InterpolatorSineEaseOut(float time)
+{
+    return sinf(time * (float)M_PI_2);
+}
+
+inline float InterpolatorSineEaseInOut(float time)
+{
+    return -0.5f * (cosf((float)M_PI * time) - 1);
+}
+
+// Expo Ease
+inline float InterpolatorExpoEaseIn(float time)
+{
+    return time == 0 ? 0 : powf(2, 10 * (time/1 - 1)) - 1 * 0.001f;
+}
+
+inline float InterpolatorExpoEaseOut(float time)
+{
+    return time == 1 ? 1 : (-powf(2, -10 * time / 1) + 1);
+}
+
+inline float InterpolatorExpoEaseInOut(float time)
+{
+    if(time == 0 || time == 1)
+        return time;
+
+    if (time < 0.5f)
+        return 0.5f * powf(2, 10 * (time * 2 - 1));
+
+    return 0.5f * (-powf(2, -10 * (time * 2 - 1)) + 2);
+}
+
+// Bounce Ease
+inline float InterpolatorBounceTime(float time)
+{
+    if (time < 1 / 2.75f)
+    {
+        return 7.5625f * time * time;
+    }
+    else if (time < 2 / 2.75f)
+    {
+        time -= 1.5f / 2.75f;
+        return 7.5625f * time * time + 0.75f;
+    }
+    else if(time < 2.5f / 2.75f)
+    {
+        time -= 2.25f / 2.75f;
+        return 7.5625f * time * time + 0.9375f;
+    }
+
+    time -= 2.625f / 2.75f;
+    return 7.5625f * time * time + 0.984375f;
+}
+
+inline float InterpolatorBounceEaseIn(float time)
+{
+    return 1 - InterpolatorBounceTime(1 - time);
+}
+
+inline float InterpolatorBounceEaseOut(float time)
+{
+    return InterpolatorBounceTime(time);
+}
+
+inline float InterpolatorBounceEaseInOut(float time)
+{
+    float newT = 0;
+    if (time < 0.5f)
+    {
+        time = time * 2;
+        newT = (1 - InterpolatorBounceTime(1 - time)) * 0.5f;
+    }
+    else
+    {
+        newT = InterpolatorBounceTime(time * 2 - 1) * 0.5f + 0.5f;
+    }
+
+    return newT;
+}
+
+// Elastic Ease (0.9 ~ 0.1)
+#define INTERPOLATOR_ELASTIC_PERIOD		0.3f
+
+inline float InterpolatorElasticEaseIn(float time)
+{
+    const float period = INTERPOLATOR_ELASTIC_PERIOD;
+    float newT = 0;
+    if (time == 0 || time == 1)
+    {
+        newT = time;
+    }
+    else
+    {
+        float s = period / 4;
+        time = time - 1;
+        newT = -powf(2, 10 * time) * sinf((time - s) * M_PI_X_2 / period);
+    }
+
+    return newT;
+}
+
+inline float InterpolatorElasticEaseOut(float time)
+{
+    const float period = INTERPOLATOR_ELASTIC_PERIOD;
+    float newT = 0;
+    if (time == 0 || time == 1)
+    {
+        newT = time;
+    }
+    else
+    {
+        float s = period / 4;
+        newT = powf(2, -10 * time) * sinf((time - s) * M_PI_X_2 / period) + 1;
+    }
+
+    return newT;
+}
+
+inline float InterpolatorElasticEaseInOut(float time)
+{
+    const float period = INTERPOLATOR_ELASTIC_PERIOD;
+    float newT = 0;
+    if (time == 0 || time == 1)
+    {
+        newT = time;
+    }
+    else
+    {
+        time = time * 2;
+
+        float s = period / 4;
+
+        time = time - 1;
+        if (time < 0)
+        {
+            newT = -0.5f * powf(2, 10 * time) * sinf((time -s) * M_PI_X_2 / period);
+        }
+        else
+        {
+            newT = powf(2, -10 * time) * sinf((time - s) * M_PI_X_2 / period) * 0.5f + 1;
+        }
+    }
+    return newT;
+}
+
+#endif
@@ -4,11 +4,54 @@
  	except by press written agreement with the author
 */
 
+#include <algorithm>
 #include <SDL.h>
 #include "Labels.h"
 #include "Engine.h"
 #include "FontManager.h"
 #include "Misc.h"
+#include "TextCache.h"
+#include "TextBatch.h"
+
+// render mode of the labels created from now on
+static LabelRenderMode_t	defaultRenderMode = LABEL_RENDER_TEXTURE;
+
+// add the glyphs of a text to the batch: the text is scaled and rotated around its center like a single texture
+static void AddGlyphsToBatch( const std::vector<GlyphQuad_t> &quads, int x, int y, int width, int height, float size, float angle, SDL_RendererFlip flip, SDL_Color color )
+{
+	SDL_Rect	dstrect;
+	SDL_Point	center;
+	float		center_x = x + width / 2.0f;
+	float		center_y = y + height / 2.0f;
+
+	for( size_t i = 0; i < quads.size(); i++ ) {
+		const GlyphQuad_t *quad = &quads[ i ];
+		// position of the glyph inside the text, mirrored if the text is flipped
+		int glyph_x = quad->destination.x;
+		int glyph_y = quad->destination.y;
+		if( flip & SDL_FLIP_HORIZONTAL ) {
+			glyph_x = width - glyph_x - quad->destination.w;
+		}
+		if( flip & SDL_FLIP_VERTICAL ) {
+			glyph_y = height - glyph_y - quad->destination.h;
+		}
+		dstrect.x	= (int)( center_x + ( glyph_x - width / 2.0f ) * size );
+		dstrect.y	= (int)( center_y + ( glyph_y - height / 2.0f ) * size );
+		dstrect.w	= (int)( quad->destination.w * size );
+		dstrect.h	= (int)( quad->destination.h * size );
+		center.x	= (int)( center_x - dstrect.x );
+		center.y	= (int)( center_y - dstrect.y );
+		TextBatch::Add( quad->texture, &quad->source, &dstrect, angle, &center, flip, color );
+	}
+}
+
+// labels waiting for a new texture (or layout), a label is updated once before it is drawn even if changed many times
+static std::vector<Label*>	pendingLabels;
+// maximum time (milliseconds) spent updating labels in a frame (0 = no limit)
+static float				updateBudget = 0;
+
+// characters used by numeric labels: digits, separators, sign and currency symbol
+static const Uint16			numericCharacters[] = { '0', '1', '2', '3', '4', '5', '6', '7', '8', '9', '.', ',', '-', ' ', 0x20ac };
 
 Label::Label( int fontId, int fontSize, Uint32 color, unsigned int tag, unsigned int zOrder )
 {
@@ -23,40 +66,186 @@ Label::Label( int fontId, int fontSize, Uint32 color, unsigned int tag, unsigned
 	this->texture	= NULL;
 	this->alignment	= ALIGNMENT_CENTER;
 	this->alignment_x_offset	= 0;
+	this->renderMode	= defaultRenderMode;
+	this->batched	= ( defaultRenderMode == LABEL_RENDER_GLYPHS );
+	this->atlas		= NULL;
+	this->numeric	= false;
+	this->numericRenderMode	= defaultRenderMode;
+	this->encoding	= TEXTCACHE_ENCODING_LATIN1;
+	this->dirty		= false;
+}
+
+Label::~Label()
+{
+	// a deleted label can't be updated
+	pendingLabels.erase( std::remove( pendingLabels.begin(), pendingLabels.end(), this ), pendingLabels.end() );
+	// the texture can be evicted from the cache (or used by other labels)
+	if( texture != NULL ) {
+		TextCache::Release( texture );
+	}
+}
+
+void Label::Invalidate()
+{
+	if( !dirty ) {
+		dirty = true;
+		pendingLabels.push_back( this );
+	}
+}
+
+void Label::Refresh()
+{
+	// the label stays in the queue but it is skipped because it's not dirty anymore
+	if( dirty ) {
+		dirty = false;
+		UpdateTexture();
+	}
+}
+
+void Label::UpdatePendingLabels()
+{
+	Uint64	start	= SDL_GetPerformanceCounter();
+	Uint64	limit	= (Uint64)( updateBudget * SDL_GetPerformanceFrequency() / 1000.0f );
+	size_t	updated	= 0;
+	// a budget shorter than a tick of the counter is still a limit (0 = no limit)
+	if( ( updateBudget > 0 ) && ( limit == 0 ) ) {
+		limit = 1;
+	}
+
+	while( updated < pendingLabels.size() ) {
+		Label *label = pendingLabels[ updated ];
+		updated += 1;
+		if( label->dirty ) {
+			label->dirty = false;
+			label->UpdateTexture();
+			// the other labels are updated in the next frames
+			if( ( limit > 0 ) && ( SDL_GetPerformanceCounter() - start >= limit ) ) {
+				break;
+			}
+		}
+	}
+	pendingLabels.erase( pendingLabels.begin(), pendingLabels.begin() + updated );
+}
+
+void Label::SetUpdateBudget( float milliseconds )
+{
+	updateBudget = milliseconds;
 }
 
 void Label::UpdateTexture()
 {
-	SDL_Surface	*textsurface = 0;
-	int	w = 0, h = 0;
+	SDL_Surface		*textsurface = 0;
+	SDL_Texture		*result = NULL;
+	TextCacheKey_t	key;
+	// with glyphs we only need a new layout
+	if( renderMode == LABEL_RENDER_GLYPHS ) {
+		UpdateLayout();
+		UpdateAlignmentOffset();
+		return;
+	}
 	// if we have a valid font...
 	if( this->font ) {
-		// create an SDL_Surface with text (GetTextSurface id overridden)
-		textsurface = GetTextSurface();
-		// if an SDL_Surface has been successfully created...
-		if( textsurface ) {
-			w = textsurface->w;
-			h = textsurface->h;
-			if( texture != NULL ) {
-				SDL_DestroyTexture( texture );
+		// labels with the same text, font and color share the texture
+		key.fontId		= this->fontId;
+		key.fontSize	= this->fontSize;
+		key.color		= this->color;
+		key.encoding	= this->encoding;
+		key.length		= GetCodepoints( key.text );
+		result = TextCache::Acquire( &key );
+		if( result == NULL ) {
+			// create an SDL_Surface with text (GetTextSurface id overridden)
+			textsurface = GetTextSurface();
+			// if an SDL_Surface has been successfully created...
+			if( textsurface ) {
+				// create a new texture from the surface
+				result = TextCache::Insert( &key, textsurface );
+				if( result == NULL ) {
+					printf( "Null texture!\n" );
+				}
+				// destroy surface 
+				SDL_FreeSurface( textsurface );
+			} else {
+				printf( "Null text surface!\n" );
 			}
-			// create a new texture from the surface
-			texture = SDL_CreateTextureFromSurface( Engine::GetRenderer(), textsurface );
+		}
+		if( result != NULL ) {
+			// the previous texture can be used by other labels
 			if( texture != NULL ) {
-				SDL_QueryTexture( texture, NULL, NULL, &this->width, &this->height );
-			} else {
-				printf( "Null texture!\n" );
+				TextCache::Release( texture );
 			}
-			// destroy surface 
-			SDL_FreeSurface( textsurface );
-		} else {
-			printf( "Null text surface!\n" );
+			texture = result;
+			SDL_QueryTexture( texture, NULL, NULL, &this->width, &this->height );
 		}
 	}
 	// we must update alignment offset because width could change
 	UpdateAlignmentOffset();
 }
 
+void Label::UpdateLayout()
+{
+	Uint16	codepoints[ LABELS_TEXT_MAX_LENGTH ];
+
+	// texture is not used anymore
+	if( texture != NULL ) {
+		TextCache::Release( texture );
+		texture = NULL;
+	}
+	if( atlas == NULL ) {
+		atlas = GlyphAtlas::Get( fontId, fontSize );
+		// numeric labels never rasterize while counting
+		if( ( atlas != NULL ) && numeric ) {
+			atlas->Preload( numericCharacters, sizeof( numericCharacters ) / sizeof( Uint16 ) );
+		}
+	}
+	if( atlas == NULL ) {
+		quads.clear();
+		this->width		= 0;
+		this->height	= 0;
+		return;
+	}
+	int length		= GetCodepoints( codepoints );
+	this->width		= atlas->Layout( codepoints, length, &quads );
+	this->height	= atlas->GetHeight();
+}
+
+void Label::SetRenderMode( LabelRenderMode_t mode )
+{
+	if( this->renderMode != mode ) {
+		this->renderMode = mode;
+		this->batched	= ( mode == LABEL_RENDER_GLYPHS );
+		quads.clear();
+		Invalidate();
+	}
+}
+
+void Label::SetNumeric( bool state )
+{
+	if( state == numeric ) {
+		return;
+	}
+	if( state ) {
+		this->numericRenderMode	= renderMode;
+		this->renderMode		= LABEL_RENDER_GLYPHS;
+	} else {
+		this->renderMode		= numericRenderMode;
+	}
+	this->numeric		= state;
+	this->batched		= ( renderMode == LABEL_RENDER_GLYPHS );
+	quads.clear();
+	// the atlas is searched again to render the characters of numbers
+	this->atlas			= NULL;
+	if( state ) {
+		// the layout is replaced without allocations
+		quads.reserve( LABELS_TEXT_MAX_LENGTH );
+	}
+	Invalidate();
+}
+
+void Label::SetDefaultRenderMode( LabelRenderMode_t mode )
+{
+	defaultRenderMode = mode;
+}
+
 void Label::UpdateAlignmentOffset()
 {
 	switch( alignment ) {
@@ -75,8 +264,10 @@ void Label::UpdateAlignmentOffset()
 void Label::SetColor( Uint32 color )
 {
 	this->color = color;
-	// we must update alignment offset because color has changed
-	UpdateTexture();
+	// we must update texture because color has changed (glyphs are colored when drawn)
+	if( renderMode == LABEL_RENDER_TEXTURE ) {
+		Invalidate();
+	}
 }
 
 void Label::SetAlignment( LabelAlignment_t alignment )
@@ -90,16 +281,18 @@ void Label::SetFont( int fontId )
 {
 	this->fontId	= fontId;
 	this->font		= FontManager::GetTTFont( fontId, fontSize );
+	this->atlas		= NULL;
 	// we must update texture because font has changed
-	UpdateTexture();
+	Invalidate();
 }
 
 void Label::SetFontSize( int fontSize )
 {
 	this->fontSize	= fontSize;
 	this->font		= FontManager::GetTTFont( fontId, fontSize );
+	this->atlas		= NULL;
 	// we must update texture because font size has changed
-	UpdateTexture();
+	Invalidate();
 }
 
 SDL_Surface* Label::GetTextSurface() 
@@ -110,9 +303,17 @@ SDL_Surface* Label::GetTextSurface()
 	return NULL;
 }
 
+int Label::GetCodepoints( Uint16 * )
+{
+	// this function must be overriden like GetTextSurface
+	return 0;
+}
+
 void Label::Draw()
 {
-	if( texture != NULL ) {
+	if( renderMode == LABEL_RENDER_GLYPHS ) {
+		DrawGlyphs();
+	} else if( texture != NULL ) {
 		Coord_t		world_position;
 		SDL_Rect	srcrect;
 		SDL_Rect	dstrect;
@@ -145,6 +346,13 @@ void Label::Draw()
 	}
 }
 
+void Label::DrawGlyphs()
+{
+	Coord_t		world_position = GetWorldPosition();
+	SDL_Color	textcolor = { (Uint8)RGBA_R( color ), (Uint8)RGBA_G( color ), (Uint8)RGBA_B( color ), (Uint8)( ( alpha * RGBA_A( color ) ) / 255 ) };
+	AddGlyphsToBatch( quads, (int)world_position.x + alignment_x_offset, (int)world_position.y, width, height, size, angle, flip, textcolor );
+}
+
 
 
 
@@ -163,18 +371,33 @@ void LabelValue::SetValue( const long value )
 	UpdateText( this->value );
 }
 
+void LabelValue::SetNumericMode( bool state )
+{
+	SetNumeric( state );
+}
+
 void LabelValue::UpdateText( long value )
 {
 	sprintf( this->text, "%d", value );
-	UpdateTexture();
+	Invalidate();
 }
 
 SDL_Surface* LabelValue::GetTextSurface()
 {
-	SDL_Color textcolor = { RGBA_R( color ), RGBA_G( color ), RGBA_B( color ), RGBA_A( color ) };
+	SDL_Color textcolor = { (Uint8)RGBA_R( color ), (Uint8)RGBA_G( color ), (Uint8)RGBA_B( color ), (Uint8)RGBA_A( color ) };
 	return TTF_RenderText_Blended( this->font, this->text, textcolor );
 }
 
+int LabelValue::GetCodepoints( Uint16 *codepoints )
+{
+	// TTF_RenderText uses Latin-1 characters
+	int length = strlen( this->text );
+	for( int i = 0; i < length; i++ ) {
+		codepoints[ i ] = (unsigned char)this->text[ i ];
+	}
+	return length;
+}
+
 
 
 
@@ -188,15 +411,25 @@ LabelUTF8::LabelUTF8( const char *text, int fontId, int fontSize, Uint32 color,
 
 SDL_Surface* LabelUTF8::GetTextSurface()
 {
-	SDL_Color textcolor = { RGBA_R( color ), RGBA_G( color ), RGBA_B( color ), RGBA_A( color ) };
+	SDL_Color textcolor = { (Uint8)RGBA_R( color ), (Uint8)RGBA_G( color ), (Uint8)RGBA_B( color ), (Uint8)RGBA_A( color ) };
 	return TTF_RenderText_Blended( this->font, this->text, textcolor );
 }
 
+int LabelUTF8::GetCodepoints( Uint16 *codepoints )
+{
+	// TTF_RenderText uses Latin-1 characters
+	int length = strlen( this->text );
+	for( int i = 0; i < length; i++ ) {
+		codepoints[ i ] = (unsigned char)this->text[ i ];
+	}
+	return length;
+}
+
 void LabelUTF8::SetText( const char *text )
 {
 	if( text != NULL ) {
 		sprintf( this->text, "%s", text );
-		UpdateTexture();
+		Invalidate();
 	} 	
 }
 
@@ -209,20 +442,30 @@ LabelUTF16::LabelUTF16( const wchar_t *text, int fontId, int fontSize, Uint32 co
 {
 	// here Label constructor initialize all common data, after that
 	// we can set our UTF8 text
+	this->encoding = TEXTCACHE_ENCODING_UTF16;
 	SetText( text );
 }
 
 SDL_Surface* LabelUTF16::GetTextSurface()
 {
-	SDL_Color textcolor = { RGBA_R( color ), RGBA_G( color ), RGBA_B( color ), RGBA_A( color ) };
+	SDL_Color textcolor = { (Uint8)RGBA_R( color ), (Uint8)RGBA_G( color ), (Uint8)RGBA_B( color ), (Uint8)RGBA_A( color ) };
 	return TTF_RenderUNICODE_Blended( this->font, (Uint16*)this->text, textcolor );
 }
 
+int LabelUTF16::GetCodepoints( Uint16 *codepoints )
+{
+	int length = wcslen( this->text );
+	for( int i = 0; i < length; i++ ) {
+		codepoints[ i ] = (Uint16)this->text[ i ];
+	}
+	return length;
+}
+
 void LabelUTF16::SetText( const wchar_t *text )
 {
 	if( text != NULL ) {
 		wsprintf( this->text, L"%s", text ); 
-		UpdateTexture();
+		Invalidate();
 	} 	
 }
 
@@ -233,6 +476,7 @@ LabelCurrency::LabelCurrency( long value, int fontId, int fontSize, Uint32 color
 {
 	// here Label constructor initialize all common data, after that
 	// we can set our UTF16 text containing currency formatted string
+	this->encoding = TEXTCACHE_ENCODING_UTF16;
 	
 	// by default the string is complete: with euro symbol and decimals
 	this->euro_symbol	= true;
@@ -259,181 +503,143 @@ void LabelCurrency::SetDecimals( bool state )
 	UpdateText( this->value );
 }
 
+void LabelCurrency::SetNumericMode( bool state )
+{
+	SetNumeric( state );
+}
+
 void LabelCurrency::UpdateText( long value )
 {
 	Misc::CurrencyValueToUTF16String( value, this->text, this->decimals, this->euro_symbol );
-	UpdateTexture();
+	Invalidate();
 }
 
 SDL_Surface* LabelCurrency::GetTextSurface()
 {
-	SDL_Color textcolor = { RGBA_R( color ), RGBA_G( color ), RGBA_B( color ), RGBA_A( color ) };
+	SDL_Color textcolor = { (Uint8)RGBA_R( color ), (Uint8)RGBA_G( color ), (Uint8)RGBA_B( color ), (Uint8)RGBA_A( color ) };
 	return TTF_RenderUNICODE_Blended( this->font, (Uint16*)this->text, textcolor );
 }
 
+int LabelCurrency::GetCodepoints( Uint16 *codepoints )
+{
+	int length = wcslen( this->text );
+	for( int i = 0; i < length; i++ ) {
+		codepoints[ i ] = (Uint16)this->text[ i ];
+	}
+	return length;
+}
+
 
 BMPLabelText::BMPLabelText( int fontId, unsigned int tag, unsigned int zOrder )
 {
 	this->fontId = fontId;
 	this->zOrder = zOrder;
 	memset( this->text, 0, sizeof( text ) );
-	this->texture = NULL;
 	this->alignment	= ALIGNMENT_CENTER;
 	this->alignment_x_offset	= 0;
+	this->batched	= true;
+	this->texture	= NULL;
 }
 
-void BMPLabelText::UpdateTexture()
+BMPLabelText::~BMPLabelText()
+{
+	if( texture != NULL ) {
+		SDL_DestroyTexture( texture );
+	}
+}
+
+void BMPLabelText::UpdateLayout()
 {
-	SDL_Renderer	*renderer;
 	BMPFontData_t	*fontData;
-	long			texture_w;
-	long			texture_h;
-	SDL_Rect		srcrect;
-	SDL_Rect		dstrect;
+	GlyphQuad_t		quad;
 	int				xPos		= 0;
 	int				kerning		= 0;
 	int				textLength	= 0;
-	int				textWidth	= 0;
 
-	// if a previous texture has been allocated...
-	if( texture != NULL ) {
-		// destroy it!
-		SDL_DestroyTexture( texture );
-	}
+	quads.clear();
+	width	= 0;
+	height	= 0;
 
 	// get bitmap font data
 	fontData = FontManager::GetBMPFontData( fontId );
 	if( !fontData ) {
+		UpdateTexture();
 		return;
 	}
-	// get renderer pointer
-	renderer = Engine::GetRenderer();
-	
 	// get total number of characters according to current text
 	textLength = wcslen( text );
-
-	// calculate total width of texture doing same calculations of drawing iteration
-	xPos = 0;
+	// scan all characters of the text 
 	for( int j = 0; j < textLength; j++ ) {
-		for( int i = 0; i < fontData->totalChars; i++ ) {
-			if( fontData->charsData[ i ].charID == text[ j ] ) {
-				// kerning is calculate previously for current character, update current char position
-				xPos += kerning;
-				// update current horizontal print position accordint to xAdvance value of character
-				xPos += fontData->charsData[ i ].xAdvance;
-				// calculate kerning of following character
-				kerning	= 0;
-				// if we have a further character to draw...
-				if( ( j + 1 ) < textLength ) {
-					// we must search in kerning data if there is a corresponding couple with current and next character
-					for( int k = 0; k < fontData->totalKerningItems; k++ ) {
-						// if we found any...
-						if( ( text[ j ] == fontData->kerning[ k ].firstCharID ) && ( text[ j + 1 ] == fontData->kerning[ k ].secondCharID ) ) {
-							// set the offset value for next character
-							kerning = fontData->kerning[ k ].amount;
-							break;
-						}
-					}
-				}
-				break;
-			}
+		// search if a character match with any in font data
+		const CharData_t *charData = FontManager::GetBMPChar( fontData, text[ j ] );
+		if( charData == NULL ) {
+			continue;
+		}
+		// kerning is calculate previously for current character, update current char position
+		xPos += kerning;
+
+		// coordinate of character inside bitmap font texture and where to draw it
+		quad.texture			= FontManager::GetBMPPage( fontData, charData->page );
+		quad.source				= charData->rect;
+		quad.destination.x		= xPos;
+		quad.destination.y		= charData->yOffset;
+		quad.destination.w		= charData->rect.w;
+		quad.destination.h		= charData->rect.h;
+		if( ( quad.source.w > 0 ) && ( quad.source.h > 0 ) ) {
+			quads.push_back( quad );
+		}
+
+		// update current horizontal print position accordint to xAdvance value of character
+		xPos += charData->xAdvance;
+
+		// calculate kerning of following character (if we have a further character to draw)
+		kerning	= 0;
+		if( ( j + 1 ) < textLength ) {
+			kerning = FontManager::GetBMPKerning( fontData, text[ j ], text[ j + 1 ] );
 		}
 	}
-	// xPos contains the total width of texture
-	texture_w = xPos;
-	texture_h = fontData->lineHeight;
+	// set super class width and height for printing
+	width	= xPos;
+	height	= fontData->lineHeight;
+	UpdateTexture();
+}
 
-	// create a new texture 
-	texture = SDL_CreateTexture( renderer, SDL_PIXELFORMAT_ARGB8888, SDL_TEXTUREACCESS_TARGET, texture_w, texture_h );
+void BMPLabelText::UpdateTexture()
+{
+#ifndef TEXTBATCH_USE_RENDER_GEOMETRY
+	// without SDL_RenderGeometry each batched character is a draw call, so the text is rendered once and the label
+	// is drawn with a single call; if the texture can't be created the characters are batched anyway
+	SDL_Renderer *renderer = Engine::GetRenderer();
+	if( texture != NULL ) {
+		SDL_DestroyTexture( texture );
+		texture = NULL;
+	}
+	if( ( width > 0 ) && ( height > 0 ) ) {
+		texture = SDL_CreateTexture( renderer, SDL_PIXELFORMAT_ARGB8888, SDL_TEXTUREACCESS_TARGET, width, height );
+	}
 	if( texture != NULL ) {
-
-		// these settings is for alpha
 		SDL_SetTextureBlendMode( texture, SDL_BLENDMODE_BLEND );
-		SDL_SetRenderDrawBlendMode( renderer, SDL_BLENDMODE_BLEND );
-		// we must convert the render target from screen to texture
 		SDL_SetRenderTarget( renderer, texture );
-		// fill the texture with trasnparency
 		SDL_SetRenderDrawColor( renderer, 0x00, 0x00, 0x00, 0x00 );
-        SDL_RenderClear( renderer );
-		
-		SDL_SetTextureAlphaMod( fontData->texture, alpha );
-
-		// reset current x position
-		xPos = 0;
-		// scan all characters of the text 
-		for( int j = 0; j < textLength; j++ ) {
-			// search if a character match with any in font data
-			for( int i = 0; i < fontData->totalChars; i++ ) {
-				// if we find a corresponding character...
-				if( fontData->charsData[ i ].charID == text[ j ] ) {
-					
-					// debug
-#if 0
-					printf( "Char %c %3d width %3d xadvance %3d kerning %3d xPos %d\n", 
-						text[ j ], 
-						text[ j ],
-						fontData->charsData[ i ].rect.w, 
-						fontData->charsData[ i ].xAdvance, 
-						kerning,
-						xPos );
-#endif
-
-					// set coordinate of character inside bitmap font texture
-					srcrect.x = fontData->charsData[ i ].rect.x;
-					srcrect.y = fontData->charsData[ i ].rect.y;
-					srcrect.w = fontData->charsData[ i ].rect.w;
-					srcrect.h = fontData->charsData[ i ].rect.h;
-
-					// kerning is calculate previously for current character, update current char position
-					xPos += kerning;
-
-					// set where to draw current char inside the texture
-					dstrect.x = xPos;
-					dstrect.y = fontData->charsData[ i ].yOffset;
-					dstrect.w = fontData->charsData[ i ].rect.w;
-					dstrect.h = fontData->charsData[ i ].rect.h;
-
-					// update current horizontal print position accordint to xAdvance value of character
-					xPos += fontData->charsData[ i ].xAdvance;
-
-					// calculate kerning of following character
-					kerning	= 0;
-					// if we have a further character to draw...
-					if( ( j + 1 ) < textLength ) {
-						// we must search in kerning data if there is a corresponding couple with current and next character
-						for( int k = 0; k < fontData->totalKerningItems; k++ ) {
-							// if we found any...
-							if( ( text[ j ] == fontData->kerning[ k ].firstCharID ) && ( text[ j + 1 ] == fontData->kerning[ k ].secondCharID ) ) {
-								// set the offset value for next character
-								kerning = fontData->kerning[ k ].amount;
-								break;
-							}
-						}
-					}
-
-					// copy character into the texture
-					SDL_RenderCopyEx( renderer, fontData->texture, &srcrect, &dstrect, angle, NULL, flip );
-
-					// go ahead with next char inside text
-					break;
-				}
-			}
+		SDL_RenderClear( renderer );
+		for( size_t i = 0; i < quads.size(); i++ ) {
+			// pages may have been modulated by TextBatch
+			SDL_SetTextureColorMod( quads[ i ].texture, 255, 255, 255 );
+			SDL_SetTextureAlphaMod( quads[ i ].texture, 255 );
+			SDL_RenderCopy( renderer, quads[ i ].texture, &quads[ i ].source, &quads[ i ].destination );
 		}
-		// reset target of renderer (the screen)
 		SDL_SetRenderTarget( renderer, NULL );
 	}
-
-	// set super class width and height for printing
-	width	= texture_w;
-	height	= texture_h;
+	this->batched = ( texture == NULL );
+#endif
 }
 
 void BMPLabelText::SetText( const wchar_t *text )
 {
 	// store current text
 	wsprintf( this->text, L"%s", text );
-	// update texture
-	UpdateTexture();
+	// update layout
+	UpdateLayout();
 	// we must update offset
 	UpdateAlignmentOffset();
 }
@@ -442,8 +648,8 @@ void BMPLabelText::SetBitmapFontId( int fontId )
 {
 	// store current id
 	this->fontId = fontId;
-	// update texture
-	UpdateTexture();
+	// update layout
+	UpdateLayout();
 	// we must update offset
 	UpdateAlignmentOffset();
 }
@@ -472,37 +678,20 @@ void BMPLabelText::UpdateAlignmentOffset()
 
 void BMPLabelText::Draw()
 {
+	Coord_t		world_position = GetWorldPosition();
 	if( texture != NULL ) {
-		Coord_t		world_position;
-		SDL_Rect	srcrect;
 		SDL_Rect	dstrect;
-
-		// get coordinates int the world, this is normally the sum of coordinates of all parents
-		world_position = GetWorldPosition();
-		// set source rect (we always draw the entire texture, not a portion of it)
-		srcrect.x = 0;
-		srcrect.y = 0;
-		srcrect.w = width;
-		srcrect.h = height;
-		// if current size is different from default (1.0)... 	
-		if( size != 1 ) {
-			// we calculate the anchor point from the original size to let the object in the center
-			float		final_w, final_h;
-			final_w		= width * size;
-			final_h		= height * size;
-			dstrect.x	= (int)world_position.x + alignment_x_offset + width/2 - final_w/2;
-			dstrect.y	= (int)world_position.y + height/2 - final_h/2;;
-			dstrect.w	= final_w;
-			dstrect.h	= final_h;
-		} else {
-			dstrect.x = (int)world_position.x + alignment_x_offset;
-			dstrect.y = (int)world_position.y;
-			dstrect.w = width;
-			dstrect.h = height;
-		}
+		// the text is scaled around its center
+		dstrect.w	= (int)( width * size );
+		dstrect.h	= (int)( height * size );
+		dstrect.x	= (int)world_position.x + alignment_x_offset + width / 2 - dstrect.w / 2;
+		dstrect.y	= (int)world_position.y + height / 2 - dstrect.h / 2;
 		SDL_SetTextureAlphaMod( texture, alpha );
-		SDL_RenderCopyEx( Engine::GetRenderer(), texture, &srcrect, &dstrect, angle, NULL, flip );
+		SDL_RenderCopyEx( Engine::GetRenderer(), texture, NULL, &dstrect, angle, NULL, flip );
+		return;
 	}
+	SDL_Color	white = { 255, 255, 255, alpha };
+	AddGlyphsToBatch( quads, (int)world_position.x + alignment_x_offset, (int)world_position.y, width, height, size, angle, flip, white );
 }
 
 
@@ -513,11 +702,10 @@ BMPLabelValue::BMPLabelValue( int fontId, unsigned int tag, unsigned int zOrder
 	this->fontId = fontId;
 	this->value = 0;
 	wsprintf( this->text, L"%d", this->value );
-	this->texture = NULL;
 	this->alignment	= ALIGNMENT_CENTER;
 	this->alignment_x_offset	= 0;
-	// update texture
-	UpdateTexture();
+	// update layout
+	UpdateLayout();
 	// we must update offset
 	UpdateAlignmentOffset();
 }
@@ -526,8 +714,8 @@ void BMPLabelValue::SetValue( int value )
 {
 	this->value = value;
 	wsprintf( this->text, L"%d", this->value );
-	// update texture
-	UpdateTexture();
+	// update layout
+	UpdateLayout();
 	// we must update offset
 	UpdateAlignmentOffset();
 }
@@ -540,13 +728,12 @@ BMPLabelCurrency::BMPLabelCurrency( int fontId, unsigned int tag, unsigned int z
 	this->fontId = fontId;
 	this->amount = 0;
 	wsprintf( this->text, L"%d", this->amount );
-	this->texture = NULL;
 	this->alignment	= ALIGNMENT_CENTER;
 	this->alignment_x_offset	= 0;
 	// update text with amount value
 	UpdateText();
-	// update texture
-	UpdateTexture();
+	// update layout
+	UpdateLayout();
 	// we must update offset
 	UpdateAlignmentOffset();
 }
@@ -557,8 +744,8 @@ void BMPLabelCurrency::SetAmount( int amount )
 	wsprintf( this->text, L"%d", this->amount );
 	// update text with amount value
 	UpdateText();
-	// update texture
-	UpdateTexture();
+	// update layout
+	UpdateLayout();
 	// we must update offset
 	UpdateAlignmentOffset();
 }
@@ -567,8 +754,8 @@ void BMPLabelCurrency::SetEuroSymbol( bool state )
 {
 	this->euro_symbol = state;
 	UpdateText();
-	// update texture
-	UpdateTexture();
+	// update layout
+	UpdateLayout();
 	// we must update offset
 	UpdateAlignmentOffset();
 }
@@ -577,8 +764,8 @@ void BMPLabelCurrency::SetDecimals( bool state )
 {
 	this->decimals = state;
 	UpdateText();
-	// update texture
-	UpdateTexture();
+	// update layout
+	UpdateLayout();
 	// we must update offset
 	UpdateAlignmentOffset();
 }
@@ -8,8 +8,10 @@
 #include <SDL.h>
 #include <SDL_ttf.h>
 #include <stdio.h>
+#include <vector>
 #include "Node.h"
 #include "EngineCommon.h"
+#include "GlyphAtlas.h"
 
 
 #ifndef _LABELS_H_INCLUDE
@@ -26,6 +28,13 @@ typedef enum {
 	ALIGNMENT_MAX
 } LabelAlignment_t;
 
+// how a True Type label is drawn
+typedef enum {
+	LABEL_RENDER_TEXTURE,		// the whole text is rendered into a texture each time it changes
+	LABEL_RENDER_GLYPHS,		// the glyphs are drawn from the atlas of the font, changing text only updates the layout
+	LABEL_RENDER_MAX
+} LabelRenderMode_t;
+
 /*
 	Class Label
 */
@@ -45,6 +54,26 @@ public:
 	// update font size
 	void SetFontSize( int fontSize );
 
+	// change the way the label is drawn (see LabelRenderMode_t)
+	void SetRenderMode( LabelRenderMode_t mode );
+
+	// render mode of the labels created from now on (default is LABEL_RENDER_TEXTURE)
+	static void SetDefaultRenderMode( LabelRenderMode_t mode );
+
+	// changes of text, color and font are applied before the label is drawn (all changes of a frame with a single
+	// update), Refresh applies them immediately (e.g. when the new width is needed)
+	void Refresh();
+
+	// update the labels changed since previous frame, called by the engine before drawing the scene
+	static void UpdatePendingLabels();
+
+	// maximum time (milliseconds) spent by UpdatePendingLabels in a frame, the remaining labels are updated in
+	// the next frames (0 = no limit, default)
+	static void SetUpdateBudget( float milliseconds );
+
+	// remove the label from the update queue and release its texture
+	virtual ~Label();
+
 protected:
 
 	// object Label constructor (is protected because we don't want the game create an object
@@ -62,9 +91,28 @@ protected:
 	Uint32			color;				// current color of text
 	int				alignment;			// current alignment (center, right, left)s
 	int				alignment_x_offset;	// current horizontal offset due to alignment
-
-	// update current texture containing text
+	int				encoding;			// encoding of text (see TextEncoding_t)
+	int				renderMode;			// current render mode (texture or glyphs)
+	bool			numeric;			// glyphs of numbers are rendered in advance
+	int				numericRenderMode;	// render mode before switching to numeric (restored when switching back)
+	bool			dirty;				// texture (or layout) must be updated before drawing
+	GlyphAtlas		*atlas;				// atlas of current font and size (glyphs mode)
+	std::vector<GlyphQuad_t>	quads;	// glyphs to draw (glyphs mode)
+
+	// update current texture containing text (or the layout of the glyphs), textures are shared through TextCache
 	void			UpdateTexture();
+
+	// schedule the update of the texture before next drawing
+	void			Invalidate();
+
+	// update the glyphs to draw from the atlas
+	void			UpdateLayout();
+
+	// draw the glyphs of the layout (they are added to TextBatch)
+	void			DrawGlyphs();
+
+	// switch to glyphs with digits, separators and currency symbol rendered in advance (or back to the previous mode)
+	void			SetNumeric( bool state );
 	
 	// update current alignment horizontal offset
 	void			UpdateAlignmentOffset();
@@ -75,6 +123,9 @@ protected:
 		- for Unicode GetTextSurface uses TTF_RenderUNICODE_Blended 
 	*/
 	virtual SDL_Surface* GetTextSurface();
+
+	// copy current text as UTF16 characters (overriden like GetTextSurface), returns the length of the text
+	virtual int		GetCodepoints( Uint16 *codepoints );
 };
 
 
@@ -91,6 +142,10 @@ public:
 	// update text of label
 	void SetValue( const long value );
 
+	// if true the value is composed from the glyphs of digits and separators (rendered once when the mode is set),
+	// a new value doesn't create any surface or texture (use it for meters updated each frame)
+	void SetNumericMode( bool state );
+
 private:
 	// current value of label
 	long			value;
@@ -98,6 +153,8 @@ private:
 	char			text[ LABELS_TEXT_MAX_LENGTH ];
 	// ovverride of GetTextSurface of Label class
 	SDL_Surface*	GetTextSurface();
+	// ovverride of GetCodepoints of Label class
+	int				GetCodepoints( Uint16 *codepoints );
 	// update value of label
 	void UpdateText( const long value );
 };
@@ -124,6 +181,8 @@ private:
 
 	// ovverride of GetTextSurface of Label class
 	SDL_Surface*	GetTextSurface();
+	// ovverride of GetCodepoints of Label class
+	int				GetCodepoints( Uint16 *codepoints );
 };
 
 
@@ -149,6 +208,8 @@ private:
 
 	// ovverride of GetTextSurface of Label class
 	SDL_Surface*	GetTextSurface();
+	// ovverride of GetCodepoints of Label class
+	int				GetCodepoints( Uint16 *codepoints );
 };
 
 
@@ -174,6 +235,10 @@ public:
 	// if true include into the format decimal digits (,00)
 	void SetDecimals( bool state );
 
+	// if true the value is composed from the glyphs of digits, separators and currency symbol (rendered once when
+	// the mode is set), a new value doesn't create any surface or texture (use it for meters updated each frame)
+	void SetNumericMode( bool state );
+
 private:
 
 	// current value of label
@@ -187,6 +252,8 @@ private:
 
 	// ovverride of GetTextSurface of Label class
 	SDL_Surface*	GetTextSurface();
+	// ovverride of GetCodepoints of Label class
+	int				GetCodepoints( Uint16 *codepoints );
 
 	// update value of label
 	void UpdateText( const long value );
@@ -209,9 +276,12 @@ class  BMPLabelText : public Node {
 	
 public:
 
-	BMPLabelText() {};
+	BMPLabelText() { this->batched = true; this->texture = NULL; };
 	BMPLabelText( int fontId, unsigned int tag, unsigned int zOrder );
 
+	// release the texture of the text (if any)
+	virtual ~BMPLabelText();
+
 	// update text
 	void SetText( const wchar_t *text );
 
@@ -227,14 +297,20 @@ protected:
 
 
 	int				fontId;						// current font id 
-	SDL_Texture		*texture;					// current texture based on text
+	std::vector<GlyphQuad_t>	quads;			// characters to draw from the texture of the font
+	SDL_Texture		*texture;					// text rendered once, when TextBatch can't draw many glyphs with a call
 	int				alignment;					// current alignment (center, right, left)s
 	int				alignment_x_offset;			// current horizontal offset due to alignment
 	wchar_t			text[ MAX_TEXT_LENGTH ];	// current text
 
-	// function called each frame (override of function in Node class)
+	// function called each frame (override of function in Node class), characters are added to TextBatch (or the
+	// texture of the text is drawn)
 	void Draw();
 
+	// update the characters to draw according to text and font
+	void			UpdateLayout();
+
+	// render the characters into the texture of the text, only without TEXTBATCH_USE_RENDER_GEOMETRY (see TextBatch)
 	void			UpdateTexture();
 
 	// update current alignment horizontal offset
@@ -275,6 +275,54 @@ bool Misc::FindImageContour( const char *imageFilename, Coord_t *points, int max
 }
 
 
+bool Misc::MapFile( const char *filename, MappedFile_t *mappedFile )
+{
+	LARGE_INTEGER	fileSize;
+
+	memset( mappedFile, 0, sizeof( MappedFile_t ) );
+	// open the file
+	HANDLE file = CreateFileA( filename, GENERIC_READ, FILE_SHARE_READ, NULL, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, NULL );
+	if( file == INVALID_HANDLE_VALUE ) {
+		printf( "MapFile: unable to open %s\n", filename );
+		return false;
+	}
+	// empty files (or bigger than 4GB) can't be mapped
+	if( !GetFileSizeEx( file, &fileSize ) || ( fileSize.QuadPart == 0 ) || ( fileSize.QuadPart > 0xFFFFFFFF ) ) {
+		printf( "MapFile: invalid size of %s\n", filename );
+		CloseHandle( file );
+		return false;
+	}
+	// map the whole file
+	HANDLE mapping = CreateFileMappingA( file, NULL, PAGE_READONLY, 0, 0, NULL );
+	if( mapping == NULL ) {
+		printf( "MapFile: unable to map %s\n", filename );
+		CloseHandle( file );
+		return false;
+	}
+	const void *data = MapViewOfFile( mapping, FILE_MAP_READ, 0, 0, 0 );
+	if( data == NULL ) {
+		printf( "MapFile: unable to map %s\n", filename );
+		CloseHandle( mapping );
+		CloseHandle( file );
+		return false;
+	}
+	mappedFile->data	= (const unsigned char *)data;
+	mappedFile->size	= (unsigned int)fileSize.QuadPart;
+	mappedFile->file	= file;
+	mappedFile->mapping	= mapping;
+	return true;
+}
+
+void Misc::UnmapFile( MappedFile_t *mappedFile )
+{
+	if( mappedFile->data != NULL ) {
+		UnmapViewOfFile( mappedFile->data );
+		CloseHandle( (HANDLE)mappedFile->mapping );
+		CloseHandle( (HANDLE)mappedFile->file );
+	}
+	memset( mappedFile, 0, sizeof( MappedFile_t ) );
+}
+
 void Misc::Test()
 {
 }
\ No newline at end of file
@@ -68,6 +68,20 @@ public:
 	*/
 	static bool FindImageContour( const char *imageFilename, Coord_t *points, int maxPoints, int *totalPoints, int stepX, int stepY, int whichContour ); 
 
+	// file mapped in memory (see MapFile)
+	typedef struct {
+		const unsigned char	*data;		// content of the file
+		unsigned int		size;		// size of the file
+		void				*file;		// handles used internally
+		void				*mapping;
+	} MappedFile_t;
+
+	// map a file in memory (read only), returns false if the file can't be opened or is empty
+	static bool MapFile( const char *filename, MappedFile_t *mappedFile );
+
+	// release a file mapped by MapFile
+	static void UnmapFile( MappedFile_t *mappedFile );
+
 	// TODO
 	static void Test();
 };
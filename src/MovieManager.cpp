@@ -8,6 +8,7 @@
 #include "MovieManager.h"
 #include "Engine.h"
 #include "Misc.h"
+#include "Clock.h"
 
 // maximum length of movie path+filename 
 #define MOVIEMANAGER_FILENAME_MAX_LENGTH	128
@@ -16,6 +17,12 @@
 // movie file that the game should deal
 #define MOVIEMANAGER_MAX_STREAMS			128
 
+// minimum time (milliseconds) between two updates of the streams
+#define MOVIEMANAGER_UPDATE_TIME			20
+
+// time elapsed from the last update of the streams
+static double		updateElapsedTime	= 0;
+
 /*
 	stream data
 */
@@ -301,13 +308,11 @@ void MovieManager::Update()
 	int				read_result = 0;
 
 	// whatever FPS we don't update stream if at least 20 ms elapsed from last update
-	static Uint32	lastUpdateTicks	= 0;
-	Uint32 now  = Engine::GetDrawSceneTicks();
-	Uint32 diff = now - lastUpdateTicks;
-	if( diff < 20 ) {
+	updateElapsedTime += Clock::GetDeltaTime();
+	if( updateElapsedTime < MOVIEMANAGER_UPDATE_TIME ) {
 		return; 
 	}
-	lastUpdateTicks = now;
+	updateElapsedTime = 0;
 
 	// scan all streams
 	for( int i = 0; i < totalStreams; i++ ) {
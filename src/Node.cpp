@@ -8,6 +8,7 @@
 #include <algorithm>
 #include "Node.h"
 #include "Engine.h"
+#include "TextBatch.h"
 
 
 Node::Node() {
@@ -30,6 +31,7 @@ Node::Node() {
 	tag = 0;		// set a default tag
 	parent = NULL;	// reset parent pointer, it will be set by addChild
 	zOrder = 0;		// reset depth level to zero, every child must have a higher depth level
+	batched = false;	// by default an object draws itself immediately
 }
 
 Node::Node( unsigned int tag )
@@ -51,6 +53,7 @@ Node::Node( unsigned int tag )
 	this->tag = tag;	// set tag
 	parent = NULL;	// reset parent pointer, it will be set by addChild
 	zOrder = 0;		// reset depth level to zero, every child must have a higher depth level
+	batched = false;	// by default an object draws itself immediately
 }
 
 void Node::Visit()
@@ -60,6 +63,10 @@ void Node::Visit()
 	if( !this->visible ) {
 		return;
 	}
+	// glyphs of labels drawn so far must be on the screen before an object drawn immediately
+	if( !this->batched ) {
+		TextBatch::Flush();
+	}
 	// draw current node
 	this->Draw();
 	// if object has children...
@@ -72,6 +79,11 @@ void Node::Visit()
 	} 
 }
 
+Node::~Node()
+{
+	// subclasses release their own resources
+}
+
 void Node::Delete()
 {
 	// if object has children...
@@ -240,6 +252,11 @@ void Node::SetParent( Node *node )
 	parent = node;
 }
 
+Node* Node::GetParent()
+{
+	return parent;
+}
+
 Coord_t Node::GetParentPosition()
 {
 	Coord_t point = { 0, 0 };
@@ -19,6 +19,8 @@ public:
 		// object Node constructor
 		Node();
 		Node( unsigned int tag );
+		// destructor, virtual because nodes are deleted through Node pointers (see Delete)
+		virtual ~Node();
 
 		// current total number of children
 		long totalChildren;
@@ -82,8 +84,9 @@ public:
 		int	 GetTag();
 		void SetTag( unsigned int tag );
 
-		// set parent node
+		// set/get parent node
 		void SetParent( Node* node );
+		Node* GetParent();
 		// return parent's position
 		Coord_t GetParentPosition();
 
@@ -126,6 +129,7 @@ protected:
 		unsigned int		tag;		// unique identifier
 		Node*				parent;		// pointer to parent
 		unsigned int		zOrder;		// depth level
+		bool				batched;	// true if Draw only adds glyphs to TextBatch (see Visit)
 
 		// draw texture according to object parameters (position, size, angle, ...)
 		void				DrawTexture( SDL_Texture *texture, int original_w, int original_h );
@@ -0,0 +1,582 @@
+/*
+ 	The information contained herein is confidential.
+ 	The use, copying, transfer or disclosure of such information is proibited
+ 	except by press written agreement with the author
+*/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string>
+#include <map>
+#include <vector>
+#include <algorithm>
+#include "ParticleEffectManager.h"
+#include "Engine.h"
+#include "Misc.h"
+
+using namespace std;
+
+// a loaded effect
+typedef struct {
+	unsigned int			id;
+	ParticleSystemConfig_t	config;
+	SDL_Texture				*texture;
+	// sprite sheet
+	int						sheetColumns;
+	int						sheetRows;
+	int						sheetFrames;
+	float					sheetFramesPerSecond;
+	int						sheetStartFrame;
+} Effect_t;
+
+// values of a .plist file (key and value as text)
+typedef map< string, string >	PlistValues_t;
+
+// loaded effects
+static Effect_t			effects[ PARTICLEEFFECTMANAGER_MAX_EFFECTS ];
+// total number of loaded effects
+static unsigned int		totalEffects = 0;
+// textures of replaced effects, systems created before the replacement may still use them until Unload
+static vector< SDL_Texture* >	replacedTextures;
+
+// returns the effect with an id, NULL if not loaded
+static Effect_t* FindEffect( unsigned int id )
+{
+	for( unsigned int i = 0; i < totalEffects; i++ ) {
+		if( effects[ i ].id == id ) {
+			return &effects[ i ];
+		}
+	}
+	return NULL;
+}
+
+// store an effect, an effect with the same id is replaced (so effects can be reloaded while editing)
+static bool StoreEffect( const Effect_t *effect )
+{
+	Effect_t *slot = FindEffect( effect->id );
+	if( slot != NULL ) {
+		if( ( slot->texture != NULL ) && ( slot->texture != effect->texture ) ) {
+			replacedTextures.push_back( slot->texture );
+		}
+	} else {
+		if( totalEffects >= PARTICLEEFFECTMANAGER_MAX_EFFECTS ) {
+			printf( "ParticleEffectManager: too many effects\n" );
+			return false;
+		}
+		slot = &effects[ totalEffects ];
+		totalEffects += 1;
+	}
+	*slot = *effect;
+	return true;
+}
+
+// returns the directory (with the final separator) of a file
+static string GetDirectory( const char *filename )
+{
+	string path( filename );
+	size_t separator = path.find_last_of( "/\\" );
+	return ( separator == string::npos ? string() : path.substr( 0, separator + 1 ) );
+}
+
+// returns true if the maximum number of particles of an effect is valid
+static bool IsValidTotalParticles( unsigned int totalParticles, const char *filename )
+{
+	if( ( totalParticles == 0 ) || ( totalParticles > PARTICLEEFFECTMANAGER_MAX_PARTICLES ) ) {
+		printf( "ParticleEffectManager: invalid number of particles %u in %s\n", totalParticles, filename );
+		return false;
+	}
+	return true;
+}
+
+// returns true if the sprite sheet of an effect is valid (a single image is a 1 x 1 sheet)
+static bool IsValidSpriteSheet( const Effect_t *effect, const char *filename )
+{
+	int columns	= effect->sheetColumns;
+	int rows	= effect->sheetRows;
+	if( ( columns < 1 ) || ( columns > PARTICLESYSTEM_MAX_FRAMES ) || ( rows < 1 ) || ( rows > PARTICLESYSTEM_MAX_FRAMES ) ) {
+		printf( "ParticleEffectManager: invalid sprite sheet %d x %d in %s\n", columns, rows, filename );
+		return false;
+	}
+	// 0 frames = all the cells of the grid
+	int frames = ( effect->sheetFrames == 0 ? columns * rows : effect->sheetFrames );
+	if( ( frames < 1 ) || ( frames > columns * rows ) || ( ( columns * rows > 1 ) && ( frames > PARTICLESYSTEM_MAX_FRAMES ) ) ) {
+		printf( "ParticleEffectManager: invalid number of frames %d in %s\n", effect->sheetFrames, filename );
+		return false;
+	}
+	// the test is negated so NaN is rejected too
+	if( !( effect->sheetFramesPerSecond >= 0 ) ) {
+		printf( "ParticleEffectManager: invalid frames per second %f in %s\n", effect->sheetFramesPerSecond, filename );
+		return false;
+	}
+	// -1 = random start frame
+	if( ( effect->sheetStartFrame < -1 ) || ( effect->sheetStartFrame >= frames ) ) {
+		printf( "ParticleEffectManager: invalid start frame %d in %s\n", effect->sheetStartFrame, filename );
+		return false;
+	}
+	return true;
+}
+
+// create a texture from an image file in memory
+static SDL_Texture* CreateTexture( const unsigned char *data, unsigned int size )
+{
+	SDL_Texture *texture = IMG_LoadTexture_RW( Engine::GetRenderer(), SDL_RWFromConstMem( data, size ), 1 );
+	if( texture == NULL ) {
+		printf( "ParticleEffectManager: invalid image (%s)\n", SDL_GetError() );
+	}
+	return texture;
+}
+
+// ====================================== binary files ======================================
+
+static void ConfigToRecord( const ParticleSystemConfig_t *c, ParticleEffectConfigRecord_t *r )
+{
+	memset( r, 0, sizeof( ParticleEffectConfigRecord_t ) );
+	r->mode					= c->mode;
+	r->totalParticles		= c->totalParticles;
+	r->duration				= c->duration;
+	r->emissionRate			= c->emissionRate;
+	r->emitterShape			= c->emitterShape;
+	r->positionVarX			= c->positionVar.x;
+	r->positionVarY			= c->positionVar.y;
+	r->angle				= c->angle;
+	r->angleVar				= c->angleVar;
+	r->life					= c->life;
+	r->lifeVar				= c->lifeVar;
+	r->startSize			= c->startSize;
+	r->startSizeVar			= c->startSizeVar;
+	r->endSize				= c->endSize;
+	r->endSizeVar			= c->endSizeVar;
+	r->startSpin			= c->startSpin;
+	r->startSpinVar			= c->startSpinVar;
+	r->endSpin				= c->endSpin;
+	r->endSpinVar			= c->endSpinVar;
+	memcpy( r->startColor, &c->startColor, sizeof( r->startColor ) );
+	memcpy( r->startColorVar, &c->startColorVar, sizeof( r->startColorVar ) );
+	memcpy( r->endColor, &c->endColor, sizeof( r->endColor ) );
+	memcpy( r->endColorVar, &c->endColorVar, sizeof( r->endColorVar ) );
+	r->yCoordFlipped		= c->yCoordFlipped;
+	r->gravityX				= c->gravity.x;
+	r->gravityY				= c->gravity.y;
+	r->speed				= c->speed;
+	r->speedVar				= c->speedVar;
+	r->tangentialAccel		= c->tangentialAccel;
+	r->tangentialAccelVar	= c->tangentialAccelVar;
+	r->radialAccel			= c->radialAccel;
+	r->radialAccelVar		= c->radialAccelVar;
+	r->rotationIsDirection	= ( c->rotationIsDirection ? 1 : 0 );
+	r->startRadius			= c->startRadius;
+	r->startRadiusVar		= c->startRadiusVar;
+	r->endRadius			= c->endRadius;
+	r->endRadiusVar			= c->endRadiusVar;
+	r->rotatePerSecond		= c->rotatePerSecond;
+	r->rotatePerSecondVar	= c->rotatePerSecondVar;
+}
+
+// convert a record into a configuration, returns false if the record is invalid
+static bool RecordToConfig( const ParticleEffectConfigRecord_t *r, ParticleSystemConfig_t *c, const char *filename )
+{
+	if( ( r->mode > MODE_RADIUS ) || ( r->emitterShape > ES_POINTS_ARRAY ) ) {
+		printf( "ParticleEffectManager: invalid mode %u or emitter shape %u in %s\n", r->mode, r->emitterShape, filename );
+		return false;
+	}
+	// emitter points are not stored in the file
+	if( r->emitterShape == ES_POINTS_ARRAY ) {
+		printf( "ParticleEffectManager: unsupported emitter shape %u in %s\n", r->emitterShape, filename );
+		return false;
+	}
+	if( !IsValidTotalParticles( r->totalParticles, filename ) ) {
+		return false;
+	}
+	*c = ParticleSystemConfig_t();
+	c->mode					= (PSMode_t)r->mode;
+	c->totalParticles		= r->totalParticles;
+	c->duration				= r->duration;
+	c->emissionRate			= r->emissionRate;
+	c->emitterShape			= (EmitterShape_t)r->emitterShape;
+	c->positionVar			= Pointf( r->positionVarX, r->positionVarY );
+	c->angle				= r->angle;
+	c->angleVar				= r->angleVar;
+	c->life					= r->life;
+	c->lifeVar				= r->lifeVar;
+	c->startSize			= r->startSize;
+	c->startSizeVar			= r->startSizeVar;
+	c->endSize				= r->endSize;
+	c->endSizeVar			= r->endSizeVar;
+	c->startSpin			= r->startSpin;
+	c->startSpinVar			= r->startSpinVar;
+	c->endSpin				= r->endSpin;
+	c->endSpinVar			= r->endSpinVar;
+	c->startColor			= Color4F( r->startColor[ 0 ], r->startColor[ 1 ], r->startColor[ 2 ], r->startColor[ 3 ] );
+	c->startColorVar		= Color4F( r->startColorVar[ 0 ], r->startColorVar[ 1 ], r->startColorVar[ 2 ], r->startColorVar[ 3 ] );
+	c->endColor				= Color4F( r->endColor[ 0 ], r->endColor[ 1 ], r->endColor[ 2 ], r->endColor[ 3 ] );
+	c->endColorVar			= Color4F( r->endColorVar[ 0 ], r->endColorVar[ 1 ], r->endColorVar[ 2 ], r->endColorVar[ 3 ] );
+	c->yCoordFlipped		= r->yCoordFlipped;
+	c->gravity				= Pointf( r->gravityX, r->gravityY );
+	c->speed				= r->speed;
+	c->speedVar				= r->speedVar;
+	c->tangentialAccel		= r->tangentialAccel;
+	c->tangentialAccelVar	= r->tangentialAccelVar;
+	c->radialAccel			= r->radialAccel;
+	c->radialAccelVar		= r->radialAccelVar;
+	c->rotationIsDirection	= ( r->rotationIsDirection != 0 );
+	c->startRadius			= r->startRadius;
+	c->startRadiusVar		= r->startRadiusVar;
+	c->endRadius			= r->endRadius;
+	c->endRadiusVar			= r->endRadiusVar;
+	c->rotatePerSecond		= r->rotatePerSecond;
+	c->rotatePerSecondVar	= r->rotatePerSecondVar;
+	return true;
+}
+
+bool ParticleEffectManager::Load( unsigned int id, const char *filename )
+{
+	Misc::MappedFile_t	file;
+	Effect_t			effect;
+	bool				result = false;
+
+	if( !Misc::MapFile( filename, &file ) ) {
+		return false;
+	}
+	do {
+		// check the header
+		if( file.size < sizeof( ParticleEffectFileHeader_t ) + sizeof( ParticleEffectConfigRecord_t ) ) {
+			printf( "ParticleEffectManager: %s is too short\n", filename );
+			break;
+		}
+		const ParticleEffectFileHeader_t *header = (const ParticleEffectFileHeader_t *)file.data;
+		if( ( header->magic != PARTICLEEFFECT_FILE_MAGIC ) || ( header->version != PARTICLEEFFECT_FILE_VERSION ) ) {
+			printf( "ParticleEffectManager: %s is not a valid effect file\n", filename );
+			break;
+		}
+		const unsigned char *texture = file.data + sizeof( ParticleEffectFileHeader_t ) + sizeof( ParticleEffectConfigRecord_t );
+		if( header->textureSize > (unsigned int)( file.data + file.size - texture ) ) {
+			printf( "ParticleEffectManager: invalid texture in %s\n", filename );
+			break;
+		}
+
+		// configuration is read straight from the file
+		effect = Effect_t();
+		effect.id = id;
+		if( !RecordToConfig( (const ParticleEffectConfigRecord_t *)( file.data + sizeof( ParticleEffectFileHeader_t ) ), &effect.config, filename ) ) {
+			break;
+		}
+		effect.sheetColumns			= header->sheetColumns;
+		effect.sheetRows			= header->sheetRows;
+		effect.sheetFrames			= header->sheetFrames;
+		effect.sheetFramesPerSecond	= header->sheetFramesPerSecond;
+		effect.sheetStartFrame		= header->sheetStartFrame;
+		if( !IsValidSpriteSheet( &effect, filename ) ) {
+			break;
+		}
+
+		// decode the embedded image or load the referenced one
+		if( header->textureType == PARTICLEEFFECT_TEXTURE_EMBEDDED ) {
+			effect.texture = CreateTexture( texture, header->textureSize );
+		} else if( header->textureType == PARTICLEEFFECT_TEXTURE_REFERENCED ) {
+			string path = GetDirectory( filename ) + string( (const char *)texture, header->textureSize );
+			effect.texture = IMG_LoadTexture( Engine::GetRenderer(), path.c_str() );
+			if( effect.texture == NULL ) {
+				printf( "ParticleEffectManager: unable to load %s\n", path.c_str() );
+			}
+		}
+		if( ( header->textureType != PARTICLEEFFECT_TEXTURE_NONE ) && ( effect.texture == NULL ) ) {
+			break;
+		}
+		result = StoreEffect( &effect );
+		if( !result && ( effect.texture != NULL ) ) {
+			SDL_DestroyTexture( effect.texture );
+		}
+	} while( false );
+
+	Misc::UnmapFile( &file );
+	return result;
+}
+
+// ====================================== .plist files ======================================
+
+// read all keys of the dictionary of a .plist file (values of a Particle Designer file are not nested)
+static bool ParsePlist( const char *filename, PlistValues_t *values )
+{
+	Misc::MappedFile_t	file;
+
+	if( !Misc::MapFile( filename, &file ) ) {
+		return false;
+	}
+	string text( (const char *)file.data, file.size );
+	Misc::UnmapFile( &file );
+
+	size_t position = 0;
+	while( ( position = text.find( "<key>", position ) ) != string::npos ) {
+		position += strlen( "<key>" );
+		size_t keyEnd = text.find( "</key>", position );
+		if( keyEnd == string::npos ) {
+			break;
+		}
+		string key = text.substr( position, keyEnd - position );
+		position = text.find( '<', keyEnd + strlen( "</key>" ) );
+		if( position == string::npos ) {
+			break;
+		}
+		// value: <real>, <integer>, <string> or <true/>, <false/>
+		if( text.compare( position, strlen( "<true/>" ), "<true/>" ) == 0 ) {
+			( *values )[ key ] = "1";
+		} else if( text.compare( position, strlen( "<false/>" ), "<false/>" ) == 0 ) {
+			( *values )[ key ] = "0";
+		} else {
+			size_t valueStart	= text.find( '>', position );
+			size_t valueEnd		= text.find( '<', valueStart );
+			if( ( valueStart == string::npos ) || ( valueEnd == string::npos ) ) {
+				break;
+			}
+			( *values )[ key ] = text.substr( valueStart + 1, valueEnd - valueStart - 1 );
+			position = valueEnd;
+		}
+	}
+	if( values->empty() ) {
+		printf( "ParticleEffectManager: %s is not a valid .plist file\n", filename );
+		return false;
+	}
+	return true;
+}
+
+static float GetFloat( PlistValues_t &values, const char *key, float defaultValue )
+{
+	PlistValues_t::iterator value = values.find( key );
+	return ( value == values.end() ? defaultValue : (float)atof( value->second.c_str() ) );
+}
+
+// decode base64 text (white spaces are skipped)
+static void DecodeBase64( const string &text, string *data )
+{
+	unsigned int bits	= 0;
+	int totalBits		= 0;
+	data->clear();
+	for( size_t i = 0; i < text.size(); i++ ) {
+		char c = text[ i ];
+		int value;
+		if( ( c >= 'A' ) && ( c <= 'Z' ) ) {
+			value = c - 'A';
+		} else if( ( c >= 'a' ) && ( c <= 'z' ) ) {
+			value = c - 'a' + 26;
+		} else if( ( c >= '0' ) && ( c <= '9' ) ) {
+			value = c - '0' + 52;
+		} else if( c == '+' ) {
+			value = 62;
+		} else if( c == '/' ) {
+			value = 63;
+		} else {
+			continue;
+		}
+		bits		= ( bits << 6 ) | value;
+		totalBits	+= 6;
+		if( totalBits >= 8 ) {
+			totalBits -= 8;
+			data->push_back( (char)( ( bits >> totalBits ) & 0xff ) );
+		}
+	}
+}
+
+/*
+	convert the values of a Particle Designer file into an effect; cocos2d uses y up coordinates so the effect is
+	mirrored: angles, vertical gravity and tangential acceleration change sign.
+	The image is returned as the name of the file (relative to the .plist file) and as the content of the file when
+	it is embedded in the .plist file (textureImageData), images compressed with gzip are not supported
+*/
+static void PlistToEffect( PlistValues_t &values, Effect_t *effect, string *textureFilename, string *textureData )
+{
+	ParticleSystemConfig_t *c = &effect->config;
+
+	*effect = Effect_t();
+	c->mode					= ( GetFloat( values, "emitterType", 0 ) == 1 ? MODE_RADIUS : MODE_GRAVITY );
+	c->totalParticles		= (unsigned int)(std::max)( GetFloat( values, "maxParticles", 0 ), 0.0f );
+	c->duration				= GetFloat( values, "duration", -1 );
+	c->life					= GetFloat( values, "particleLifespan", 0 );
+	c->lifeVar				= GetFloat( values, "particleLifespanVariance", 0 );
+	// Particle Designer emits the maximum number of particles during the life of a particle
+	c->emissionRate			= GetFloat( values, "emissionRate", ( c->life > 0 ? c->totalParticles / c->life : 0 ) );
+	c->emitterShape			= ES_RECTANGULAR_AREA;
+	c->positionVar			= Pointf( GetFloat( values, "sourcePositionVariancex", 0 ), GetFloat( values, "sourcePositionVariancey", 0 ) );
+	c->angle				= -GetFloat( values, "angle", 0 );
+	c->angleVar				= GetFloat( values, "angleVariance", 0 );
+	c->startSize			= GetFloat( values, "startParticleSize", 0 );
+	c->startSizeVar			= GetFloat( values, "startParticleSizeVariance", 0 );
+	c->endSize				= GetFloat( values, "finishParticleSize", ParticleSystem::START_SIZE_EQUAL_TO_END_SIZE );
+	c->endSizeVar			= GetFloat( values, "finishParticleSizeVariance", 0 );
+	c->startSpin			= GetFloat( values, "rotationStart", 0 );
+	c->startSpinVar			= GetFloat( values, "rotationStartVariance", 0 );
+	c->endSpin				= GetFloat( values, "rotationEnd", 0 );
+	c->endSpinVar			= GetFloat( values, "rotationEndVariance", 0 );
+	c->startColor			= Color4F( GetFloat( values, "startColorRed", 1 ), GetFloat( values, "startColorGreen", 1 ),
+									   GetFloat( values, "startColorBlue", 1 ), GetFloat( values, "startColorAlpha", 1 ) );
+	c->startColorVar		= Color4F( GetFloat( values, "startColorVarianceRed", 0 ), GetFloat( values, "startColorVarianceGreen", 0 ),
+									   GetFloat( values, "startColorVarianceBlue", 0 ), GetFloat( values, "startColorVarianceAlpha", 0 ) );
+	c->endColor				= Color4F( GetFloat( values, "finishColorRed", 1 ), GetFloat( values, "finishColorGreen", 1 ),
+									   GetFloat( values, "finishColorBlue", 1 ), GetFloat( values, "finishColorAlpha", 1 ) );
+	c->endColorVar			= Color4F( GetFloat( values, "finishColorVarianceRed", 0 ), GetFloat( values, "finishColorVarianceGreen", 0 ),
+									   GetFloat( values, "finishColorVarianceBlue", 0 ), GetFloat( values, "finishColorVarianceAlpha", 0 ) );
+	c->yCoordFlipped		= 1;
+	// gravity mode
+	c->gravity				= Pointf( GetFloat( values, "gravityx", 0 ), -GetFloat( values, "gravityy", 0 ) );
+	c->speed				= GetFloat( values, "speed", 0 );
+	c->speedVar				= GetFloat( values, "speedVariance", 0 );
+	c->tangentialAccel		= -GetFloat( values, "tangentialAcceleration", 0 );
+	c->tangentialAccelVar	= GetFloat( values, "tangentialAccelVariance", 0 );
+	c->radialAccel			= GetFloat( values, "radialAcceleration", 0 );
+	c->radialAccelVar		= GetFloat( values, "radialAccelVariance", 0 );
+	c->rotationIsDirection	= ( GetFloat( values, "rotationIsDir", 0 ) != 0 );
+	// radius mode
+	c->startRadius			= GetFloat( values, "maxRadius", 0 );
+	c->startRadiusVar		= GetFloat( values, "maxRadiusVariance", 0 );
+	c->endRadius			= GetFloat( values, "minRadius", 0 );
+	c->endRadiusVar			= GetFloat( values, "minRadiusVariance", 0 );
+	c->rotatePerSecond		= -GetFloat( values, "rotatePerSecond", 0 );
+	c->rotatePerSecondVar	= GetFloat( values, "rotatePerSecondVariance", 0 );
+
+	// sprite sheet (not part of the Particle Designer format)
+	effect->sheetColumns			= (int)GetFloat( values, "spriteSheetColumns", 1 );
+	effect->sheetRows				= (int)GetFloat( values, "spriteSheetRows", 1 );
+	effect->sheetFrames				= (int)GetFloat( values, "spriteSheetFrames", 0 );
+	effect->sheetFramesPerSecond	= GetFloat( values, "spriteSheetFramesPerSecond", PARTICLESYSTEM_FRAMES_PER_SECOND );
+	effect->sheetStartFrame			= (int)GetFloat( values, "spriteSheetStartFrame", 0 );
+
+	// image
+	*textureFilename = values[ "textureFileName" ];
+	textureData->clear();
+	if( values.find( "textureImageData" ) != values.end() ) {
+		DecodeBase64( values[ "textureImageData" ], textureData );
+		if( ( textureData->size() >= 2 ) && ( (unsigned char)( *textureData )[ 0 ] == 0x1f ) && ( (unsigned char)( *textureData )[ 1 ] == 0x8b ) ) {
+			printf( "ParticleEffectManager: compressed textureImageData is not supported, textureFileName is used\n" );
+			textureData->clear();
+		}
+	}
+}
+
+bool ParticleEffectManager::Import( unsigned int id, const char *filename )
+{
+	PlistValues_t	values;
+	Effect_t		effect;
+	string			textureFilename;
+	string			textureData;
+
+	if( !ParsePlist( filename, &values ) ) {
+		return false;
+	}
+	PlistToEffect( values, &effect, &textureFilename, &textureData );
+	if( !IsValidTotalParticles( effect.config.totalParticles, filename ) || !IsValidSpriteSheet( &effect, filename ) ) {
+		return false;
+	}
+	effect.id = id;
+	if( !textureData.empty() ) {
+		effect.texture = CreateTexture( (const unsigned char *)textureData.data(), textureData.size() );
+	} else if( !textureFilename.empty() ) {
+		string path = GetDirectory( filename ) + textureFilename;
+		effect.texture = IMG_LoadTexture( Engine::GetRenderer(), path.c_str() );
+		if( effect.texture == NULL ) {
+			printf( "ParticleEffectManager: unable to load %s\n", path.c_str() );
+		}
+	}
+	if( effect.texture == NULL ) {
+		return false;
+	}
+	if( !StoreEffect( &effect ) ) {
+		SDL_DestroyTexture( effect.texture );
+		return false;
+	}
+	return true;
+}
+
+bool ParticleEffectManager::Convert( const char *plistFilename, const char *effectFilename, bool embedTexture )
+{
+	PlistValues_t					values;
+	Effect_t						effect;
+	string							textureFilename;
+	string							textureData;
+	ParticleEffectFileHeader_t		header;
+	ParticleEffectConfigRecord_t	record;
+	Misc::MappedFile_t				textureFile;
+
+	if( !ParsePlist( plistFilename, &values ) ) {
+		return false;
+	}
+	PlistToEffect( values, &effect, &textureFilename, &textureData );
+	if( !IsValidTotalParticles( effect.config.totalParticles, plistFilename ) || !IsValidSpriteSheet( &effect, plistFilename ) ) {
+		return false;
+	}
+
+	// texture section: content of the image or its name
+	memset( &textureFile, 0, sizeof( Misc::MappedFile_t ) );
+	const void *texture		= textureFilename.data();
+	unsigned int textureSize	= textureFilename.size();
+	header.textureType		= ( textureFilename.empty() ? PARTICLEEFFECT_TEXTURE_NONE : PARTICLEEFFECT_TEXTURE_REFERENCED );
+	if( embedTexture ) {
+		if( !textureData.empty() ) {
+			texture		= textureData.data();
+			textureSize	= textureData.size();
+		} else if( !Misc::MapFile( ( GetDirectory( plistFilename ) + textureFilename ).c_str(), &textureFile ) ) {
+			return false;
+		} else {
+			texture		= textureFile.data;
+			textureSize	= textureFile.size;
+		}
+		header.textureType = PARTICLEEFFECT_TEXTURE_EMBEDDED;
+	}
+
+	header.magic				= PARTICLEEFFECT_FILE_MAGIC;
+	header.version				= PARTICLEEFFECT_FILE_VERSION;
+	header.textureSize			= textureSize;
+	header.sheetColumns			= effect.sheetColumns;
+	header.sheetRows			= effect.sheetRows;
+	header.sheetFrames			= effect.sheetFrames;
+	header.sheetFramesPerSecond	= effect.sheetFramesPerSecond;
+	header.sheetStartFrame		= effect.sheetStartFrame;
+	ConfigToRecord( &effect.config, &record );
+
+	bool result = false;
+	FILE *file = fopen( effectFilename, "wb" );
+	if( file != NULL ) {
+		result = ( fwrite( &header, sizeof( header ), 1, file ) == 1 ) && ( fwrite( &record, sizeof( record ), 1, file ) == 1 ) &&
+				 ( ( textureSize == 0 ) || ( fwrite( texture, textureSize, 1, file ) == 1 ) );
+		result = ( fclose( file ) == 0 ) && result;
+	}
+	if( !result ) {
+		printf( "ParticleEffectManager: unable to write %s\n", effectFilename );
+	}
+	Misc::UnmapFile( &textureFile );
+	return result;
+}
+
+// ====================================== systems ======================================
+
+ParticleSystem* ParticleEffectManager::CreateSystem( unsigned int id, unsigned int tag, unsigned int zOrder )
+{
+	Effect_t *effect = FindEffect( id );
+	if( effect == NULL ) {
+		printf( "ParticleEffectManager: effect %d not loaded\n", id );
+		return NULL;
+	}
+	ParticleSystem *system = new ParticleSystem( tag, zOrder );
+	system->SetConfig( &effect->config );
+	if( effect->sheetColumns * effect->sheetRows > 1 ) {
+		system->SetSpriteSheet( effect->texture, effect->sheetColumns, effect->sheetRows, effect->sheetFrames,
+								effect->sheetFramesPerSecond, effect->sheetStartFrame );
+	} else {
+		system->SetTexture( effect->texture );
+	}
+	system->Start();
+	return system;
+}
+
+void ParticleEffectManager::Unload()
+{
+	for( unsigned int i = 0; i < totalEffects; i++ ) {
+		if( effects[ i ].texture != NULL ) {
+			SDL_DestroyTexture( effects[ i ].texture );
+		}
+		effects[ i ] = Effect_t();
+	}
+	totalEffects = 0;
+	for( size_t i = 0; i < replacedTextures.size(); i++ ) {
+		SDL_DestroyTexture( replacedTextures[ i ] );
+	}
+	replacedTextures.clear();
+}
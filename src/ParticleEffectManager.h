@@ -0,0 +1,130 @@
+/*
+ 	The information contained herein is confidential.
+ 	The use, copying, transfer or disclosure of such information is proibited
+ 	except by press written agreement with the author
+*/
+
+#ifndef _PARTICLEEFFECTMANAGER_H_INCLUDE
+#define _PARTICLEEFFECTMANAGER_H_INCLUDE
+
+#include "EngineCommon.h"
+#include "ParticleSystem.h"
+
+// maximum number of effects loaded at the same time
+#define PARTICLEEFFECTMANAGER_MAX_EFFECTS		64
+// maximum number of particles of an effect (effects with more particles are considered invalid)
+#define PARTICLEEFFECTMANAGER_MAX_PARTICLES		100000
+
+/*
+	Binary format of an effect file (all values are 32 bit little endian, floats are IEEE 754):
+
+	header				ParticleEffectFileHeader_t
+	configuration		ParticleEffectConfigRecord_t
+	texture				textureSize bytes: the image file (PNG, ...) if the texture is embedded or the name of
+						the image file (relative to the effect file, no terminator) if the texture is referenced
+*/
+
+// "APE1"
+#define PARTICLEEFFECT_FILE_MAGIC		0x31455041
+#define PARTICLEEFFECT_FILE_VERSION		1
+
+// how the texture of an effect is stored
+typedef enum {
+	PARTICLEEFFECT_TEXTURE_NONE = 0,
+	PARTICLEEFFECT_TEXTURE_EMBEDDED,
+	PARTICLEEFFECT_TEXTURE_REFERENCED
+} ParticleEffectTexture_t;
+
+typedef struct {
+	uint32_t	magic;
+	uint32_t	version;
+	uint32_t	textureType;		// see ParticleEffectTexture_t
+	uint32_t	textureSize;		// bytes of the texture section
+	// sprite sheet (see ParticleSystem::SetSpriteSheet), 1 x 1 for a single image
+	uint32_t	sheetColumns;
+	uint32_t	sheetRows;
+	uint32_t	sheetFrames;
+	float		sheetFramesPerSecond;
+	int32_t		sheetStartFrame;
+} ParticleEffectFileHeader_t;
+
+// fields of ParticleSystemConfig_t (emitter points are not stored)
+typedef struct {
+	uint32_t	mode;
+	uint32_t	totalParticles;
+	float		duration;
+	float		emissionRate;
+	uint32_t	emitterShape;		// ES_POINTS_ARRAY is not supported
+	float		positionVarX;
+	float		positionVarY;
+	float		angle;
+	float		angleVar;
+	float		life;
+	float		lifeVar;
+	float		startSize;
+	float		startSizeVar;
+	float		endSize;
+	float		endSizeVar;
+	float		startSpin;
+	float		startSpinVar;
+	float		endSpin;
+	float		endSpinVar;
+	float		startColor[ 4 ];
+	float		startColorVar[ 4 ];
+	float		endColor[ 4 ];
+	float		endColorVar[ 4 ];
+	int32_t		yCoordFlipped;
+	float		gravityX;
+	float		gravityY;
+	float		speed;
+	float		speedVar;
+	float		tangentialAccel;
+	float		tangentialAccelVar;
+	float		radialAccel;
+	float		radialAccelVar;
+	uint32_t	rotationIsDirection;
+	float		startRadius;
+	float		startRadiusVar;
+	float		endRadius;
+	float		endRadiusVar;
+	float		rotatePerSecond;
+	float		rotatePerSecondVar;
+} ParticleEffectConfigRecord_t;
+
+/*
+	This is the ParticleEffectManager, it loads particle effects (configuration and texture) from files so
+	effects can be changed without rebuilding the game.
+	- binary effect files are mapped in memory and read without any parsing (use them in the game)
+	- .plist files of Particle Designer and cocos2d can be imported directly (slower, use them while editing)
+	  or converted into binary effect files
+	Effects are identified by an id, each call of CreateSystem returns a new system using the effect.
+	Example:
+		ParticleEffectManager::Load( EFFECT_FIRE, "fire.ape" );
+		ParticleSystem *fire = ParticleEffectManager::CreateSystem( EFFECT_FIRE, TAG_FIRE, 10 );
+		fire->SetPosition( 100, 200 );
+		scene->AddChild( fire );
+*/
+namespace ParticleEffectManager {
+
+	// load a binary effect file, returns false if the file is invalid
+	bool Load( unsigned int id, const char *filename );
+
+	// load a Particle Designer / cocos2d .plist file, returns false if the file is invalid
+	bool Import( unsigned int id, const char *filename );
+
+	// convert a .plist file into a binary effect file, the image is copied into the effect file if
+	// embedTexture is true or referenced by name; returns false on error.
+	// .plist files don't describe sprite sheets: the optional keys spriteSheetColumns, spriteSheetRows,
+	// spriteSheetFrames, spriteSheetFramesPerSecond and spriteSheetStartFrame are used if present
+	bool Convert( const char *plistFilename, const char *effectFilename, bool embedTexture );
+
+	// create a system with the configuration and texture of an effect, the system is started;
+	// returns NULL if the effect is not loaded
+	ParticleSystem* CreateSystem( unsigned int id, unsigned int tag, unsigned int zOrder );
+
+	// unload all effects and their textures, including the textures of the effects replaced by a new load
+	// (systems using them must be deleted before)
+	void Unload();
+};
+
+#endif
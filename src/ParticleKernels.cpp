@@ -0,0 +1,493 @@
+/*
+ 	The information contained herein is confidential.
+ 	The use, copying, transfer or disclosure of such information is proibited
+ 	except by press written agreement with the author
+*/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include "ParticleKernels.h"
+
+#ifdef PARTICLEKERNELS_USE_SSE
+#include <emmintrin.h>
+#endif
+
+// minimum squared distance from the emitter to calculate radial and tangential acceleration
+#define PARTICLEKERNELS_MIN_SQUARED_DISTANCE	1e-10f
+
+// SIMD kernels enabled
+static bool useSIMD = true;
+
+// ====================================== memory ======================================
+
+// set pointers of all streams given the aligned memory and the capacity
+static void SetStreams( ParticleStreams_t *streams, float *base, unsigned int capacity )
+{
+	float **fields[ PARTICLEKERNELS_TOTAL_STREAMS ] = {
+		&streams->posX, &streams->posY, &streams->startPosX, &streams->startPosY,
+		&streams->colorR, &streams->colorG, &streams->colorB, &streams->colorA,
+		&streams->deltaColorR, &streams->deltaColorG, &streams->deltaColorB, &streams->deltaColorA,
+		&streams->size, &streams->deltaSize, &streams->rotation, &streams->deltaRotation,
+		&streams->timeToLive,
+		&streams->dirX, &streams->dirY, &streams->radialAccel, &streams->tangentialAccel,
+		&streams->angle, &streams->degreesPerSecond, &streams->radius, &streams->deltaRadius,
+		&streams->frame
+	};
+	for( int i = 0; i < PARTICLEKERNELS_TOTAL_STREAMS; i++ ) {
+		*fields[ i ] = base + i * capacity;
+	}
+	streams->capacity		= capacity;
+}
+
+bool ParticleKernels::Allocate( ParticleStreams_t *streams, unsigned int capacity )
+{
+	memset( streams, 0, sizeof( ParticleStreams_t ) );
+	// round the capacity so every stream is a whole number of SIMD registers
+	capacity = ( capacity + PARTICLEKERNELS_LANES - 1 ) & ~( PARTICLEKERNELS_LANES - 1 );
+	if( capacity == 0 ) {
+		return true;
+	}
+	size_t bytes = capacity * sizeof( float ) * PARTICLEKERNELS_TOTAL_STREAMS;
+	streams->memory = calloc( 1, bytes + PARTICLEKERNELS_ALIGNMENT );
+	if( streams->memory == NULL ) {
+		printf( "ParticleKernels::Allocate: unable to allocate %u particles\n", capacity );
+		return false;
+	}
+	size_t aligned = ( (size_t)streams->memory + PARTICLEKERNELS_ALIGNMENT - 1 ) & ~( (size_t)PARTICLEKERNELS_ALIGNMENT - 1 );
+	SetStreams( streams, (float*)aligned, capacity );
+	return true;
+}
+
+void ParticleKernels::Free( ParticleStreams_t *streams )
+{
+	free( streams->memory );
+	memset( streams, 0, sizeof( ParticleStreams_t ) );
+}
+
+bool ParticleKernels::Resize( ParticleStreams_t *streams, unsigned int capacity, unsigned int count )
+{
+	ParticleStreams_t resized;
+	if( !Allocate( &resized, capacity ) ) {
+		return false;
+	}
+	Copy( &resized, streams, count );
+	Free( streams );
+	*streams = resized;
+	return true;
+}
+
+void ParticleKernels::Copy( ParticleStreams_t *dst, const ParticleStreams_t *src, unsigned int count )
+{
+	count = ( count < dst->capacity ? count : dst->capacity );
+	count = ( count < src->capacity ? count : src->capacity );
+	if( count == 0 ) {
+		return;
+	}
+	// each attribute is a single block of memory
+	for( int i = 0; i < PARTICLEKERNELS_TOTAL_STREAMS; i++ ) {
+		memcpy( dst->posX + i * dst->capacity, src->posX + i * src->capacity, count * sizeof( float ) );
+	}
+}
+
+void ParticleKernels::Reset( ParticleStreams_t *streams, unsigned int start, unsigned int end )
+{
+	if( end <= start ) {
+		return;
+	}
+	// streams are contiguous: each attribute of the range is a single block of memory
+	for( int i = 0; i < PARTICLEKERNELS_TOTAL_STREAMS; i++ ) {
+		memset( streams->posX + i * streams->capacity + start, 0, ( end - start ) * sizeof( float ) );
+	}
+}
+
+void ParticleKernels::Move( ParticleStreams_t *streams, unsigned int dst, unsigned int src )
+{
+	// copy as integers: copying as floats could change denormal values
+	Uint32 *base = (Uint32*)streams->posX;
+	for( int i = 0; i < PARTICLEKERNELS_TOTAL_STREAMS; i++ ) {
+		base[ dst ] = base[ src ];
+		base += streams->capacity;
+	}
+}
+
+// ====================================== scalar kernels ======================================
+
+static void LifeScalar( float *timeToLive, unsigned int start, unsigned int end, float deltaTime )
+{
+	for( unsigned int i = start; i < end; i++ ) {
+		timeToLive[ i ] -= deltaTime;
+	}
+}
+
+static void GravityScalar( ParticleStreams_t *p, unsigned int start, unsigned int end, float gravityX, float gravityY, float yFlip, float deltaTime )
+{
+	for( unsigned int i = start; i < end; i++ ) {
+		// direction from the emitter (zero if the particle is on the emitter)
+		float normalX = 0;
+		float normalY = 0;
+		float n = p->posX[ i ] * p->posX[ i ] + p->posY[ i ] * p->posY[ i ];
+		if( n >= PARTICLEKERNELS_MIN_SQUARED_DISTANCE ) {
+			n = 1.0f / sqrtf( n );
+			normalX = p->posX[ i ] * n;
+			normalY = p->posY[ i ] * n;
+		}
+		// (gravity + radial + tangential) * deltaTime
+		float accelX = normalX * p->radialAccel[ i ] - normalY * p->tangentialAccel[ i ] + gravityX;
+		float accelY = normalY * p->radialAccel[ i ] + normalX * p->tangentialAccel[ i ] + gravityY;
+		p->dirX[ i ] += accelX * deltaTime;
+		p->dirY[ i ] += accelY * deltaTime;
+		// move
+		p->posX[ i ] += p->dirX[ i ] * deltaTime * yFlip;
+		p->posY[ i ] += p->dirY[ i ] * deltaTime * yFlip;
+	}
+}
+
+static void RadiusScalar( ParticleStreams_t *p, unsigned int start, unsigned int end, float yFlip, float deltaTime )
+{
+	for( unsigned int i = start; i < end; i++ ) {
+		p->angle[ i ]	+= p->degreesPerSecond[ i ] * deltaTime;
+		p->radius[ i ]	+= p->deltaRadius[ i ] * deltaTime;
+		p->posX[ i ]	= -cosf( p->angle[ i ] ) * p->radius[ i ];
+		p->posY[ i ]	= -sinf( p->angle[ i ] ) * p->radius[ i ] * yFlip;
+	}
+}
+
+static void AppearanceScalar( ParticleStreams_t *p, unsigned int start, unsigned int end, float framesPerSecond, float deltaTime )
+{
+	float frames = framesPerSecond * deltaTime;
+	for( unsigned int i = start; i < end; i++ ) {
+		p->colorR[ i ]		+= p->deltaColorR[ i ] * deltaTime;
+		p->colorG[ i ]		+= p->deltaColorG[ i ] * deltaTime;
+		p->colorB[ i ]		+= p->deltaColorB[ i ] * deltaTime;
+		p->colorA[ i ]		+= p->deltaColorA[ i ] * deltaTime;
+		p->size[ i ]		+= p->deltaSize[ i ] * deltaTime;
+		p->size[ i ]		= ( p->size[ i ] > 0.0f ? p->size[ i ] : 0.0f );
+		p->rotation[ i ]	+= p->deltaRotation[ i ] * deltaTime;
+		p->frame[ i ]		+= frames;
+	}
+}
+
+// ====================================== SSE kernels ======================================
+
+#ifdef PARTICLEKERNELS_USE_SSE
+
+// first index of the range aligned to the SIMD registers
+static inline unsigned int AlignedStart( unsigned int start, unsigned int end )
+{
+	unsigned int aligned = ( start + PARTICLEKERNELS_LANES - 1 ) & ~( PARTICLEKERNELS_LANES - 1 );
+	return ( aligned < end ? aligned : end );
+}
+
+// last index of the range (excluded) processed by the SIMD registers
+static inline unsigned int AlignedEnd( unsigned int start, unsigned int end )
+{
+	return start + ( ( end - start ) & ~( PARTICLEKERNELS_LANES - 1 ) );
+}
+
+// sine and cosine of 4 angles (radians): the angle is reduced to [-pi/4, pi/4] and the quadrant selects
+// and changes sign of the two polynomials (max error ~1e-7 for angles up to a few thousand radians)
+static inline void SinCos4( __m128 x, __m128 *sine, __m128 *cosine )
+{
+	// quadrant = round( x / (pi/2) )
+	__m128i quadrant	= _mm_cvtps_epi32( _mm_mul_ps( x, _mm_set1_ps( 0.63661977236f ) ) );
+	__m128 k			= _mm_cvtepi32_ps( quadrant );
+	// x - k * pi/2 (pi/2 is split in three parts to keep precision)
+	x = _mm_sub_ps( x, _mm_mul_ps( k, _mm_set1_ps( 1.5703125f ) ) );
+	x = _mm_sub_ps( x, _mm_mul_ps( k, _mm_set1_ps( 4.837512969970703125e-4f ) ) );
+	x = _mm_sub_ps( x, _mm_mul_ps( k, _mm_set1_ps( 7.549789954891882e-8f ) ) );
+	__m128 x2 = _mm_mul_ps( x, x );
+	// sine polynomial
+	__m128 s = _mm_add_ps( _mm_mul_ps( _mm_set1_ps( -1.9515295891e-4f ), x2 ), _mm_set1_ps( 8.3321608736e-3f ) );
+	s = _mm_add_ps( _mm_mul_ps( s, x2 ), _mm_set1_ps( -1.6666654611e-1f ) );
+	s = _mm_add_ps( _mm_mul_ps( _mm_mul_ps( s, x2 ), x ), x );
+	// cosine polynomial
+	__m128 c = _mm_add_ps( _mm_mul_ps( _mm_set1_ps( 2.443315711809948e-5f ), x2 ), _mm_set1_ps( -1.388731625493765e-3f ) );
+	c = _mm_add_ps( _mm_mul_ps( c, x2 ), _mm_set1_ps( 4.166664568298827e-2f ) );
+	c = _mm_add_ps( _mm_mul_ps( _mm_mul_ps( c, x2 ), x2 ), _mm_sub_ps( _mm_set1_ps( 1.0f ), _mm_mul_ps( x2, _mm_set1_ps( 0.5f ) ) ) );
+	// odd quadrants swap sine and cosine
+	__m128 swap = _mm_castsi128_ps( _mm_cmpeq_epi32( _mm_and_si128( quadrant, _mm_set1_epi32( 1 ) ), _mm_set1_epi32( 1 ) ) );
+	__m128 resultSin = _mm_or_ps( _mm_and_ps( swap, c ), _mm_andnot_ps( swap, s ) );
+	__m128 resultCos = _mm_or_ps( _mm_and_ps( swap, s ), _mm_andnot_ps( swap, c ) );
+	// sine is negative in quadrants 2 and 3, cosine in quadrants 1 and 2
+	__m128 signSin = _mm_castsi128_ps( _mm_slli_epi32( _mm_and_si128( quadrant, _mm_set1_epi32( 2 ) ), 30 ) );
+	__m128 signCos = _mm_castsi128_ps( _mm_slli_epi32( _mm_and_si128( _mm_add_epi32( quadrant, _mm_set1_epi32( 1 ) ), _mm_set1_epi32( 2 ) ), 30 ) );
+	*sine	= _mm_xor_ps( resultSin, signSin );
+	*cosine	= _mm_xor_ps( resultCos, signCos );
+}
+
+static void LifeSSE( float *timeToLive, unsigned int start, unsigned int end, float deltaTime )
+{
+	unsigned int alignedStart	= AlignedStart( start, end );
+	unsigned int alignedEnd		= AlignedEnd( alignedStart, end );
+	LifeScalar( timeToLive, start, alignedStart, deltaTime );
+	__m128 dt = _mm_set1_ps( deltaTime );
+	for( unsigned int i = alignedStart; i < alignedEnd; i += PARTICLEKERNELS_LANES ) {
+		_mm_store_ps( timeToLive + i, _mm_sub_ps( _mm_load_ps( timeToLive + i ), dt ) );
+	}
+	LifeScalar( timeToLive, alignedEnd, end, deltaTime );
+}
+
+static void GravitySSE( ParticleStreams_t *p, unsigned int start, unsigned int end, float gravityX, float gravityY, float yFlip, float deltaTime )
+{
+	unsigned int alignedStart	= AlignedStart( start, end );
+	unsigned int alignedEnd		= AlignedEnd( alignedStart, end );
+	GravityScalar( p, start, alignedStart, gravityX, gravityY, yFlip, deltaTime );
+	__m128 dt		= _mm_set1_ps( deltaTime );
+	__m128 dtFlip	= _mm_set1_ps( deltaTime * yFlip );
+	__m128 gx		= _mm_set1_ps( gravityX );
+	__m128 gy		= _mm_set1_ps( gravityY );
+	__m128 one		= _mm_set1_ps( 1.0f );
+	__m128 minimum	= _mm_set1_ps( PARTICLEKERNELS_MIN_SQUARED_DISTANCE );
+	for( unsigned int i = alignedStart; i < alignedEnd; i += PARTICLEKERNELS_LANES ) {
+		__m128 x = _mm_load_ps( p->posX + i );
+		__m128 y = _mm_load_ps( p->posY + i );
+		// direction from the emitter (zero if the particle is on the emitter)
+		__m128 n = _mm_add_ps( _mm_mul_ps( x, x ), _mm_mul_ps( y, y ) );
+		__m128 inverse = _mm_and_ps( _mm_div_ps( one, _mm_sqrt_ps( n ) ), _mm_cmpge_ps( n, minimum ) );
+		__m128 normalX = _mm_mul_ps( x, inverse );
+		__m128 normalY = _mm_mul_ps( y, inverse );
+		// (gravity + radial + tangential) * deltaTime
+		__m128 radial		= _mm_load_ps( p->radialAccel + i );
+		__m128 tangential	= _mm_load_ps( p->tangentialAccel + i );
+		__m128 accelX = _mm_add_ps( _mm_sub_ps( _mm_mul_ps( normalX, radial ), _mm_mul_ps( normalY, tangential ) ), gx );
+		__m128 accelY = _mm_add_ps( _mm_add_ps( _mm_mul_ps( normalY, radial ), _mm_mul_ps( normalX, tangential ) ), gy );
+		__m128 dirX = _mm_add_ps( _mm_load_ps( p->dirX + i ), _mm_mul_ps( accelX, dt ) );
+		__m128 dirY = _mm_add_ps( _mm_load_ps( p->dirY + i ), _mm_mul_ps( accelY, dt ) );
+		_mm_store_ps( p->dirX + i, dirX );
+		_mm_store_ps( p->dirY + i, dirY );
+		// move
+		_mm_store_ps( p->posX + i, _mm_add_ps( x, _mm_mul_ps( dirX, dtFlip ) ) );
+		_mm_store_ps( p->posY + i, _mm_add_ps( y, _mm_mul_ps( dirY, dtFlip ) ) );
+	}
+	GravityScalar( p, alignedEnd, end, gravityX, gravityY, yFlip, deltaTime );
+}
+
+static void RadiusSSE( ParticleStreams_t *p, unsigned int start, unsigned int end, float yFlip, float deltaTime )
+{
+	unsigned int alignedStart	= AlignedStart( start, end );
+	unsigned int alignedEnd		= AlignedEnd( alignedStart, end );
+	RadiusScalar( p, start, alignedStart, yFlip, deltaTime );
+	__m128 dt			= _mm_set1_ps( deltaTime );
+	__m128 minusOne		= _mm_set1_ps( -1.0f );
+	__m128 minusFlip	= _mm_set1_ps( -yFlip );
+	for( unsigned int i = alignedStart; i < alignedEnd; i += PARTICLEKERNELS_LANES ) {
+		__m128 angle	= _mm_add_ps( _mm_load_ps( p->angle + i ), _mm_mul_ps( _mm_load_ps( p->degreesPerSecond + i ), dt ) );
+		__m128 radius	= _mm_add_ps( _mm_load_ps( p->radius + i ), _mm_mul_ps( _mm_load_ps( p->deltaRadius + i ), dt ) );
+		_mm_store_ps( p->angle + i, angle );
+		_mm_store_ps( p->radius + i, radius );
+		__m128 sine, cosine;
+		SinCos4( angle, &sine, &cosine );
+		_mm_store_ps( p->posX + i, _mm_mul_ps( _mm_mul_ps( cosine, radius ), minusOne ) );
+		_mm_store_ps( p->posY + i, _mm_mul_ps( _mm_mul_ps( sine, radius ), minusFlip ) );
+	}
+	RadiusScalar( p, alignedEnd, end, yFlip, deltaTime );
+}
+
+// value += delta * deltaTime for 4 particles
+#define PARTICLEKERNELS_ADD_DELTA( value, delta )	\
+	_mm_store_ps( p->value + i, _mm_add_ps( _mm_load_ps( p->value + i ), _mm_mul_ps( _mm_load_ps( p->delta + i ), dt ) ) )
+
+static void AppearanceSSE( ParticleStreams_t *p, unsigned int start, unsigned int end, float framesPerSecond, float deltaTime )
+{
+	unsigned int alignedStart	= AlignedStart( start, end );
+	unsigned int alignedEnd		= AlignedEnd( alignedStart, end );
+	AppearanceScalar( p, start, alignedStart, framesPerSecond, deltaTime );
+	__m128 dt		= _mm_set1_ps( deltaTime );
+	__m128 zero		= _mm_setzero_ps();
+	__m128 frames	= _mm_set1_ps( framesPerSecond * deltaTime );
+	for( unsigned int i = alignedStart; i < alignedEnd; i += PARTICLEKERNELS_LANES ) {
+		PARTICLEKERNELS_ADD_DELTA( colorR, deltaColorR );
+		PARTICLEKERNELS_ADD_DELTA( colorG, deltaColorG );
+		PARTICLEKERNELS_ADD_DELTA( colorB, deltaColorB );
+		PARTICLEKERNELS_ADD_DELTA( colorA, deltaColorA );
+		PARTICLEKERNELS_ADD_DELTA( rotation, deltaRotation );
+		__m128 size = _mm_add_ps( _mm_load_ps( p->size + i ), _mm_mul_ps( _mm_load_ps( p->deltaSize + i ), dt ) );
+		_mm_store_ps( p->size + i, _mm_max_ps( size, zero ) );
+		_mm_store_ps( p->frame + i, _mm_add_ps( _mm_load_ps( p->frame + i ), frames ) );
+	}
+	AppearanceScalar( p, alignedEnd, end, framesPerSecond, deltaTime );
+}
+
+#endif
+
+// ====================================== passes ======================================
+
+unsigned int ParticleKernels::UpdateLife( ParticleStreams_t *streams, unsigned int count, float deltaTime )
+{
+#ifdef PARTICLEKERNELS_USE_SSE
+	if( useSIMD ) {
+		LifeSSE( streams->timeToLive, 0, count, deltaTime );
+	} else {
+		LifeScalar( streams->timeToLive, 0, count, deltaTime );
+	}
+#else
+	LifeScalar( streams->timeToLive, 0, count, deltaTime );
+#endif
+	// remove dead particles moving the last one in their place (the moved particle is checked too)
+	unsigned int i = 0;
+	while( i < count ) {
+		if( streams->timeToLive[ i ] <= 0.0f ) {
+			count -= 1;
+			if( i != count ) {
+				Move( streams, i, count );
+			}
+		} else {
+			i += 1;
+		}
+	}
+	return count;
+}
+
+void ParticleKernels::UpdateGravity( ParticleStreams_t *streams, unsigned int start, unsigned int end, float gravityX, float gravityY, float yFlip, float deltaTime )
+{
+#ifdef PARTICLEKERNELS_USE_SSE
+	if( useSIMD ) {
+		GravitySSE( streams, start, end, gravityX, gravityY, yFlip, deltaTime );
+		return;
+	}
+#endif
+	GravityScalar( streams, start, end, gravityX, gravityY, yFlip, deltaTime );
+}
+
+void ParticleKernels::UpdateRadius( ParticleStreams_t *streams, unsigned int start, unsigned int end, float yFlip, float deltaTime )
+{
+#ifdef PARTICLEKERNELS_USE_SSE
+	if( useSIMD ) {
+		RadiusSSE( streams, start, end, yFlip, deltaTime );
+		return;
+	}
+#endif
+	RadiusScalar( streams, start, end, yFlip, deltaTime );
+}
+
+void ParticleKernels::UpdateAppearance( ParticleStreams_t *streams, unsigned int start, unsigned int end, float framesPerSecond, float deltaTime )
+{
+#ifdef PARTICLEKERNELS_USE_SSE
+	if( useSIMD ) {
+		AppearanceSSE( streams, start, end, framesPerSecond, deltaTime );
+		return;
+	}
+#endif
+	AppearanceScalar( streams, start, end, framesPerSecond, deltaTime );
+}
+
+void ParticleKernels::SetSIMD( bool state )
+{
+	useSIMD = state;
+}
+
+bool ParticleKernels::IsSIMD()
+{
+#ifdef PARTICLEKERNELS_USE_SSE
+	return useSIMD;
+#else
+	return false;
+#endif
+}
+
+// ====================================== benchmark ======================================
+
+// fill streams with the same pseudo random particles
+static void BenchmarkFill( ParticleStreams_t *p, unsigned int count )
+{
+	unsigned int seed = 12345;
+	for( unsigned int i = 0; i < count; i++ ) {
+		float values[ 16 ];
+		for( int j = 0; j < 16; j++ ) {
+			seed = seed * 134775813 + 1;
+			values[ j ] = (float)( ( seed >> 8 ) & 0xffff ) / 65535.0f * 2.0f - 1.0f;
+		}
+		p->posX[ i ]			= values[ 0 ] * 100;
+		p->posY[ i ]			= values[ 1 ] * 100;
+		p->dirX[ i ]			= values[ 2 ] * 50;
+		p->dirY[ i ]			= values[ 3 ] * 50;
+		p->radialAccel[ i ]		= values[ 4 ] * 20;
+		p->tangentialAccel[ i ]	= values[ 5 ] * 20;
+		p->angle[ i ]			= values[ 6 ] * 3.14159f;
+		p->degreesPerSecond[ i ]	= values[ 7 ] * 6;
+		p->radius[ i ]			= 50 + values[ 8 ] * 50;
+		p->deltaRadius[ i ]		= values[ 9 ] * 10;
+		p->colorR[ i ]			= 0.5f + values[ 10 ] * 0.5f;
+		p->deltaColorR[ i ]		= values[ 11 ] * 0.1f;
+		p->colorA[ i ]			= 1.0f;
+		p->deltaColorA[ i ]		= -0.05f;
+		p->size[ i ]			= 32 + values[ 12 ] * 16;
+		p->deltaSize[ i ]		= values[ 13 ] * 8;
+		p->rotation[ i ]		= values[ 14 ] * 180;
+		p->deltaRotation[ i ]	= values[ 15 ] * 90;
+		p->timeToLive[ i ]		= 1000000.0f;
+	}
+}
+
+// run frames of a system in gravity or radius mode, returns the elapsed time (milliseconds)
+static double BenchmarkRun( ParticleStreams_t *p, unsigned int count, bool gravity, int frames )
+{
+	const float deltaTime = 1.0f / 60.0f;
+	Uint64 start = SDL_GetPerformanceCounter();
+	for( int frame = 0; frame < frames; frame++ ) {
+		count = ParticleKernels::UpdateLife( p, count, deltaTime );
+		if( gravity ) {
+			ParticleKernels::UpdateGravity( p, 0, count, 0, 10, 1, deltaTime );
+		} else {
+			ParticleKernels::UpdateRadius( p, 0, count, 1, deltaTime );
+		}
+		ParticleKernels::UpdateAppearance( p, 0, count, 30, deltaTime );
+	}
+	return (double)( SDL_GetPerformanceCounter() - start ) * 1000 / (double)SDL_GetPerformanceFrequency();
+}
+
+// max difference (relative to the magnitude of the value) of a stream
+static float BenchmarkDifference( const float *a, const float *b, unsigned int count )
+{
+	float result = 0;
+	for( unsigned int i = 0; i < count; i++ ) {
+		float magnitude	= ( fabsf( a[ i ] ) > 1.0f ? fabsf( a[ i ] ) : 1.0f );
+		float difference	= fabsf( a[ i ] - b[ i ] ) / magnitude;
+		result = ( difference > result ? difference : result );
+	}
+	return result;
+}
+
+void ParticleKernels::Benchmark()
+{
+	const unsigned int sizes[ 3 ] = { 1000, 10000, 100000 };
+	bool previousSIMD = useSIMD;
+
+#ifndef PARTICLEKERNELS_USE_SSE
+	printf( "ParticleKernels::Benchmark: SIMD kernels not compiled, scalar kernels only\n" );
+#endif
+	for( int s = 0; s < 3; s++ ) {
+		unsigned int count = sizes[ s ];
+		// about 10 millions of particle updates for each measure
+		int frames = 10000000 / count;
+		for( int mode = 0; mode < 2; mode++ ) {
+			ParticleStreams_t scalar, simd;
+			if( !Allocate( &scalar, count ) || !Allocate( &simd, count ) ) {
+				Free( &scalar );
+				// previous measures changed the kernels in use
+				useSIMD = previousSIMD;
+				return;
+			}
+			BenchmarkFill( &scalar, count );
+			BenchmarkFill( &simd, count );
+			useSIMD = false;
+			double scalarTime	= BenchmarkRun( &scalar, count, mode == 0, frames );
+			useSIMD = true;
+			double simdTime		= BenchmarkRun( &simd, count, mode == 0, frames );
+			// results must be the same within float tolerance (sum of the max differences of the main attributes)
+			float difference = 0;
+			difference += BenchmarkDifference( scalar.posX, simd.posX, count );
+			difference += BenchmarkDifference( scalar.posY, simd.posY, count );
+			difference += BenchmarkDifference( scalar.size, simd.size, count );
+			difference += BenchmarkDifference( scalar.colorR, simd.colorR, count );
+			printf( "ParticleKernels::Benchmark: %6u particles, %s mode: scalar %9.0f particles/ms, SIMD %9.0f particles/ms, max difference %g\n",
+				count, ( mode == 0 ? "gravity" : "radius " ),
+				(double)count * frames / scalarTime, (double)count * frames / simdTime, difference );
+			Free( &scalar );
+			Free( &simd );
+		}
+	}
+	useSIMD = previousSIMD;
+}
@@ -0,0 +1,119 @@
+/*
+ 	The information contained herein is confidential.
+ 	The use, copying, transfer or disclosure of such information is proibited
+ 	except by press written agreement with the author
+*/
+
+#ifndef _PARTICLEKERNELS_H_INCLUDE
+#define _PARTICLEKERNELS_H_INCLUDE
+
+#include <SDL.h>
+
+// SSE kernels are compiled when the target has SSE2 (x64, /arch:SSE2 on x86), define PARTICLEKERNELS_NO_SIMD
+// to force the scalar code
+#if !defined( PARTICLEKERNELS_NO_SIMD ) && ( defined( _M_X64 ) || ( defined( _M_IX86_FP ) && ( _M_IX86_FP >= 2 ) ) || defined( __SSE2__ ) )
+#define PARTICLEKERNELS_USE_SSE
+#endif
+
+// number of particles processed by a single SIMD instruction, streams are sized and aligned to this
+#define PARTICLEKERNELS_LANES			4
+// alignment (bytes) of the streams
+#define PARTICLEKERNELS_ALIGNMENT		16
+
+/*
+	Particle data stored as structure of arrays: each attribute is a contiguous, aligned array (stream) of
+	"capacity" values, so the update passes read and write only the attributes they need and process
+	PARTICLEKERNELS_LANES particles per instruction.
+	All streams live in a single memory block, one after the other, in the order they are declared here.
+*/
+typedef struct {
+	// position relative to the emitter and position of the emitter at birth
+	float		*posX;
+	float		*posY;
+	float		*startPosX;
+	float		*startPosY;
+	// color (0.0 ... 1.0) and its change per second
+	float		*colorR;
+	float		*colorG;
+	float		*colorB;
+	float		*colorA;
+	float		*deltaColorR;
+	float		*deltaColorG;
+	float		*deltaColorB;
+	float		*deltaColorA;
+	// size (pixels), rotation (degrees) and their change per second
+	float		*size;
+	float		*deltaSize;
+	float		*rotation;
+	float		*deltaRotation;
+	// remaining life (seconds)
+	float		*timeToLive;
+	// gravity mode: direction (speed vector), radial and tangential acceleration
+	float		*dirX;
+	float		*dirY;
+	float		*radialAccel;
+	float		*tangentialAccel;
+	// radius mode: angle (radians), rotation per second (radians), radius and its change per second
+	float		*angle;
+	float		*degreesPerSecond;
+	float		*radius;
+	float		*deltaRadius;
+	// animation frame (frames elapsed since the first one, the integer part selects the frame to draw)
+	float		*frame;
+
+	// number of particles each stream can contain (multiple of PARTICLEKERNELS_LANES)
+	unsigned int	capacity;
+	// memory block containing all streams (not aligned)
+	void			*memory;
+} ParticleStreams_t;
+
+/*
+	Update passes of the particle systems, written both as SSE kernels and as plain scalar code.
+	All passes work on a range [start, end) of particles so a system can be processed in pieces.
+*/
+namespace ParticleKernels {
+
+	// number of streams of ParticleStreams_t
+	#define PARTICLEKERNELS_TOTAL_STREAMS	26
+
+	// allocate streams for a number of particles (all values are zero)
+	bool Allocate( ParticleStreams_t *streams, unsigned int capacity );
+
+	// free streams
+	void Free( ParticleStreams_t *streams );
+
+	// change capacity of streams keeping the first "count" particles
+	bool Resize( ParticleStreams_t *streams, unsigned int capacity, unsigned int count );
+
+	// copy all attributes of the first "count" particles (streams may have different capacity)
+	void Copy( ParticleStreams_t *dst, const ParticleStreams_t *src, unsigned int count );
+
+	// set to zero all attributes of particles in the range
+	void Reset( ParticleStreams_t *streams, unsigned int start, unsigned int end );
+
+	// copy all attributes of a particle into another
+	void Move( ParticleStreams_t *streams, unsigned int dst, unsigned int src );
+
+	// decrement the life of all particles and remove dead particles (the last particle takes the place of the
+	// dead one), returns the number of particles still alive
+	unsigned int UpdateLife( ParticleStreams_t *streams, unsigned int count, float deltaTime );
+
+	// gravity mode: apply gravity, radial and tangential acceleration and move particles
+	void UpdateGravity( ParticleStreams_t *streams, unsigned int start, unsigned int end, float gravityX, float gravityY, float yFlip, float deltaTime );
+
+	// radius mode: rotate particles around the emitter
+	void UpdateRadius( ParticleStreams_t *streams, unsigned int start, unsigned int end, float yFlip, float deltaTime );
+
+	// change color, size, rotation and animation frame
+	void UpdateAppearance( ParticleStreams_t *streams, unsigned int start, unsigned int end, float framesPerSecond, float deltaTime );
+
+	// enable or disable SIMD kernels (used to compare results and speed, enabled by default if available)
+	void SetSIMD( bool state );
+	bool IsSIMD();
+
+	// measure the speed (particles per millisecond) of the update passes with 1k, 10k and 100k particles
+	// using scalar and SIMD kernels, and the difference between the results of the two, the result is printed
+	void Benchmark();
+}
+
+#endif
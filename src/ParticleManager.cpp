@@ -0,0 +1,188 @@
+/*
+ 	The information contained herein is confidential.
+ 	The use, copying, transfer or disclosure of such information is proibited
+ 	except by press written agreement with the author
+*/
+
+#include <stdio.h>
+#include <vector>
+#include "ParticleManager.h"
+#include "ParticleSystem.h"
+#include "ThreadPool.h"
+#include "Clock.h"
+
+// all existing systems
+static std::vector<ParticleSystem*>	systems;
+
+// systems simulated in the current frame (the first totalUpdated items)
+static std::vector<ParticleSystem*>	updatedSystems;
+static int					totalUpdated = 0;
+
+// attributes of the systems used to share the budget (kept to avoid allocations each frame)
+static std::vector<float>	budgetData;
+
+// budget (0 = no limit)
+static int					budgetParticles	= 0;
+static float				budgetFillArea	= 0;
+// time elapsed from previous frame (seconds)
+static float				frameTime = 0;
+
+// task of the thread pool: simulate a system
+static void UpdateSystem( void *, int index )
+{
+	updatedSystems[ index ]->Update( frameTime );
+}
+
+// returns true if the node and all its parents are visible
+static bool IsDrawn( Node *node )
+{
+	while( node != NULL ) {
+		if( !node->IsVisible() ) {
+			return false;
+		}
+		node = node->GetParent();
+	}
+	return true;
+}
+
+// share a budget among the systems: system i gets demand[ i ] * scale[ i ] where scale[ i ] = min( 1, k * priority[ i ] )
+// and k is the largest value keeping the total within the budget
+static void ShareBudget( const float *demand, const float *priority, int total, float budget, float *scale )
+{
+	float totalDemand = 0;
+	float minPriority = 0;
+	for( int i = 0; i < total; i++ ) {
+		scale[ i ] = 1;
+		totalDemand += demand[ i ];
+		if( ( priority[ i ] > 0 ) && ( ( minPriority == 0 ) || ( priority[ i ] < minPriority ) ) ) {
+			minPriority = priority[ i ];
+		}
+	}
+	if( ( budget <= 0 ) || ( totalDemand <= budget ) ) {
+		return;
+	}
+	// with k = 1 / minPriority all systems (with priority > 0) get the full demand: search k by bisection
+	float low	= 0;
+	float high	= ( minPriority > 0 ? 1.0f / minPriority : 0 );
+	for( int iteration = 0; iteration < 32; iteration++ ) {
+		float k = ( low + high ) / 2;
+		float granted = 0;
+		for( int i = 0; i < total; i++ ) {
+			float s = k * priority[ i ];
+			granted += demand[ i ] * ( s < 1 ? s : 1 );
+		}
+		if( granted > budget ) {
+			high = k;
+		} else {
+			low = k;
+		}
+	}
+	for( int i = 0; i < total; i++ ) {
+		float s = low * priority[ i ];
+		scale[ i ] = ( s < 1 ? s : 1 );
+	}
+}
+
+// set the budget scale of the systems simulated in this frame
+static void ApplyBudget()
+{
+	if( totalUpdated == 0 ) {
+		return;
+	}
+	budgetData.resize( totalUpdated * 6 );
+	float *priority			= &budgetData[ 0 ];
+	float *particles		= priority + totalUpdated;
+	float *fillArea			= particles + totalUpdated;
+	float *particlesScale	= fillArea + totalUpdated;
+	float *fillAreaScale	= particlesScale + totalUpdated;
+	float *fillPriority		= fillAreaScale + totalUpdated;
+	float averageArea = 0;
+	for( int i = 0; i < totalUpdated; i++ ) {
+		priority[ i ]	= updatedSystems[ i ]->GetPriority();
+		particles[ i ]	= (float)updatedSystems[ i ]->GetTotalParticles();
+		fillArea[ i ]	= updatedSystems[ i ]->GetFillArea();
+		averageArea		+= ( particles[ i ] > 0 ? fillArea[ i ] / particles[ i ] : 0 ) / totalUpdated;
+	}
+	// systems whose particles cover more screen than the average lose more of the fill area budget
+	for( int i = 0; i < totalUpdated; i++ ) {
+		float area = ( particles[ i ] > 0 ? fillArea[ i ] / particles[ i ] : 0 );
+		fillPriority[ i ] = ( area > 0 ? priority[ i ] * averageArea / area : priority[ i ] );
+	}
+	// the most restrictive of the two limits is applied
+	ShareBudget( particles, priority, totalUpdated, (float)budgetParticles, particlesScale );
+	ShareBudget( fillArea, fillPriority, totalUpdated, budgetFillArea, fillAreaScale );
+	for( int i = 0; i < totalUpdated; i++ ) {
+		updatedSystems[ i ]->SetBudgetScale( particlesScale[ i ] < fillAreaScale[ i ] ? particlesScale[ i ] : fillAreaScale[ i ] );
+	}
+}
+
+void ParticleManager::Register( ParticleSystem *system )
+{
+	systems.push_back( system );
+}
+
+void ParticleManager::Unregister( ParticleSystem *system )
+{
+	for( size_t i = 0; i < systems.size(); i++ ) {
+		if( systems[ i ] == system ) {
+			systems[ i ] = systems.back();
+			systems.pop_back();
+			break;
+		}
+	}
+	// the system may have been simulated in the last frame
+	for( int i = 0; i < totalUpdated; i++ ) {
+		if( updatedSystems[ i ] == system ) {
+			updatedSystems[ i ] = updatedSystems[ totalUpdated - 1 ];
+			totalUpdated -= 1;
+			break;
+		}
+	}
+}
+
+void ParticleManager::SetBudget( int maxParticles, float maxFillArea )
+{
+	budgetParticles	= maxParticles;
+	budgetFillArea	= maxFillArea;
+}
+
+int ParticleManager::GetTotalParticles()
+{
+	int result = 0;
+	for( int i = 0; i < totalUpdated; i++ ) {
+		result += updatedSystems[ i ]->GetParticleCount();
+	}
+	return result;
+}
+
+void ParticleManager::PrintBudget()
+{
+	printf( "ParticleManager: budget %d particles, %.0f pixels - %d systems, %d particles alive\n", budgetParticles, budgetFillArea, totalUpdated, GetTotalParticles() );
+	for( int i = 0; i < totalUpdated; i++ ) {
+		ParticleSystem *system = updatedSystems[ i ];
+		printf( "  tag %5d  priority %5.2f  scale %4.2f  particles %6d / %6d (alive %6d)  fill area %9.0f / %9.0f\n",
+			system->GetTag(), system->GetPriority(), system->GetBudgetScale(), system->GetMaxParticles(), system->GetTotalParticles(),
+			system->GetParticleCount(), system->GetFillArea() * system->GetBudgetScale(), system->GetFillArea() );
+	}
+}
+
+void ParticleManager::Update( Scene *scene )
+{
+	totalUpdated = 0;
+	if( scene == NULL ) {
+		return;
+	}
+	// systems of the other scenes and hidden systems are frozen
+	updatedSystems.resize( systems.size() );
+	for( size_t i = 0; i < systems.size(); i++ ) {
+		if( ( Engine::GetNodeScene( systems[ i ] ) == scene ) && IsDrawn( systems[ i ] ) ) {
+			updatedSystems[ totalUpdated ] = systems[ i ];
+			totalUpdated += 1;
+		}
+	}
+	// share the budget among the visible systems
+	ApplyBudget();
+	// the time is read here: the clock must not be accessed by the worker threads
+	frameTime = (float)( Clock::GetSceneDeltaTime() / 1000 );
+	ThreadPool::ParallelFor( UpdateSystem, NULL, totalUpdated );
+}
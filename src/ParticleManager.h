@@ -0,0 +1,44 @@
+/*
+ 	The information contained herein is confidential.
+ 	The use, copying, transfer or disclosure of such information is proibited
+ 	except by press written agreement with the author
+*/
+
+#ifndef _PARTICLEMANAGER_H_INCLUDE
+#define _PARTICLEMANAGER_H_INCLUDE
+
+class ParticleSystem;
+class Scene;
+
+/*
+	ParticleManager simulates all particle systems before the scene is drawn (see Engine::DrawScene), so
+	ParticleSystem::Draw only draws the result of the simulation.
+	Visible systems of the current scene are simulated in parallel on the ThreadPool and large systems are
+	split into chunks of particles (see ParticleSystem::Simulate).
+	An optional budget limits the total number of particles and the screen area covered by particles: when
+	the systems of the scene need more, each one gets a part of its configuration (max particles and
+	emission rate) proportional to its priority, systems covering more screen area lose more particles.
+*/
+namespace ParticleManager {
+
+	// add a system to the list of simulated systems (called by the ParticleSystem constructor)
+	void Register( ParticleSystem *system );
+
+	// remove a system from the list (called by the ParticleSystem destructor)
+	void Unregister( ParticleSystem *system );
+
+	// set the budget of all visible systems: max number of particles and max area (pixels) covered by the
+	// particles in a frame (0 = no limit)
+	void SetBudget( int maxParticles, float maxFillArea );
+
+	// returns number of particles alive in the systems simulated in the last frame
+	int GetTotalParticles();
+
+	// print the budget granted to each system simulated in the last frame
+	void PrintBudget();
+
+	// simulate all visible systems of the scene, called by the engine each frame
+	void Update( Scene *scene );
+}
+
+#endif
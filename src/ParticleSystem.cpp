@@ -5,6 +5,10 @@
 */
 
 #include "ParticleSystem.h"
+#include "ParticleKernels.h"
+#include "ParticleManager.h"
+#include "ThreadPool.h"
+#include "Random.h"
 #include <algorithm>
 #include <assert.h>
 #include <string>
@@ -29,37 +33,13 @@ inline float clampf(float value, float min_inclusive, float max_inclusive)
     return value < min_inclusive ? min_inclusive : value < max_inclusive ? value : max_inclusive;
 }
 
-inline void normalize_point(float x, float y, Pointf* out)
-{
-    float n = x * x + y * y;
-    // Already normalized.
-    if (n == 1.0f) {
-        return;
-    }
-    n = sqrt(n);
-    // Too close to zero.
-    if (n < 1e-5) {
-        return;
-    }
-    n = 1.0f / n;
-    out->x = x * n;
-    out->y = y * n;
-}
-
-/**
-	A more effect random number getter function, get from ejoy2d.
-*/
-inline static float RANDOM_M11(unsigned int* seed)
-{
-    *seed = *seed * 134775813 + 1;
-    union
-    {
-        uint32_t d;
-        float f;
-    } u;
-    u.d = (((uint32_t)(*seed) & 0x7fff) << 8) | 0x40000000;
-    return u.f - 3.0f;
-}
+// a chunk of particles simulated by a task of the ThreadPool
+typedef struct {
+	ParticleSystem	*system;
+	int				start;
+	int				end;
+	float			deltaTime;
+} ParticleChunks_t;
 
 float Pointf::getAngle()
 {
@@ -71,39 +51,23 @@ void Pointf::reset()
 	x = 0, y = 0;
 }
 
-void ParticleData::reset()
-{
-    posx		= 0;
-    posy		= 0;
-	startPosX	= 0;
-	startPosY	= 0;
-
-    colorR		= 0;
-    colorG		= 0;
-    colorB		= 0;
-    colorA		= 0;
-
-    deltaColorR = 0;
-    deltaColorG = 0;
-    deltaColorB = 0;
-    deltaColorA = 0;
-
-    size		= 0;
-    deltaSize	= 0;
-    rotation	= 0;
-    deltaRotation	= 0;
-    timeToLive		= 0;
-	textureFrameId	= 0;
+// implementation ParticleSnapshot
 
-	modeA.dirX = 0;
-	modeA.dirY = 0;
-	modeA.radialAccel		= 0;
-	modeA.tangentialAccel	= 0;
+// the stream is set by CreateSnapshot, a default constructed one would take a stream id (see RandomStream)
+ParticleSnapshot::ParticleSnapshot() : random( 0, 0 )
+{
+	memset( &particles, 0, sizeof( ParticleStreams_t ) );
+	particleCount	= 0;
+	isActive		= false;
+	elapsed			= 0;
+	emitCounter		= 0;
+	x				= 0;
+	y				= 0;
+}
 
-	modeB.angle	= 0;
-	modeB.degreesPerSecond = 0;
-	modeB.radius = 0;
-	modeB.deltaRadius = 0;
+ParticleSnapshot::~ParticleSnapshot()
+{
+	ParticleKernels::Free( &particles );
 }
 
 // implementation ParticleSystem
@@ -128,6 +92,8 @@ ParticleSystem::ParticleSystem( unsigned int tag, unsigned int zOrder )
 	}
 	// start frame of particles in case of animation
 	_startFrameId	= 0;
+	_totalFrames		= 0;
+	_framesPerSecond	= PARTICLESYSTEM_FRAMES_PER_SECOND;
 
     // time elapsed since the start of the system (in seconds)
     _elapsed		= 0;
@@ -135,30 +101,101 @@ ParticleSystem::ParticleSystem( unsigned int tag, unsigned int zOrder )
     _emitCounter	= 0;
     // Quantity of particles that are being simulated at the moment 
     _particleCount	= 0;
-	// calculate theoretical elapsed time after each frame (40ms)
-	_deltaTime		= 1.0 / 25;
+	// elapsed time after each frame, it is read from the clock at each update
+	_deltaTime		= 0;
 	// reset rate (used internally)
 	_rate			= 0;
+	// full budget
+	_priority		= 1;
+	_budgetScale	= 1;
+	// simulation steps
+	_stepTime			= PARTICLESYSTEM_STEP_TIME;
+	_maxSteps			= PARTICLESYSTEM_MAX_STEPS;
+	_subFrameEmission	= false;
 
 	// reset copies data
 	_totalCopies				= 0;
 	memset( &_copies, 0, sizeof( Coord_t ) * PARTICLESYSTEM_MAX_COPIES );  
 
-    // reset particle data array
-	particle_data.clear();
+    // particle data streams are allocated by SetConfig
+	memset( &_particles, 0, sizeof( ParticleStreams_t ) );
+
+	// the system is simulated by the ParticleManager
+	ParticleManager::Register( this );
 }
 
 ParticleSystem::~ParticleSystem()
 {
+	ParticleManager::Unregister( this );
+	ParticleKernels::Free( &_particles );
 }
 
 void ParticleSystem::Start()
 {
     _isActive	= true;
     _elapsed	= 0;
-	for( unsigned int i = 0; i < particle_data.size(); i++ ) {
-		particle_data[ i ].reset();
+	ParticleKernels::Reset( &_particles, 0, _particles.capacity );
+}
+
+void ParticleSystem::Prewarm( float seconds )
+{
+	// particles emitted in the same (long) step are spread along their trajectories
+	bool subFrameEmission = _subFrameEmission;
+	_subFrameEmission = true;
+	while( seconds > 0 ) {
+		float stepTime = (std::min)( seconds, PARTICLESYSTEM_PREWARM_STEP_TIME );
+		Step( stepTime );
+		seconds -= stepTime;
+	}
+	_subFrameEmission = subFrameEmission;
+}
+
+ParticleSnapshot* ParticleSystem::CreateSnapshot()
+{
+	ParticleSnapshot *snapshot = new ParticleSnapshot();
+	if( !ParticleKernels::Allocate( &snapshot->particles, _particleCount ) ) {
+		delete snapshot;
+		return NULL;
+	}
+	ParticleKernels::Copy( &snapshot->particles, &_particles, _particleCount );
+	snapshot->particleCount	= _particleCount;
+	snapshot->isActive		= _isActive;
+	snapshot->elapsed		= _elapsed;
+	snapshot->emitCounter	= _emitCounter;
+	snapshot->random		= _random;
+	snapshot->x				= this->x;
+	snapshot->y				= this->y;
+	return snapshot;
+}
+
+bool ParticleSystem::RestoreSnapshot( ParticleSnapshot *snapshot )
+{
+	if( snapshot == NULL ) {
+		return false;
 	}
+	// the particles of the snapshot and the ones emitted later must fit
+	unsigned int capacity = (std::max)( (unsigned int)snapshot->particleCount, config.totalParticles );
+	if( _particles.capacity < capacity ) {
+		if( !ParticleKernels::Resize( &_particles, capacity, 0 ) ) {
+			return false;
+		}
+	}
+	ParticleKernels::Copy( &_particles, &snapshot->particles, snapshot->particleCount );
+	_particleCount	= snapshot->particleCount;
+	_isActive		= snapshot->isActive;
+	_elapsed		= snapshot->elapsed;
+	_emitCounter	= snapshot->emitCounter;
+	_random			= snapshot->random;
+	// particles are born at the position of the emitter: follow the emitter if it has been moved
+	float offsetX = this->x - snapshot->x;
+	float offsetY = this->y - snapshot->y;
+	if( ( offsetX != 0 ) || ( offsetY != 0 ) ) {
+		for( int i = 0; i < _particleCount; i++ ) {
+			_particles.startPosX[ i ] += offsetX;
+			_particles.startPosY[ i ] += offsetY;
+		}
+	}
+	return true;
 }
 
 void ParticleSystem::Stop()
@@ -168,109 +205,121 @@ void ParticleSystem::Stop()
     _emitCounter	= 0;
 }
 
-void ParticleSystem::SetConfig( ParticleSystemConfig_t *config )
+bool ParticleSystem::SetConfig( ParticleSystemConfig_t *config )
 {
+	bool result = true;
 	memcpy( &this->config, config, sizeof( ParticleSystemConfig_t ) );
-	for( unsigned int i = 0; i < particle_data.size(); i++ ) {
-		particle_data[ i ].reset();
-	}
-    if( particle_data.size() < config->totalParticles ) {
-        particle_data.resize( config->totalParticles );
+	ParticleKernels::Reset( &_particles, 0, _particles.capacity );
+    if( _particles.capacity < config->totalParticles ) {
+		if( !ParticleKernels::Resize( &_particles, config->totalParticles, _particleCount ) ) {
+			// emission must never exceed the particles allocated
+			this->config.totalParticles = _particles.capacity;
+			result = false;
+		}
     }
 	if( config->emissionRate > 0 ) {
 		_rate = 1.0f / config->emissionRate;
 	}
+	return result;
 }
 
 
 void ParticleSystem::AddParticles(int count)
 {
-	// if system is not active exit immediately
-	if( !_isActive ) {
+	// if system is not active (or there is nothing to add) exit immediately
+	if( !_isActive || ( count <= 0 ) ) {
         return;
     }
-	// seed for local random generator (used locally only!)
-    uint32_t RANDSEED = rand();
 	// store current number of particles
     int start = _particleCount;
 	// increment number of particle adding new requested particles
 	_particleCount += count;
 
+	// reset particle data
+	ParticleKernels::Reset( &_particles, start, _particleCount );
+
+	// random numbers in [-1, 1) are generated in batches, one batch for each attribute
+	float *rnd;
+
     // life time
+	rnd = NextRandoms( count );
     for( int i = start; i < _particleCount; ++i ) {
-		// reset particle data
-		particle_data[ i ].reset();
 		// calculate particle life time
-		float theLife = config.life + config.lifeVar * RANDOM_M11(&RANDSEED);
-        particle_data[ i ].timeToLive = (std::max)( 0.0f, theLife );
+		float theLife = config.life + config.lifeVar * rnd[ i - start ];
+        _particles.timeToLive[ i ] = (std::max)( 0.0f, theLife );
     }
 
 	// position 
     for( int i = start; i < _particleCount; ++i ) {
-		particle_data[ i ].startPosX  = this->x;
-        particle_data[ i ].startPosY  = this->y;
+		_particles.startPosX[ i ]  = this->x;
+        _particles.startPosY[ i ]  = this->y;
     }
 
 	// emitter shape (circular perimeter or area, rectangular perimeter or area)
 	switch( config.emitterShape ) {
 		case ES_RECTANGULAR_AREA:
 			// calculate start position in an rectangular area
+			rnd = NextRandoms( count * 2 );
 			for( int i = start; i < _particleCount; ++i ) {
-				particle_data[ i ].posx = config.positionVar.x * RANDOM_M11( &RANDSEED );
-				particle_data[ i ].posy = config.positionVar.y * RANDOM_M11( &RANDSEED );
+				_particles.posX[ i ] = config.positionVar.x * rnd[ ( i - start ) * 2 ];
+				_particles.posY[ i ] = config.positionVar.y * rnd[ ( i - start ) * 2 + 1 ];
 			}
 		break;
 		case ES_RECTANGULAR_PERIMETER:
 			// calculate start position on a rectangular perimeter
 			for( int i = start; i < _particleCount; ++i ) {
-				int rnd = rand()%4;
-				switch( rnd ) {
-					case 0:		particle_data[ i ].posx = config.positionVar.x;
-								particle_data[ i ].posy = config.positionVar.y * RANDOM_M11( &RANDSEED );
+				int side = _random.NextInt( 4 );
+				float value = _random.NextSigned();
+				switch( side ) {
+					case 0:		_particles.posX[ i ] = config.positionVar.x;
+								_particles.posY[ i ] = config.positionVar.y * value;
 					break;
-					case 1:		particle_data[ i ].posx = -config.positionVar.x;
-								particle_data[ i ].posy = config.positionVar.y * RANDOM_M11( &RANDSEED );
+					case 1:		_particles.posX[ i ] = -config.positionVar.x;
+								_particles.posY[ i ] = config.positionVar.y * value;
 					break;
-					case 2:		particle_data[ i ].posx = config.positionVar.x * RANDOM_M11( &RANDSEED );
-								particle_data[ i ].posy = config.positionVar.y;
+					case 2:		_particles.posX[ i ] = config.positionVar.x * value;
+								_particles.posY[ i ] = config.positionVar.y;
 					break;
-					default:	particle_data[ i ].posx = config.positionVar.x * RANDOM_M11( &RANDSEED );
-								particle_data[ i ].posy = -config.positionVar.y;
+					default:	_particles.posX[ i ] = config.positionVar.x * value;
+								_particles.posY[ i ] = -config.positionVar.y;
 					break;
 				}
 			}
 		break;
 		case ES_CIRCLE_AREA:
 			// calculate start position on a circle area
+			rnd = NextRandoms( count * 3 );
 			for( int i = start; i < _particleCount; ++i ) {
-				float newAngle = RANDOM_M11( &RANDSEED ) * M_PI * 2; // get a random angle
-				particle_data[ i ].posx = config.positionVar.x * cosf( newAngle ) * RANDOM_M11( &RANDSEED );	// x radius
-				particle_data[ i ].posy = config.positionVar.y * sinf( newAngle ) * RANDOM_M11( &RANDSEED );	// y radius
+				float newAngle = rnd[ ( i - start ) * 3 ] * M_PI * 2; // get a random angle
+				_particles.posX[ i ] = config.positionVar.x * cosf( newAngle ) * rnd[ ( i - start ) * 3 + 1 ];	// x radius
+				_particles.posY[ i ] = config.positionVar.y * sinf( newAngle ) * rnd[ ( i - start ) * 3 + 2 ];	// y radius
 			}
 		break;
 		case ES_CIRCLE_PERIMETER:
 			// calculate start position on a circle perimeter
+			rnd = NextRandoms( count );
 			for( int i = start; i < _particleCount; ++i ) {
-				float newAngle = RANDOM_M11( &RANDSEED ) * M_PI * 2; // get a random angle
-				particle_data[ i ].posx = config.positionVar.x * cosf( newAngle );	// x radius
-				particle_data[ i ].posy = config.positionVar.y * sinf( newAngle );	// y radius
+				float newAngle = rnd[ i - start ] * M_PI * 2; // get a random angle
+				_particles.posX[ i ] = config.positionVar.x * cosf( newAngle );	// x radius
+				_particles.posY[ i ] = config.positionVar.y * sinf( newAngle );	// y radius
 			}
 		break;
 		case ES_POINTS_ARRAY:
-			// calculate start position on a circle perimeter
+			// calculate start position around a random point of the array
+			rnd = NextRandoms( count * 2 );
 			for( int i = start; i < _particleCount; ++i ) {
-				//float newAngle = RANDOM_M11( &RANDSEED ) * M_PI * 2; // get a random angle
-				int rndPoint = rand()%config.totalPoints;
-				particle_data[ i ].posx = config.points[ rndPoint ].x + config.positionVar.x * RANDOM_M11( &RANDSEED );	
-				particle_data[ i ].posy = config.points[ rndPoint ].y + config.positionVar.y * RANDOM_M11( &RANDSEED );	
+				int rndPoint = _random.NextInt( config.totalPoints );
+				_particles.posX[ i ] = config.points[ rndPoint ].x + config.positionVar.x * rnd[ ( i - start ) * 2 ];	
+				_particles.posY[ i ] = config.points[ rndPoint ].y + config.positionVar.y * rnd[ ( i - start ) * 2 + 1 ];	
 			}
 		break;
 	}
 
     // color
 #define SET_COLOR(c, b, v)													\
+	rnd = NextRandoms( count );												\
 	for( int i = start; i < _particleCount; ++i ) {							\
-        particle_data[ i ].c = clampf( b + v * RANDOM_M11(&RANDSEED), 0, 1 );	\
+        _particles.c[ i ] = clampf( b + v * rnd[ i - start ], 0, 1 );		\
     }
 
 	SET_COLOR(colorR, config.startColor.r, config.startColorVar.r);
@@ -285,7 +334,7 @@ void ParticleSystem::AddParticles(int count)
 
 #define SET_DELTA_COLOR(c, dc)                                                                              \
 	for( int i = start; i < _particleCount; ++i ) {															\
-        particle_data[ i ].dc = (particle_data[ i ].dc - particle_data[ i ].c) / particle_data[ i ].timeToLive; \
+        _particles.dc[ i ] = (_particles.dc[ i ] - _particles.c[ i ]) / _particles.timeToLive[ i ]; \
     }
 
     SET_DELTA_COLOR(colorR, deltaColorR);
@@ -295,107 +344,142 @@ void ParticleSystem::AddParticles(int count)
 
 
     // size
+	rnd = NextRandoms( count );
     for( int i = start; i < _particleCount; ++i ) {
-		particle_data[ i ].size = config.startSize + config.startSizeVar * RANDOM_M11(&RANDSEED);
-        particle_data[ i ].size = (std::max)(0.0f, particle_data[ i ].size);
+		_particles.size[ i ] = config.startSize + config.startSizeVar * rnd[ i - start ];
+        _particles.size[ i ] = (std::max)(0.0f, _particles.size[ i ]);
     }
 
 	// calcualte delta difference from start and end size
     if( config.endSize != START_SIZE_EQUAL_TO_END_SIZE ) {
+		rnd = NextRandoms( count );
         for( int i = start; i < _particleCount; ++i ) {
-			float endSize = config.endSize + config.endSizeVar * RANDOM_M11(&RANDSEED);
+			float endSize = config.endSize + config.endSizeVar * rnd[ i - start ];
             endSize = (std::max)(0.0f, endSize);
-            particle_data[ i ].deltaSize = ( endSize - particle_data[ i ].size) / particle_data[ i ].timeToLive;
+            _particles.deltaSize[ i ] = ( endSize - _particles.size[ i ]) / _particles.timeToLive[ i ];
         }
     } else {
         for( int i = start; i < _particleCount; ++i ) {
-            particle_data[ i ].deltaSize = 0.0f;
+            _particles.deltaSize[ i ] = 0.0f;
         }
     }
 
     // calculate rotation delta
+	rnd = NextRandoms( count * 2 );
     for( int i = start; i < _particleCount; ++i ) {
-		particle_data[ i ].rotation = config.startSpin + config.startSpinVar * RANDOM_M11(&RANDSEED);
-    }
-    for( int i = start; i < _particleCount; ++i ) {
-		float endA = config.endSpin + config.endSpinVar * RANDOM_M11(&RANDSEED);
-        particle_data[ i ].deltaRotation = ( endA - particle_data[ i ].rotation ) / particle_data[ i ].timeToLive;
+		_particles.rotation[ i ] = config.startSpin + config.startSpinVar * rnd[ ( i - start ) * 2 ];
+		float endA = config.endSpin + config.endSpinVar * rnd[ ( i - start ) * 2 + 1 ];
+        _particles.deltaRotation[ i ] = ( endA - _particles.rotation[ i ] ) / _particles.timeToLive[ i ];
     }
 
     // Mode Gravity: A
 	if( config.mode == MODE_GRAVITY ) {
-        // radial accel
+        // radial and tangential accel
+		rnd = NextRandoms( count * 2 );
         for (int i = start; i < _particleCount; ++i) {
-            particle_data[ i ].modeA.radialAccel = config.radialAccel + config.radialAccelVar * RANDOM_M11(&RANDSEED);
+            _particles.radialAccel[ i ] = config.radialAccel + config.radialAccelVar * rnd[ ( i - start ) * 2 ];
+            _particles.tangentialAccel[ i ] = config.tangentialAccel + config.tangentialAccelVar * rnd[ ( i - start ) * 2 + 1 ];
         }
-        // tangential accel
-        for (int i = start; i < _particleCount; ++i) {
-            particle_data[i].modeA.tangentialAccel = config.tangentialAccel + config.tangentialAccelVar * RANDOM_M11(&RANDSEED);
+        // direction and speed
+		rnd = NextRandoms( count * 2 );
+        for( int i = start; i < _particleCount; ++i ) {
+            float a = Deg2Rad( config.angle + config.angleVar * rnd[ ( i - start ) * 2 ] );
+            Pointf v(cosf(a), sinf(a));
+            float s = config.speed + config.speedVar * rnd[ ( i - start ) * 2 + 1 ];
+			Pointf dir = v;
+			dir.x *= s;
+			dir.y *= s;
+            _particles.dirX[ i ] = dir.x;    
+            _particles.dirY[ i ] = dir.y;
         }
         // rotation is dir
         if( config.rotationIsDirection ) {
             for( int i = start; i < _particleCount; ++i ) {
-                float a = Deg2Rad( config.angle + config.angleVar * RANDOM_M11(&RANDSEED));
-                Pointf v(cosf(a), sinf(a));
-                float s = config.speed + config.speedVar * RANDOM_M11(&RANDSEED);
-				Pointf dir = v;
-				dir.x *= s;
-				dir.y *= s;
-                particle_data[ i ].modeA.dirX = dir.x;    
-                particle_data[ i ].modeA.dirY = dir.y;
-                particle_data[ i ].rotation = -Rad2Deg( dir.getAngle() );
-            }
-        } else {
-            for( int i = start; i < _particleCount; ++i ) {
-                float a = Deg2Rad( config.angle + config.angleVar * RANDOM_M11(&RANDSEED));
-                Pointf v(cosf(a), sinf(a));
-                float s = config.speed + config.speedVar * RANDOM_M11(&RANDSEED);
-				Pointf dir = v;
-				dir.x *= s;
-				dir.y *= s;
-                particle_data[ i ].modeA.dirX = dir.x;    
-                particle_data[ i ].modeA.dirY = dir.y;
+                _particles.rotation[ i ] = -Rad2Deg( atan2f( _particles.dirY[ i ], _particles.dirX[ i ] ) );
             }
         }
     } else {
 	    // Mode Radius: B
+		rnd = NextRandoms( count * 3 );
 		for( int i = start; i < _particleCount; ++i ) {
-            particle_data[ i ].modeB.radius = config.startRadius + config.startRadiusVar * RANDOM_M11(&RANDSEED);
-            particle_data[ i ].modeB.angle = Deg2Rad( config.angle + config.angleVar * RANDOM_M11(&RANDSEED));
-            particle_data[ i ].modeB.degreesPerSecond = Deg2Rad( config.rotatePerSecond + config.rotatePerSecondVar * RANDOM_M11(&RANDSEED));
+            _particles.radius[ i ] = config.startRadius + config.startRadiusVar * rnd[ ( i - start ) * 3 ];
+            _particles.angle[ i ] = Deg2Rad( config.angle + config.angleVar * rnd[ ( i - start ) * 3 + 1 ] );
+            _particles.degreesPerSecond[ i ] = Deg2Rad( config.rotatePerSecond + config.rotatePerSecondVar * rnd[ ( i - start ) * 3 + 2 ] );
         }
 
         if( config.endRadius == START_RADIUS_EQUAL_TO_END_RADIUS ) {
             for (int i = start; i < _particleCount; ++i) {
-                particle_data[ i ].modeB.deltaRadius = 0.0f;
+                _particles.deltaRadius[ i ] = 0.0f;
             }
         } else {
+			rnd = NextRandoms( count );
             for (int i = start; i < _particleCount; ++i) {
-                float endRadius = config.endRadius + config.endRadiusVar * RANDOM_M11(&RANDSEED);
-                particle_data[ i ].modeB.deltaRadius = (endRadius - particle_data[ i ].modeB.radius) / particle_data[ i ].timeToLive;
+                float endRadius = config.endRadius + config.endRadiusVar * rnd[ i - start ];
+                _particles.deltaRadius[ i ] = (endRadius - _particles.radius[ i ]) / _particles.timeToLive[ i ];
             }
         }
     }
 
-	// particles may have animation (array of textures), check if we must set the first frame 
-	// randomly (-1) or to a proper value
+	// particles may have animation (array of textures or sprite sheet), check if we must set the first frame 
+	// randomly (-1) or to a proper value; random offsets are not whole frames, so particles don't change
+	// frame all at the same time
 	if( _startFrameId >= 0 ) {
 		for( int i = start; i < _particleCount; ++i ) {
-			particle_data[ i ].textureFrameId = _startFrameId;
+			_particles.frame[ i ] = (float)_startFrameId;
 		}
 	} else {
+		rnd = NextRandoms( count );
 		for( int i = start; i < _particleCount; ++i ) {
-			particle_data[ i ].textureFrameId = rand()%_totalTextures;
+			_particles.frame[ i ] = ( rnd[ i - start ] + 1.0f ) * 0.5f * _totalFrames;
+		}
+	}
+}
+
+float* ParticleSystem::NextRandoms( int count )
+{
+	if( count <= 0 ) {
+		return NULL;
+	}
+	if( _randoms.size() < (size_t)count ) {
+		_randoms.resize( count );
+	}
+	_random.FillFloats( &_randoms[ 0 ], count, -1.0f, 1.0f );
+	return &_randoms[ 0 ];
+}
+
+void ParticleSystem::Update( float frameTime )
+{
+	// the frame is split in equal steps not longer than the step time; if the frame is too long only
+	// the maximum number of steps is simulated (the effect slows down, the frame rate does not)
+	if( frameTime > 0 ) {
+		int steps = (int)ceilf( frameTime / _stepTime );
+		float stepTime = frameTime / steps;
+		if( steps > _maxSteps ) {
+			steps		= _maxSteps;
+			stepTime	= _stepTime;
+		}
+		for( int i = 0; i < steps; i++ ) {
+			Step( stepTime );
 		}
 	}
 }
 
-void ParticleSystem::Update()
+void ParticleSystem::Step( float deltaTime )
 {
+	_deltaTime = deltaTime;
+
+	// update particles life time and remove dead particles
+	_particleCount = ParticleKernels::UpdateLife( &_particles, _particleCount, _deltaTime );
+
+	// new particles are added after the particles already alive
+	int firstNewParticle = _particleCount;
+
+	// the particle budget reduces the number of particles and the emission rate of the system
+	float rate = ( _budgetScale > 0 ? _rate / _budgetScale : 0 );
+
 	// we add new particles only if the system is active and emission rate is set (> 0)
-    if( ( _isActive ) && ( config.emissionRate ) ) {
-        //float rate = 1.0f / _emissionRate;
-        int totalParticles = config.totalParticles;
+    if( ( _isActive ) && ( config.emissionRate ) && ( rate > 0 ) ) {
+        int totalParticles = GetMaxParticles();
 
         //issue #1201, prevent bursts of particles, due to too high emitCounter
         if( _particleCount < totalParticles ) {
@@ -405,9 +489,10 @@ void ParticleSystem::Update()
             }
         }
 		// calculate how many particles can be emitted per second
-        int emitCount = (std::min)( 1.0f * ( totalParticles - _particleCount ), _emitCounter / _rate);
+        int emitCount = (std::min)( 1.0f * ( totalParticles - _particleCount ), _emitCounter / rate);
+        emitCount = (std::max)( emitCount, 0 );
         AddParticles( emitCount );
-        _emitCounter -= _rate * emitCount;
+        _emitCounter -= rate * emitCount;
 		// update total time elapsed from system start, _elapsed is used for stopping system if it
 		// has a finite time duration
         _elapsed += _deltaTime;
@@ -425,160 +510,317 @@ void ParticleSystem::Update()
 		// updating alive particles to let them terminate gracefully
 	}
 
-	// update particles life time
-    for( int i = 0; i < _particleCount; ++i ) {
-		// decrement frame time (1.0 / 25 = 0.04 = 40ms) from total life time of the particle
-        particle_data[ i ].timeToLive -= _deltaTime;
-		// if a particle has reached its end of life...
-        if( particle_data[ i ].timeToLive <= 0.0f ) {
-			// move the last particle of the array into the current position
-			particle_data[ i ] = particle_data[ _particleCount - 1 ];
-			// ..and decrement total particle counter
-            _particleCount -= 1;
-        }
-    }
+	if( _subFrameEmission ) {
+		// alive particles move for the whole step...
+		Simulate( 0, firstNewParticle, _deltaTime );
+		// ...new particles only for the time elapsed since their emission: particles are emitted every "rate"
+		// seconds and the last one has been emitted _emitCounter seconds ago
+		for( int i = _particleCount - 1; i >= firstNewParticle; i-- ) {
+			float age = _emitCounter + rate * ( _particleCount - 1 - i );
+			age = (std::min)( age, _deltaTime );
+			_particles.timeToLive[ i ] -= age;
+			Simulate( i, i + 1, age );
+		}
+	} else {
+		// all particles move for the whole step
+		for( int i = firstNewParticle; i < _particleCount; i++ ) {
+			_particles.timeToLive[ i ] -= _deltaTime;
+		}
+		Simulate( 0, _particleCount, _deltaTime );
+	}
+}
+
+// task of the ThreadPool: simulate a chunk of particles
+static void SimulateChunk( void *data, int index )
+{
+	ParticleChunks_t *chunks = (ParticleChunks_t*)data;
+	int start	= chunks->start + index * PARTICLESYSTEM_CHUNK_SIZE;
+	int end		= (std::min)( start + PARTICLESYSTEM_CHUNK_SIZE, chunks->end );
+	chunks->system->Simulate( start, end, chunks->deltaTime );
+}
+
+void ParticleSystem::Simulate( int start, int end, float deltaTime )
+{
+	// large ranges are split in chunks simulated in parallel; chunks have a fixed size, so the result
+	// doesn't depend on the number of threads
+	int totalChunks = ( end - start + PARTICLESYSTEM_CHUNK_SIZE - 1 ) / PARTICLESYSTEM_CHUNK_SIZE;
+	if( ( totalChunks > 1 ) && ( ThreadPool::GetTotalThreads() > 0 ) ) {
+		ParticleChunks_t chunks;
+		chunks.system		= this;
+		chunks.start		= start;
+		chunks.end			= end;
+		chunks.deltaTime	= deltaTime;
+		ThreadPool::ParallelFor( SimulateChunk, &chunks, totalChunks );
+		return;
+	}
 
 	// check if emitter modality is gravity or radial
 	if( config.mode == MODE_GRAVITY ) {
 		// emitter is set in gravity mode
-        for( int i = 0; i < _particleCount; ++i ) {
+		ParticleKernels::UpdateGravity( &_particles, start, end, config.gravity.x, config.gravity.y, (float)config.yCoordFlipped, deltaTime );
+	} else {
+		// emitter is set in radius mode
+		ParticleKernels::UpdateRadius( &_particles, start, end, (float)config.yCoordFlipped, deltaTime );
+	}
 
-			Pointf radial, tangential, tmp;
-			// reset points
-			radial.reset();
-			tangential.reset();
-			tmp.reset();
+	// update color, size and rotation
+	// animation frames advance with the other attributes (a single frame doesn't change)
+	ParticleKernels::UpdateAppearance( &_particles, start, end, ( _totalFrames > 1 ? _framesPerSecond : 0 ), deltaTime );
+}
 
-            // calculate radial acceleration
-            if( ( particle_data[ i ].posx ) || ( particle_data[ i ].posy ) ) {
-                normalize_point( particle_data[ i ].posx, particle_data[ i ].posy, &radial );
-            }
-            tangential = radial;
-            radial.x *= particle_data[ i ].modeA.radialAccel;
-            radial.y *= particle_data[ i ].modeA.radialAccel;
-
-            // calculate tangential acceleration
-            std::swap( tangential.x, tangential.y );
-            tangential.x *= -particle_data[ i ].modeA.tangentialAccel;
-            tangential.y *= particle_data[ i ].modeA.tangentialAccel;
-
-            // (gravity + radial + tangential) * _deltaTime
-            tmp.x = radial.x + tangential.x + config.gravity.x;
-            tmp.y = radial.y + tangential.y + config.gravity.y;
-            tmp.x *= _deltaTime;
-            tmp.y *= _deltaTime;
-
-            particle_data[ i ].modeA.dirX += tmp.x;
-            particle_data[ i ].modeA.dirY += tmp.y;
-
-            // calculate y flip
-            tmp.x = particle_data[ i ].modeA.dirX * _deltaTime * config.yCoordFlipped;
-            tmp.y = particle_data[ i ].modeA.dirY * _deltaTime * config.yCoordFlipped;
-            particle_data[ i ].posx += tmp.x;
-            particle_data[ i ].posy += tmp.y;
-        }
-    } else {
-		// emitter is set in gravity mode
-        for( int i = 0; i < _particleCount; ++i ) {
-            particle_data[ i ].modeB.angle += particle_data[ i ].modeB.degreesPerSecond * _deltaTime;
-            particle_data[ i ].modeB.radius += particle_data[ i ].modeB.deltaRadius * _deltaTime;
-            particle_data[ i ].posx = -cosf( particle_data[ i ].modeB.angle ) * particle_data[ i ].modeB.radius;
-            particle_data[ i ].posy = -sinf( particle_data[ i ].modeB.angle ) * particle_data[ i ].modeB.radius * config.yCoordFlipped;
-        }
-    }
+void ParticleSystem::SetPriority( float priority )
+{
+	_priority = (std::max)( priority, 0.0f );
+}
 
-    // update color, size and rotation
-    for( int i = 0; i < _particleCount; ++i ) {
-        particle_data[ i ].colorR += particle_data[ i ].deltaColorR * _deltaTime;
-        particle_data[ i ].colorG += particle_data[ i ].deltaColorG * _deltaTime;
-        particle_data[ i ].colorB += particle_data[ i ].deltaColorB * _deltaTime;
-        particle_data[ i ].colorA += particle_data[ i ].deltaColorA * _deltaTime;
-        particle_data[ i ].size += (particle_data[ i ].deltaSize * _deltaTime);
-        particle_data[ i ].size = (std::max)( 0.0f, particle_data[ i ].size );
-        particle_data[ i ].rotation += particle_data[ i ].deltaRotation * _deltaTime;
-    }
+float ParticleSystem::GetPriority()
+{
+	return _priority;
+}
+
+float ParticleSystem::GetBudgetScale()
+{
+	return _budgetScale;
+}
+
+void ParticleSystem::SetBudgetScale( float scale )
+{
+	_budgetScale = clampf( scale, 0, 1 );
+}
+
+int ParticleSystem::GetMaxParticles()
+{
+	return (int)( config.totalParticles * _budgetScale );
+}
+
+int ParticleSystem::GetTotalParticles()
+{
+	return config.totalParticles;
+}
+
+int ParticleSystem::GetParticleCount()
+{
+	return _particleCount;
+}
+
+float ParticleSystem::GetFillArea()
+{
+	// average area of a particle during its life
+	float endSize = ( config.endSize == START_SIZE_EQUAL_TO_END_SIZE ? config.startSize : config.endSize );
+	float size = ( config.startSize + endSize ) / 2;
+	// all particles are drawn in the main position and in each copy
+	return config.totalParticles * size * size * ( 1 + _totalCopies );
+}
+
+void ParticleSystem::SetRandomSeed( unsigned int seed )
+{
+	_random.SetSeed( seed, 0 );
+}
+
+void ParticleSystem::SetSubsteps( float stepTime, int maxSteps )
+{
+	if( ( stepTime > 0 ) && ( maxSteps > 0 ) ) {
+		_stepTime	= stepTime;
+		_maxSteps	= maxSteps;
+	}
+}
+
+void ParticleSystem::Draw()
+{
+	// nothing to draw without textures
+	if( _totalFrames == 0 ) {
+		return;
+	}
+#ifdef PARTICLESYSTEM_USE_RENDER_GEOMETRY
+	DrawBatched();
+#else
+	DrawParticles();
+#endif
+}
+
+#ifdef PARTICLESYSTEM_USE_RENDER_GEOMETRY
 
-	// if we have more than 1 texture (that's we have an animation)...
-	if( _totalTextures > 1 ) {
-		// update current frame for all particles
-		for( int i = 0; i < _particleCount; ++i ) {
-			particle_data[ i ].textureFrameId += 1;
-			if( particle_data[ i ].textureFrameId >= _totalTextures ) {
-				particle_data[ i ].textureFrameId = 0;
+void ParticleSystem::DrawBatched()
+{
+	// each particle is drawn in the main position and in all copies
+	int instances = 1 + _totalCopies;
+
+	// count visible quads of each texture
+	int quads[ PARTICLESYSTEM_MAX_TEXTURES ];
+	memset( quads, 0, sizeof( quads ) );
+	for( int i = 0; i < _particleCount; i++ ) {
+		int texture = _frames[ GetFrame( i ) ].texture;
+		if( ( _particles.size[ i ] > 0 ) && ( _particles.colorA[ i ] > 0 ) && ( _texturesArray[ texture ] ) ) {
+			quads[ texture ] += instances;
+		}
+	}
+	// quads of the same texture are stored one after the other
+	int first[ PARTICLESYSTEM_MAX_TEXTURES ];
+	int next[ PARTICLESYSTEM_MAX_TEXTURES ];
+	int totalQuads = 0;
+	for( int t = 0; t < _totalTextures; t++ ) {
+		first[ t ]	= totalQuads;
+		next[ t ]	= totalQuads;
+		totalQuads	+= quads[ t ];
+	}
+	if( totalQuads == 0 ) {
+		return;
+	}
+
+	// buffers only grow, indices are the same for every frame: two triangles for each quad
+	if( _vertices.size() < (unsigned int)totalQuads * 4 ) {
+		_vertices.resize( totalQuads * 4 );
+	}
+	if( _indices.size() < (unsigned int)totalQuads * 6 ) {
+		int quad = _indices.size() / 6;
+		_indices.resize( totalQuads * 6 );
+		for( ; quad < totalQuads; quad++ ) {
+			_indices[ quad * 6 + 0 ] = quad * 4 + 0;
+			_indices[ quad * 6 + 1 ] = quad * 4 + 1;
+			_indices[ quad * 6 + 2 ] = quad * 4 + 2;
+			_indices[ quad * 6 + 3 ] = quad * 4 + 2;
+			_indices[ quad * 6 + 4 ] = quad * 4 + 3;
+			_indices[ quad * 6 + 5 ] = quad * 4 + 0;
+		}
+	}
+
+	// expand particles into quads: rotation is applied to the corners, color is stored in the vertices and
+	// the frame selects the texture coordinates
+	const float cornerX[ 4 ]	= { -1, 1, 1, -1 };
+	const float cornerY[ 4 ]	= { -1, -1, 1, 1 };
+	for( int i = 0; i < _particleCount; i++ ) {
+		Frame_t *frame	= &_frames[ GetFrame( i ) ];
+		int texture		= frame->texture;
+		if( ( _particles.size[ i ] <= 0 ) || ( _particles.colorA[ i ] <= 0 ) || ( !_texturesArray[ texture ] ) ) {
+			continue;
+		}
+		float texX[ 4 ]	= { frame->u0, frame->u1, frame->u1, frame->u0 };
+		float texY[ 4 ]	= { frame->v0, frame->v0, frame->v1, frame->v1 };
+		SDL_Color c;
+		c.r = Uint8( _particles.colorR[ i ] * 255 );
+		c.g = Uint8( _particles.colorG[ i ] * 255 );
+		c.b = Uint8( _particles.colorB[ i ] * 255 );
+		c.a = Uint8( _particles.colorA[ i ] * 255 );
+		// corners relative to the center of the particle
+		float half		= _particles.size[ i ] / 2;
+		float radians	= Deg2Rad( _particles.rotation[ i ] );
+		float cosine	= cosf( radians ) * half;
+		float sine		= sinf( radians ) * half;
+		float offsetX[ 4 ], offsetY[ 4 ];
+		for( int k = 0; k < 4; k++ ) {
+			offsetX[ k ] = cornerX[ k ] * cosine - cornerY[ k ] * sine;
+			offsetY[ k ] = cornerX[ k ] * sine + cornerY[ k ] * cosine;
+		}
+		for( int j = 0; j < instances; j++ ) {
+			// main position or position of the copy
+			float centerX = _particles.posX[ i ] + ( j == 0 ? _particles.startPosX[ i ] : _copies[ j - 1 ].x );
+			float centerY = _particles.posY[ i ] + ( j == 0 ? _particles.startPosY[ i ] : _copies[ j - 1 ].y );
+			SDL_Vertex *v = &_vertices[ next[ texture ] * 4 ];
+			for( int k = 0; k < 4; k++ ) {
+				v[ k ].position.x	= centerX + offsetX[ k ];
+				v[ k ].position.y	= centerY + offsetY[ k ];
+				v[ k ].color		= c;
+				v[ k ].tex_coord.x	= texX[ k ];
+				v[ k ].tex_coord.y	= texY[ k ];
 			}
+			next[ texture ] += 1;
+		}
+	}
+
+	// a single call for each texture
+	for( int t = 0; t < _totalTextures; t++ ) {
+		if( quads[ t ] == 0 ) {
+			continue;
 		}
+		SDL_SetTextureColorMod( _texturesArray[ t ], 255, 255, 255 );
+		SDL_SetTextureAlphaMod( _texturesArray[ t ], 255 );
+		SDL_SetTextureBlendMode( _texturesArray[ t ], SDL_BLENDMODE_BLEND );
+		SDL_RenderGeometry( _renderer, _texturesArray[ t ], &_vertices[ first[ t ] * 4 ], quads[ t ] * 4, &_indices[ 0 ], quads[ t ] * 6 );
 	}
 }
 
-void ParticleSystem::Draw()
+#else
+
+void ParticleSystem::DrawParticles()
 {
 	SDL_Texture *pTexture;
     SDL_Rect	r;
 	SDL_Color	c;
 
-	//printf( "_particleCount %d\n", _particleCount );
+	// blend mode is the same for all particles
+	for( int t = 0; t < _totalTextures; t++ ) {
+		if( _texturesArray[ t ] ) {
+			SDL_SetTextureBlendMode( _texturesArray[ t ], SDL_BLENDMODE_BLEND );
+		}
+	}
 
 	// scan all particles
 	for( int i = 0; i < _particleCount; i++ ) {
 
-		// get particle for data extraction 
-		ParticleData p = particle_data[ i ];
+		// size of the particle
+		float size = _particles.size[ i ];
 
 		// if partitcle is not visible continue with the next particle
-		if( ( p.size <= 0 ) || ( p.colorA <= 0 ) ) {
+		if( ( size <= 0 ) || ( _particles.colorA[ i ] <= 0 ) ) {
             continue;
         }
 		// get current texture of this particle, if texture is not set continue
-		pTexture = _texturesArray[ p.textureFrameId ];
+		Frame_t *frame = &_frames[ GetFrame( i ) ];
+		pTexture = _texturesArray[ frame->texture ];
 		if( !pTexture ) {
 			continue;
 		}
+		SDL_Rect *source = ( frame->source.w > 0 ? &frame->source : NULL );
 
 		// set color of texture for this particle
-		c.r = Uint8( p.colorR * 255 );
-		c.g = Uint8( p.colorG * 255 );
-		c.b = Uint8( p.colorB * 255 );
-		c.a = Uint8( p.colorA * 255 );
+		c.r = Uint8( _particles.colorR[ i ] * 255 );
+		c.g = Uint8( _particles.colorG[ i ] * 255 );
+		c.b = Uint8( _particles.colorB[ i ] * 255 );
+		c.a = Uint8( _particles.colorA[ i ] * 255 );
         SDL_SetTextureColorMod( pTexture, c.r, c.g, c.b );
         SDL_SetTextureAlphaMod( pTexture, c.a );
-        SDL_SetTextureBlendMode( pTexture, SDL_BLENDMODE_BLEND );
 
 		// calculate current position and size of particle		
-		r.x = int( p.posx + p.startPosX - p.size / 2 );
-		r.y = int( p.posy + p.startPosY - p.size / 2 );
-		r.w = int( p.size );
-		r.h = int( p.size );
-        SDL_RenderCopyEx( _renderer, pTexture, NULL, &r, p.rotation, NULL, SDL_FLIP_NONE );
+		r.x = int( _particles.posX[ i ] + _particles.startPosX[ i ] - size / 2 );
+		r.y = int( _particles.posY[ i ] + _particles.startPosY[ i ] - size / 2 );
+		r.w = int( size );
+		r.h = int( size );
+        SDL_RenderCopyEx( _renderer, pTexture, source, &r, _particles.rotation[ i ], NULL, SDL_FLIP_NONE );
 
 		// print copies (if any)
 		for( unsigned int j = 0; j < _totalCopies; j++ ) {
-			r.x = int( p.posx + _copies[ j ].x - p.size / 2 );
-			r.y = int( p.posy + _copies[ j ].y - p.size / 2 );
-			SDL_RenderCopyEx( _renderer, pTexture, NULL, &r, p.rotation, NULL, SDL_FLIP_NONE );
+			r.x = int( _particles.posX[ i ] + _copies[ j ].x - size / 2 );
+			r.y = int( _particles.posY[ i ] + _copies[ j ].y - size / 2 );
+			SDL_RenderCopyEx( _renderer, pTexture, source, &r, _particles.rotation[ i ], NULL, SDL_FLIP_NONE );
 		}
     }
-	// update state of all particles
-	Update();
 }
 
+#endif
+
 void ParticleSystem::SetTexture( SDL_Texture* texture )
 {
 	// insert the texture into the first element of array
     _texturesArray[ 0 ] = texture;
 	_totalTextures	= 1;
 	_startFrameId	= 0;
+	// a single frame showing the whole texture
+	SetFrame( 0, 0, NULL );
+	_totalFrames	= 1;
 }
 
 bool ParticleSystem::SetTexturesArray( int totalTextures, SDL_Texture** texturesArray, int startFrameId )
 {
 	bool result = false;
 	if( ( totalTextures >= 0 ) && ( totalTextures < PARTICLESYSTEM_MAX_TEXTURES ) ) {
-		// store textures pointers into local array
+		// store textures pointers into local array, each texture is a frame
 		for( int i = 0; i < totalTextures; i++ ) {
 			_texturesArray[ i ] = texturesArray[ i ];
+			SetFrame( i, i, NULL );
 		}	
 		// store total textures number
-		_totalTextures = totalTextures;
+		_totalTextures	= totalTextures;
+		_totalFrames	= totalTextures;
 		// and store the start frame id
 		_startFrameId = startFrameId;
 		// OK!
@@ -587,6 +829,61 @@ bool ParticleSystem::SetTexturesArray( int totalTextures, SDL_Texture** textures
 	return result;
 }
 
+bool ParticleSystem::SetSpriteSheet( SDL_Texture* texture, int columns, int rows, int totalFrames, float framesPerSecond, int startFrameId )
+{
+	if( totalFrames == 0 ) {
+		totalFrames = columns * rows;
+	}
+	if( ( texture == NULL ) || ( columns <= 0 ) || ( rows <= 0 ) || ( totalFrames <= 0 ) || ( totalFrames > columns * rows ) || ( totalFrames > PARTICLESYSTEM_MAX_FRAMES ) ) {
+		printf( "ParticleSystem::SetSpriteSheet: invalid sprite sheet (%d x %d, %d frames)\n", columns, rows, totalFrames );
+		return false;
+	}
+	int width, height;
+	SDL_QueryTexture( texture, NULL, NULL, &width, &height );
+	_texturesArray[ 0 ]	= texture;
+	_totalTextures		= 1;
+	// frames are the cells of the grid, in reading order
+	for( int i = 0; i < totalFrames; i++ ) {
+		SDL_Rect cell;
+		cell.w = width / columns;
+		cell.h = height / rows;
+		cell.x = ( i % columns ) * cell.w;
+		cell.y = ( i / columns ) * cell.h;
+		SetFrame( i, 0, &cell );
+	}
+	_totalFrames		= totalFrames;
+	SetFramesPerSecond( framesPerSecond );
+	_startFrameId		= ( startFrameId < totalFrames ? startFrameId : 0 );
+	return true;
+}
+
+void ParticleSystem::SetFramesPerSecond( float framesPerSecond )
+{
+	// frames only go forward, a negative speed would give negative frame indexes (see GetFrame)
+	_framesPerSecond = ( framesPerSecond > 0 ? framesPerSecond : 0 );
+}
+
+void ParticleSystem::SetFrame( int frame, int texture, SDL_Rect *source )
+{
+	Frame_t *f = &_frames[ frame ];
+	f->texture = texture;
+	if( source == NULL ) {
+		memset( &f->source, 0, sizeof( SDL_Rect ) );
+		f->u0 = 0;
+		f->v0 = 0;
+		f->u1 = 1;
+		f->v1 = 1;
+	} else {
+		int width, height;
+		SDL_QueryTexture( _texturesArray[ texture ], NULL, NULL, &width, &height );
+		f->source	= *source;
+		f->u0		= (float)source->x / width;
+		f->v0		= (float)source->y / height;
+		f->u1		= (float)( source->x + source->w ) / width;
+		f->v1		= (float)( source->y + source->h ) / height;
+	}
+}
+
 bool ParticleSystem::AddCopy( float copyX, float copyY )
 {
 	bool result = false;
@@ -11,6 +11,14 @@
 #include <string>
 #include "Node.h"
 #include "Engine.h"
+#include "ParticleKernels.h"
+#include "Random.h"
+
+// SDL_RenderGeometry is available from SDL 2.0.18: all particles of a texture (and their copies) are drawn with
+// a single call, older versions draw each particle with SDL_RenderCopyEx
+#if SDL_VERSION_ATLEAST( 2, 0, 18 )
+#define PARTICLESYSTEM_USE_RENDER_GEOMETRY
+#endif
 
 // particle modality: gravity o radius
 typedef enum {
@@ -104,50 +112,33 @@ typedef struct
 
 } ParticleSystemConfig_t;
 
-// all data of a single particle
-class ParticleData
+/*
+	state of a particle system saved by ParticleSystem::CreateSnapshot (e.g. after Prewarm) and restored
+	by ParticleSystem::RestoreSnapshot; delete it when no longer needed
+*/
+class ParticleSnapshot
 {
 public:
-    float		posx;
-    float		posy;
-    float		startPosX;
-    float		startPosY;
-
-    float		colorR;
-    float		colorG;
-    float		colorB;
-    float		colorA;
-
-    float		deltaColorR;
-    float		deltaColorG;
-    float		deltaColorB;
-    float		deltaColorA;
-
-    float		size;
-    float		deltaSize;
-    float		rotation;
-    float		deltaRotation;
-    float		timeToLive;
-	int			textureFrameId;
-
-    // Mode A: gravity, direction, radial accel, tangential accel
-    struct {
-        float	dirX;
-        float	dirY;
-        float	radialAccel;
-        float	tangentialAccel;
-    } modeA;
-
-    // Mode B: radius mode
-    struct {
-        float	angle;
-        float	degreesPerSecond;
-        float	radius;
-        float	deltaRadius;
-    } modeB;
-
-	// this function reset all particle data
-	void		reset();
+	// destructor
+	~ParticleSnapshot();
+
+private:
+	friend class ParticleSystem;
+
+	// created by ParticleSystem only
+	ParticleSnapshot();
+
+	// particles alive
+	ParticleStreams_t	particles;
+	int					particleCount;
+	// emitter state
+	bool				isActive;
+	float				elapsed;
+	float				emitCounter;
+	RandomStream		random;
+	// position of the emitter
+	float				x;
+	float				y;
 };
 
 /*
@@ -176,8 +167,19 @@ public:
 	// stop system, particles are free terminate themself gracefully
     void Stop();
 
-	// NOTE: to set image source we can use setTexture for a single texture or setTexturesArray
-	// for an array of texture; one of these two MUST BE CALLED!
+	// simulate the system for some seconds without drawing it (call after Start), so ambient effects
+	// appear already at steady state; large steps are used, particles are emitted at their exact time
+	void Prewarm( float seconds );
+
+	// save the current state of particles and emitter (e.g. after Prewarm), returns NULL on error
+	ParticleSnapshot* CreateSnapshot();
+
+	// restore a state saved by CreateSnapshot, particles are moved with the emitter if its position
+	// has changed; the configuration must be the same of the system that created the snapshot
+	bool RestoreSnapshot( ParticleSnapshot *snapshot );
+
+	// NOTE: to set image source we can use setTexture for a single texture, setTexturesArray
+	// for an array of texture or SetSpriteSheet for frames in a single texture; one of these MUST BE CALLED!
 	// Sets a single texture 
 	void SetTexture( SDL_Texture* texture );
 	// Sets an array of textures 
@@ -185,34 +187,113 @@ public:
 	// - texturesArray			-> pointer to array of items
 	// - startFrameId			-> index of start frame for syncing particles or -1 for random
 	bool SetTexturesArray( int totalTextures, SDL_Texture** texturesArray, int startFrameId );
-
-	// set system parameters (mode, duration, emission rate, ecc.)
-	void SetConfig( ParticleSystemConfig_t *config );
+	// Sets a sprite sheet: frames are the cells of a grid, from left to right and from top to bottom;
+	// all frames are drawn with the same texture, so particles in different frames are still batched
+	// - columns, rows			-> size of the grid
+	// - totalFrames			-> total number of frames (0 for all the cells of the grid)
+	// - framesPerSecond		-> speed of the animation (negative values are taken as 0)
+	// - startFrameId			-> index of start frame for syncing particles or -1 for a random offset of each particle
+	bool SetSpriteSheet( SDL_Texture* texture, int columns, int rows, int totalFrames, float framesPerSecond, int startFrameId );
+	// set speed of the animation (default PARTICLESYSTEM_FRAMES_PER_SECOND), frames change with time and
+	// not with the frame rate of the game; negative values are taken as 0
+	void SetFramesPerSecond( float framesPerSecond );
+
+	// set system parameters (mode, duration, emission rate, ecc.), returns false if the particles can't be
+	// allocated (in that case the maximum number of particles is limited to the ones already allocated)
+	bool SetConfig( ParticleSystemConfig_t *config );
 
 	// set system active or inactive
 	void SetActive( bool state ) { _isActive = state;	};
 	// get system active state
 	bool isActive() { return _isActive; };
 
+	// set max duration (seconds) of a simulation step and max number of steps for each frame: each frame is
+	// split in equal steps not longer than stepTime, so motion, emission and life of particles don't depend on
+	// the frame rate; time exceeding maxSteps * stepTime is dropped (long frames slow down the effect)
+	void SetSubsteps( float stepTime, int maxSteps );
+
+	// if true each particle emitted during a step is moved only for the time elapsed since its emission,
+	// so fast emitters don't emit particles in clumps (one for each step)
+	void SetSubFrameEmission( bool state ) { _subFrameEmission = state; };
+
 	// print an exact copy of the system into another place
 	// calculation are done once only for the main position
 	bool AddCopy( float copyX, float copyY );
 	// delete all copies (if any)
 	void DeleteCopies();
 
-	// called every frame	
+	// set the seed of the random generator of the system: systems started with the same seed and
+	// configuration produce the same particles (see also RandomStream::SetGlobalSeed)
+	void SetRandomSeed( unsigned int seed );
+
+	// set/get priority of the system (default 1.0): when the particle budget is exceeded (see
+	// ParticleManager::SetBudget) systems with a lower priority lose more particles
+	void SetPriority( float priority );
+	float GetPriority();
+
+	// returns the part of the configuration granted by the particle budget (1.0 = all particles)
+	float GetBudgetScale();
+
+	// returns max number of particles granted by the particle budget
+	int GetMaxParticles();
+
+	// returns number of particles alive
+	int GetParticleCount();
+
+	// ========================= functions below are used internally, don't use in the game =======================
+
+	// set the part of the configuration granted by the particle budget: the max number of particles and
+	// the emission rate are multiplied by the scale (0.0 ... 1.0)
+	void SetBudgetScale( float scale );
+
+	// returns the estimated screen area (pixels) covered by all particles at full budget
+	float GetFillArea();
+
+	// returns max number of particles of the configuration (full budget)
+	int GetTotalParticles();
+
+	// called every frame, draws the particles simulated by Update
 	void Draw();
 
+	// called every frame by the ParticleManager (also on worker threads), advances the system by the time
+	// elapsed from previous frame (seconds)
+	void Update( float frameTime );
+
+	// move and change appearance of a range of particles
+	void Simulate( int start, int end, float deltaTime );
+
 private:
 
+	// systems can't be copied (a copy would not be registered in the ParticleManager, see Register)
+	ParticleSystem( const ParticleSystem & );
+	ParticleSystem& operator=( const ParticleSystem & );
+
 	// total number of textures (particle animation)
 	#define PARTICLESYSTEM_MAX_TEXTURES		32
 
+	// total number of animation frames (textures or cells of a sprite sheet)
+	#define PARTICLESYSTEM_MAX_FRAMES		256
+
+	// default speed (frames per second) of the animation
+	#define PARTICLESYSTEM_FRAMES_PER_SECOND	60.0f
+
 	// total number of exact copies of the main animation
 	#define PARTICLESYSTEM_MAX_COPIES		32
 
-    // particle data
-    std::vector<ParticleData>	particle_data;
+	// default max duration (seconds) of a simulation step
+	#define PARTICLESYSTEM_STEP_TIME		( 1.0f / 60.0f )
+
+	// default max number of simulation steps for each frame
+	#define PARTICLESYSTEM_MAX_STEPS		4
+
+	// duration (seconds) of the simulation steps of Prewarm
+	#define PARTICLESYSTEM_PREWARM_STEP_TIME	( 1.0f / 20.0f )
+
+	// number of particles simulated by each task when a system is split (multiple of PARTICLEKERNELS_LANES)
+	#define PARTICLESYSTEM_CHUNK_SIZE		2048
+
+    // particle data, one aligned stream for each attribute (see ParticleKernels.h)
+    ParticleStreams_t	_particles;
 
 	// system parameters (mode, duration, emission rate, ecc.)
 	ParticleSystemConfig_t	config;
@@ -229,6 +310,26 @@ private:
 	// start frame when a particle is added or random if -1 is set
 	int					_startFrameId;
 
+	// animation frame: texture and portion of the texture
+	typedef struct {
+		// index of the texture in _texturesArray
+		int				texture;
+		// portion of the texture (width 0 for the whole texture)
+		SDL_Rect		source;
+		// texture coordinates (0.0 ... 1.0) of the portion
+		float			u0;
+		float			v0;
+		float			u1;
+		float			v1;
+	} Frame_t;
+
+	// animation frames
+	Frame_t				_frames[ PARTICLESYSTEM_MAX_FRAMES ];
+	// total number of frames
+	int					_totalFrames;
+	// speed of the animation
+	float				_framesPerSecond;
+
 
 	// time elapsed since the start of the system (in seconds)
     float				_elapsed;
@@ -236,8 +337,22 @@ private:
     float				_emitCounter;
     //  Quantity of particles that are being simulated at the moment 
     int					_particleCount;
-	//	this value is set to 1.0 / 25 = 0.04 and refer to 40ms of theoretical elapsed time after each frame
+	//	duration of the current simulation step (in seconds)
     float				_deltaTime;
+	// max duration (seconds) of a simulation step
+	float				_stepTime;
+	// max number of simulation steps for each frame
+	int					_maxSteps;
+	// emit particles at their exact time inside a step
+	bool				_subFrameEmission;
+	// random generator of the system (each system has its own, so systems can be simulated on different threads)
+	RandomStream		_random;
+	// random numbers generated for the particles being added
+	std::vector<float>	_randoms;
+	// priority of the system for the particle budget
+	float				_priority;
+	// part of the configuration granted by the particle budget
+	float				_budgetScale;
 	// this value is calculate when we set the emission rate
 	float				_rate;
 
@@ -246,10 +361,29 @@ private:
 	// total number of copies
 	unsigned int		_totalCopies;
 
+#ifdef PARTICLESYSTEM_USE_RENDER_GEOMETRY
+	// vertices of the quads of all particles (4 for each particle and copy), sorted by texture
+	std::vector<SDL_Vertex>	_vertices;
+	// indices of the quads (two triangles for each quad), the same for every frame
+	std::vector<int>		_indices;
+
+	// expand all particles into quads and draw them with one call for each texture
+	void				DrawBatched();
+#else
+	// draw each particle (and its copies) with its own call
+	void				DrawParticles();
+#endif
+
 	// add a number of particles to the system
     void				AddParticles(int count);
-
-	// called every frame inside Draw function
-    void				Update();
+	// generate a batch of random numbers in [-1, 1), valid until the next call (NULL if count is not positive)
+	float*				NextRandoms( int count );
+	// returns the current frame of a particle
+	int					GetFrame( int particle ) { return (int)_particles.frame[ particle ] % _totalFrames; };
+	// set a frame showing a portion (NULL for all) of a texture
+	void				SetFrame( int frame, int texture, SDL_Rect *source );
+
+	// advance the system by a simulation step (emission, life and motion of particles)
+	void				Step( float deltaTime );
 
 };
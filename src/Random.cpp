@@ -0,0 +1,214 @@
+/*
+ 	The information contained herein is confidential.
+ 	The use, copying, transfer or disclosure of such information is proibited
+ 	except by press written agreement with the author
+*/
+
+#include "Random.h"
+
+#ifdef RANDOM_USE_SSE
+#include <emmintrin.h>
+#endif
+
+// Philox4x32 constants
+#define RANDOM_PHILOX_M0		0xD2511F53
+#define RANDOM_PHILOX_M1		0xCD9E8D57
+#define RANDOM_PHILOX_W0		0x9E3779B9
+#define RANDOM_PHILOX_W1		0xBB67AE85
+#define RANDOM_PHILOX_ROUNDS	10
+
+// seed of streams created with the default constructor
+static Uint32	globalSeed		= 0x2DEE5EED;
+// next stream id of streams created with the default constructor
+static Uint32	nextStream		= 0;
+
+// Philox4x32-10 of a counter
+static void Philox( Uint32 *counter, const Uint32 *key, Uint32 *result )
+{
+	Uint32 c0 = counter[ 0 ], c1 = counter[ 1 ], c2 = counter[ 2 ], c3 = counter[ 3 ];
+	Uint32 k0 = key[ 0 ], k1 = key[ 1 ];
+	for( int round = 0; round < RANDOM_PHILOX_ROUNDS; round++ ) {
+		Uint64 p0 = (Uint64)RANDOM_PHILOX_M0 * c0;
+		Uint64 p1 = (Uint64)RANDOM_PHILOX_M1 * c2;
+		c0 = (Uint32)( p1 >> 32 ) ^ c1 ^ k0;
+		c1 = (Uint32)p1;
+		c2 = (Uint32)( p0 >> 32 ) ^ c3 ^ k1;
+		c3 = (Uint32)p0;
+		k0 += RANDOM_PHILOX_W0;
+		k1 += RANDOM_PHILOX_W1;
+	}
+	result[ 0 ] = c0;
+	result[ 1 ] = c1;
+	result[ 2 ] = c2;
+	result[ 3 ] = c3;
+}
+
+// float in [0, 1) from the 23 high bits of a number
+static inline float ToFloat( Uint32 value )
+{
+	union {
+		Uint32	d;
+		float	f;
+	} u;
+	u.d = ( value >> 9 ) | 0x3f800000;
+	return u.f - 1.0f;
+}
+
+#ifdef RANDOM_USE_SSE
+
+// low and high 32 bits of the products of 4 numbers by the same constant
+static inline void Multiply4( __m128i a, __m128i m, __m128i *low, __m128i *high )
+{
+	const __m128i evenMask = _mm_set_epi32( 0, -1, 0, -1 );
+	// products of lanes 0, 2 and of lanes 1, 3
+	__m128i even	= _mm_mul_epu32( a, m );
+	__m128i odd		= _mm_mul_epu32( _mm_srli_epi64( a, 32 ), m );
+	*low	= _mm_or_si128( _mm_and_si128( even, evenMask ), _mm_slli_epi64( odd, 32 ) );
+	*high	= _mm_or_si128( _mm_srli_epi64( even, 32 ), _mm_andnot_si128( evenMask, odd ) );
+}
+
+// Philox4x32-10 of 4 consecutive counters, the 16 numbers are stored in the order of the scalar version
+static void Philox4( Uint64 counter, const Uint32 *key, float *values, __m128 scale, __m128 offset )
+{
+	// lane i works on counter + i
+	__m128i c0 = _mm_set_epi32( (Uint32)( counter + 3 ), (Uint32)( counter + 2 ), (Uint32)( counter + 1 ), (Uint32)counter );
+	__m128i c1 = _mm_set_epi32( (Uint32)( ( counter + 3 ) >> 32 ), (Uint32)( ( counter + 2 ) >> 32 ), (Uint32)( ( counter + 1 ) >> 32 ), (Uint32)( counter >> 32 ) );
+	__m128i c2 = _mm_setzero_si128();
+	__m128i c3 = _mm_setzero_si128();
+	__m128i m0 = _mm_set1_epi32( RANDOM_PHILOX_M0 );
+	__m128i m1 = _mm_set1_epi32( RANDOM_PHILOX_M1 );
+	Uint32 k0 = key[ 0 ], k1 = key[ 1 ];
+	for( int round = 0; round < RANDOM_PHILOX_ROUNDS; round++ ) {
+		__m128i low0, high0, low1, high1;
+		Multiply4( c0, m0, &low0, &high0 );
+		Multiply4( c2, m1, &low1, &high1 );
+		c0 = _mm_xor_si128( _mm_xor_si128( high1, c1 ), _mm_set1_epi32( k0 ) );
+		c1 = low1;
+		c2 = _mm_xor_si128( _mm_xor_si128( high0, c3 ), _mm_set1_epi32( k1 ) );
+		c3 = low0;
+		k0 += RANDOM_PHILOX_W0;
+		k1 += RANDOM_PHILOX_W1;
+	}
+	// to floats in [1, 2) then [0, 1) and to the requested range
+	const __m128i exponent = _mm_set1_epi32( 0x3f800000 );
+	const __m128 one = _mm_set1_ps( 1.0f );
+	__m128 f0 = _mm_sub_ps( _mm_castsi128_ps( _mm_or_si128( _mm_srli_epi32( c0, 9 ), exponent ) ), one );
+	__m128 f1 = _mm_sub_ps( _mm_castsi128_ps( _mm_or_si128( _mm_srli_epi32( c1, 9 ), exponent ) ), one );
+	__m128 f2 = _mm_sub_ps( _mm_castsi128_ps( _mm_or_si128( _mm_srli_epi32( c2, 9 ), exponent ) ), one );
+	__m128 f3 = _mm_sub_ps( _mm_castsi128_ps( _mm_or_si128( _mm_srli_epi32( c3, 9 ), exponent ) ), one );
+	// registers contain a word of each counter: transpose to get the words of each counter
+	_MM_TRANSPOSE4_PS( f0, f1, f2, f3 );
+	_mm_storeu_ps( values + 0, _mm_add_ps( _mm_mul_ps( f0, scale ), offset ) );
+	_mm_storeu_ps( values + 4, _mm_add_ps( _mm_mul_ps( f1, scale ), offset ) );
+	_mm_storeu_ps( values + 8, _mm_add_ps( _mm_mul_ps( f2, scale ), offset ) );
+	_mm_storeu_ps( values + 12, _mm_add_ps( _mm_mul_ps( f3, scale ), offset ) );
+}
+
+#endif
+
+RandomStream::RandomStream()
+{
+	SetSeed( globalSeed, nextStream );
+	nextStream += 1;
+}
+
+RandomStream::RandomStream( Uint32 seed, Uint32 stream )
+{
+	SetSeed( seed, stream );
+}
+
+void RandomStream::SetSeed( Uint32 seed, Uint32 stream )
+{
+	this->key[ 0 ]		= seed;
+	this->key[ 1 ]		= stream;
+	this->counter		= 0;
+	this->blockIndex	= 4;
+}
+
+Uint64 RandomStream::GetPosition()
+{
+	// the current block has already been counted
+	return ( blockIndex == 4 ? counter * 4 : ( counter - 1 ) * 4 + blockIndex );
+}
+
+void RandomStream::SetPosition( Uint64 position )
+{
+	counter		= position / 4;
+	blockIndex	= 4;
+	if( position % 4 ) {
+		NextBlock();
+		blockIndex = (int)( position % 4 );
+	}
+}
+
+void RandomStream::NextBlock()
+{
+	Uint32 c[ 4 ];
+	c[ 0 ] = (Uint32)counter;
+	c[ 1 ] = (Uint32)( counter >> 32 );
+	c[ 2 ] = 0;
+	c[ 3 ] = 0;
+	Philox( c, key, block );
+	counter		+= 1;
+	blockIndex	= 0;
+}
+
+Uint32 RandomStream::NextUint()
+{
+	if( blockIndex == 4 ) {
+		NextBlock();
+	}
+	Uint32 result = block[ blockIndex ];
+	blockIndex += 1;
+	return result;
+}
+
+float RandomStream::NextFloat()
+{
+	return ToFloat( NextUint() );
+}
+
+float RandomStream::NextSigned()
+{
+	return ToFloat( NextUint() ) * 2.0f - 1.0f;
+}
+
+int RandomStream::NextInt( int count )
+{
+	if( count <= 1 ) {
+		return 0;
+	}
+	// high bits are used: with 32 bits the bias is negligible for small counts
+	return (int)( ( (Uint64)NextUint() * (Uint32)count ) >> 32 );
+}
+
+void RandomStream::FillFloats( float *values, int count, float minValue, float maxValue )
+{
+	float scale = maxValue - minValue;
+	int i = 0;
+	// numbers left in the current block
+	while( ( i < count ) && ( blockIndex < 4 ) ) {
+		values[ i ] = minValue + ToFloat( NextUint() ) * scale;
+		i += 1;
+	}
+#ifdef RANDOM_USE_SSE
+	// 4 blocks at a time
+	__m128 scaleVector	= _mm_set1_ps( scale );
+	__m128 offsetVector	= _mm_set1_ps( minValue );
+	while( count - i >= 16 ) {
+		Philox4( counter, key, values + i, scaleVector, offsetVector );
+		counter	+= 4;
+		i		+= 16;
+	}
+#endif
+	while( i < count ) {
+		values[ i ] = minValue + ToFloat( NextUint() ) * scale;
+		i += 1;
+	}
+}
+
+void RandomStream::SetGlobalSeed( Uint32 seed )
+{
+	globalSeed = seed;
+	nextStream = 0;
+}
@@ -0,0 +1,77 @@
+/*
+ 	The information contained herein is confidential.
+ 	The use, copying, transfer or disclosure of such information is proibited
+ 	except by press written agreement with the author
+*/
+
+#ifndef _RANDOM_H_INCLUDE
+#define _RANDOM_H_INCLUDE
+
+#include <SDL.h>
+
+// SSE2 generator is compiled when the target has SSE2 (x64, /arch:SSE2 on x86)
+#if !defined( RANDOM_NO_SIMD ) && ( defined( _M_X64 ) || ( defined( _M_IX86_FP ) && ( _M_IX86_FP >= 2 ) ) || defined( __SSE2__ ) )
+#define RANDOM_USE_SSE
+#endif
+
+/*
+	RandomStream is a counter based random generator (Philox4x32-10): the n-th number of a stream is a
+	function of the seed, the stream id and n only, so
+	- every object (particle system, action, ...) can own its stream, streams are independent and thread safe
+	- a stream can be replayed from any position (SetPosition)
+	- many numbers can be generated in parallel (FillFloats uses SSE2 and gives the same numbers of NextFloat)
+	Streams created with the default constructor use the global seed (see SetGlobalSeed) and a new stream id.
+*/
+class RandomStream {
+
+public:
+
+	// constructor: global seed and a new stream id
+	RandomStream();
+
+	// constructor: given seed and stream id
+	RandomStream( Uint32 seed, Uint32 stream );
+
+	// set seed and stream id and restart from the first number
+	void			SetSeed( Uint32 seed, Uint32 stream );
+
+	// get/set index of the next number of the stream
+	Uint64			GetPosition();
+	void			SetPosition( Uint64 position );
+
+	// returns next number of the stream (0 ... 2^32-1)
+	Uint32			NextUint();
+
+	// returns next number of the stream as a float in [0, 1)
+	float			NextFloat();
+
+	// returns next number of the stream as a float in [-1, 1)
+	float			NextSigned();
+
+	// returns next number of the stream as an integer in [0, count)
+	int				NextInt( int count );
+
+	// fill an array with the next numbers of the stream as floats in [minValue, maxValue)
+	void			FillFloats( float *values, int count, float minValue, float maxValue );
+
+	// set the seed used by streams created with the default constructor and restart stream ids from 0;
+	// an application setting the same global seed and creating its objects in the same order gets the
+	// same random numbers
+	static void		SetGlobalSeed( Uint32 seed );
+
+private:
+
+	// key of the generator (seed and stream id)
+	Uint32			key[ 2 ];
+	// index of the next block of 4 numbers
+	Uint64			counter;
+	// numbers of the current block
+	Uint32			block[ 4 ];
+	// index of the next number of the current block (4 = block used)
+	int				blockIndex;
+
+	// generate the block of the counter and increment the counter
+	void			NextBlock();
+};
+
+#endif
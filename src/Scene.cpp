@@ -6,6 +6,17 @@
 
 #include <stdio.h>
 #include "Scene.h"
+#include "ActionManager.h"
+
+Scene::Scene()
+{
+	totalClickables = 0;
+	for( int i = 0; i < SCENE_MAX_CLICKABLES; i++ ) {
+		clickables[ i ] = 0;
+	}
+	actionTimeline = new ActionTimeline();
+	timeScale = 1.0f;
+}
 
 Scene::Scene( unsigned int tag ) 
 {
@@ -14,6 +25,41 @@ Scene::Scene( unsigned int tag )
 	for( int i = 0; i < SCENE_MAX_CLICKABLES; i++ ) {
 		clickables[ i ] = 0;
 	}
+	actionTimeline = new ActionTimeline();
+	timeScale = 1.0f;
+}
+
+Scene::~Scene()
+{
+	delete actionTimeline;
+}
+
+ActionTimeline* Scene::GetActionTimeline()
+{
+	return actionTimeline;
+}
+
+void Scene::PauseActions()
+{
+	actionTimeline->SetPaused( true );
+}
+
+void Scene::ResumeActions()
+{
+	actionTimeline->SetPaused( false );
+}
+
+void Scene::SetTimeScale( float scale )
+{
+	if( scale < 0 ) {
+		scale = 0;
+	}
+	timeScale = scale;
+}
+
+float Scene::GetTimeScale()
+{
+	return timeScale;
 }
 
 void Scene::Initialize()
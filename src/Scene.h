@@ -12,13 +12,18 @@
 // this is the maximum number of clickable object inside a scene
 #define SCENE_MAX_CLICKABLES	128
 
+// sequences of actions of a scene (see ActionManager.h)
+class ActionTimeline;
+
 class  Scene : public Node {
 
 public:
 
 	// object Scene constructor
-	Scene() {};
+	Scene();
 	Scene( unsigned int tag );
+	// object Scene destructor
+	~Scene();
 
 	// add a new clickable object in current scene
 	bool			AddClickable( Node *node );
@@ -28,6 +33,17 @@ public:
 
 	virtual void	Initialize();
 
+	// return the timeline of the sequences of actions of the scene's objects
+	ActionTimeline*	GetActionTimeline();
+
+	// freeze/resume the sequences of actions of the scene (they are frozen anyway while the scene is not displayed)
+	void			PauseActions();
+	void			ResumeActions();
+
+	// set/get time scale of the scene objects (actions, animated sprites, particles), it is multiplied by the global one (see Clock.h)
+	void			SetTimeScale( float scale );
+	float			GetTimeScale();
+
 	// total number of clickable objects
 	long			totalClickables;
 	// pointers of clickable objects
@@ -35,6 +51,12 @@ public:
 
 private:
 
+	// sequences of actions of the scene's objects
+	ActionTimeline	*actionTimeline;
+
+	// time scale of the scene
+	float			timeScale;
+
 	// used by RemoveClickable
 	void			RemoveClickableAt( unsigned int index );
 
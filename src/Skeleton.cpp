@@ -0,0 +1,412 @@
+/*
+ 	The information contained herein is confidential.
+ 	The use, copying, transfer or disclosure of such information is proibited
+ 	except by press written agreement with the author
+*/
+
+#define _USE_MATH_DEFINES
+#include <math.h>
+#include <stdio.h>
+#include "Skeleton.h"
+#include "Engine.h"
+#include "Clock.h"
+
+#ifndef M_PI
+#define M_PI		3.14159265358979323846
+#endif
+
+// ================================== SkeletonData =============================================
+
+SkeletonData::SkeletonData()
+{
+	totalPages			= 0;
+	totalBones			= 0;
+	totalAttachments	= 0;
+	totalAnimations		= 0;
+	keysVersion			= 0;
+	for( int i = 0; i < SKELETON_MAX_PAGES; i++ ) {
+		pages[ i ]		= NULL;
+		pageWidth[ i ]	= 0;
+		pageHeight[ i ]	= 0;
+	}
+}
+
+int SkeletonData::AddPage( SDL_Texture *texture )
+{
+	if( ( texture == NULL ) || ( totalPages >= SKELETON_MAX_PAGES ) ) {
+		printf( "SkeletonData::AddPage: invalid texture or too many pages\n" );
+		return -1;
+	}
+	pages[ totalPages ] = texture;
+	// size of the page is needed to compute texture coordinates
+	SDL_QueryTexture( texture, NULL, NULL, &pageWidth[ totalPages ], &pageHeight[ totalPages ] );
+	totalPages += 1;
+	return totalPages - 1;
+}
+
+int SkeletonData::AddBone( int parent, float x, float y, float rotation, float scaleX, float scaleY )
+{
+	// bones are evaluated in order, so the parent must already exist
+	if( ( totalBones >= SKELETON_MAX_BONES ) || ( parent >= totalBones ) ) {
+		printf( "SkeletonData::AddBone: too many bones or invalid parent %d\n", parent );
+		return -1;
+	}
+	Bone_t &bone	= bones[ totalBones ];
+	bone.parent		= ( parent < 0 ? -1 : parent );
+	bone.x			= x;
+	bone.y			= y;
+	bone.rotation	= rotation;
+	bone.scaleX		= scaleX;
+	bone.scaleY		= scaleY;
+	totalBones += 1;
+	return totalBones - 1;
+}
+
+int SkeletonData::AddAttachment( int bone, int page, SDL_Rect source, float x, float y )
+{
+	if( ( totalAttachments >= SKELETON_MAX_ATTACHMENTS ) || ( bone < 0 ) || ( bone >= totalBones ) || ( page < 0 ) || ( page >= totalPages ) ) {
+		printf( "SkeletonData::AddAttachment: too many attachments or invalid bone/page\n" );
+		return -1;
+	}
+	Attachment_t &attachment	= attachments[ totalAttachments ];
+	attachment.bone				= bone;
+	attachment.page				= page;
+	attachment.source			= source;
+	attachment.x				= x;
+	attachment.y				= y;
+	totalAttachments += 1;
+	return totalAttachments - 1;
+}
+
+int SkeletonData::AddAnimation( float duration )
+{
+	if( ( totalAnimations >= SKELETON_MAX_ANIMATIONS ) || ( duration <= 0 ) ) {
+		printf( "SkeletonData::AddAnimation: too many animations or invalid duration\n" );
+		return -1;
+	}
+	animations[ totalAnimations ].duration = duration;
+	animations[ totalAnimations ].tracks.clear();
+	totalAnimations += 1;
+	return totalAnimations - 1;
+}
+
+bool SkeletonData::AddKey( int animation, int bone, SkeletonChannel_t channel, float time, float value1, float value2 )
+{
+	if( ( animation < 0 ) || ( animation >= totalAnimations ) || ( bone < 0 ) || ( bone >= totalBones ) || ( channel >= SKELETON_CHANNEL_TOTAL ) ) {
+		printf( "SkeletonData::AddKey: invalid animation, bone or channel\n" );
+		return false;
+	}
+	std::vector<Track_t> &tracks = animations[ animation ].tracks;
+	// search the track of the bone channel...
+	unsigned int t = 0;
+	while( ( t < tracks.size() ) && ( ( tracks[ t ].bone != bone ) || ( tracks[ t ].channel != channel ) ) ) {
+		t += 1;
+	}
+	// ...or create it
+	if( t == tracks.size() ) {
+		Track_t track;
+		track.bone		= bone;
+		track.channel	= channel;
+		tracks.push_back( track );
+	}
+	std::vector<Key_t> &keys = tracks[ t ].keys;
+	if( !keys.empty() && ( keys.back().time > time ) ) {
+		printf( "SkeletonData::AddKey: keys must be added in time order\n" );
+		return false;
+	}
+	Key_t key;
+	key.time	= time;
+	key.value1	= value1;
+	key.value2	= value2;
+	keys.push_back( key );
+	// skeletons playing the animation must search their keys again
+	keysVersion += 1;
+	return true;
+}
+
+int SkeletonData::GetTotalBones()
+{
+	return totalBones;
+}
+
+float SkeletonData::GetAnimationDuration( int animation )
+{
+	if( ( animation < 0 ) || ( animation >= totalAnimations ) ) {
+		return 0;
+	}
+	return animations[ animation ].duration;
+}
+
+// ================================== Skeleton =============================================
+
+Skeleton::Skeleton( SkeletonData *data, unsigned int tag, unsigned int zOrder )
+{
+	this->data		= data;
+	this->tag		= tag;
+	this->zOrder	= zOrder;
+	this->animation	= -1;
+	this->time		= 0;
+	this->loop		= false;
+	this->playing	= false;
+	this->cursorsVersion = data->keysVersion;
+
+#ifdef SKELETON_USE_RENDER_GEOMETRY
+	// each attachment is a quad made of two triangles
+	for( int i = 0; i < SKELETON_MAX_ATTACHMENTS; i++ ) {
+		indices[ i * 6 + 0 ] = i * 4 + 0;
+		indices[ i * 6 + 1 ] = i * 4 + 1;
+		indices[ i * 6 + 2 ] = i * 4 + 2;
+		indices[ i * 6 + 3 ] = i * 4 + 2;
+		indices[ i * 6 + 4 ] = i * 4 + 3;
+		indices[ i * 6 + 5 ] = i * 4 + 0;
+	}
+#endif
+	// start from the setup pose
+	UpdatePose( 0 );
+}
+
+void Skeleton::Play( int animation, bool loop )
+{
+	if( ( animation < 0 ) || ( animation >= data->totalAnimations ) ) {
+		printf( "Skeleton::Play: invalid animation %d\n", animation );
+		return;
+	}
+	this->animation	= animation;
+	this->loop		= loop;
+	this->time		= 0;
+	this->playing	= true;
+	// reset search position of all tracks
+	cursors.assign( data->animations[ animation ].tracks.size(), 0 );
+	cursorsVersion	= data->keysVersion;
+}
+
+void Skeleton::Stop()
+{
+	animation	= -1;
+	playing		= false;
+	time		= 0;
+}
+
+bool Skeleton::IsPlaying()
+{
+	return playing;
+}
+
+void Skeleton::OnClick()
+{
+	Engine::GetConfig()->ObjectClickedCallback( this, tag );
+}
+
+void Skeleton::UpdatePose( float deltaTime )
+{
+	// start from the setup pose
+	for( int i = 0; i < data->totalBones; i++ ) {
+		const SkeletonData::Bone_t &bone = data->bones[ i ];
+		poseX[ i ]			= bone.x;
+		poseY[ i ]			= bone.y;
+		poseRotation[ i ]	= bone.rotation;
+		poseScaleX[ i ]		= bone.scaleX;
+		poseScaleY[ i ]		= bone.scaleY;
+		poseAlpha[ i ]		= 255;
+	}
+	if( animation < 0 ) {
+		return;
+	}
+	SkeletonData::Animation_t &anim = data->animations[ animation ];
+	// keys (or tracks) added after Play invalidate the search positions
+	if( cursorsVersion != data->keysVersion ) {
+		cursors.assign( anim.tracks.size(), 0 );
+		cursorsVersion = data->keysVersion;
+	}
+
+	// advance the time of the animation
+	if( playing ) {
+		time += deltaTime;
+		if( time >= anim.duration ) {
+			if( loop ) {
+				time = fmodf( time, anim.duration );
+			} else {
+				// a completed animation keeps its last pose
+				time	= anim.duration;
+				playing	= false;
+			}
+		}
+	}
+
+	// apply all tracks
+	for( unsigned int t = 0; t < anim.tracks.size(); t++ ) {
+		const SkeletonData::Track_t &track = anim.tracks[ t ];
+		unsigned int totalKeys = track.keys.size();
+		if( totalKeys == 0 ) {
+			continue;
+		}
+		// the time usually moves forward from the previous frame: search the key from the previous one
+		unsigned int k = cursors[ t ];
+		if( ( k >= totalKeys ) || ( track.keys[ k ].time > time ) ) {
+			k = 0;
+		}
+		while( ( k + 1 < totalKeys ) && ( track.keys[ k + 1 ].time <= time ) ) {
+			k += 1;
+		}
+		cursors[ t ] = k;
+		// interpolate between the current and the next key
+		const SkeletonData::Key_t &key = track.keys[ k ];
+		float value1 = key.value1;
+		float value2 = key.value2;
+		if( ( k + 1 < totalKeys ) && ( time > key.time ) ) {
+			const SkeletonData::Key_t &next = track.keys[ k + 1 ];
+			float percentage = ( time - key.time ) / ( next.time - key.time );
+			value1 += ( next.value1 - key.value1 ) * percentage;
+			value2 += ( next.value2 - key.value2 ) * percentage;
+		}
+		// apply to the bone
+		int bone = track.bone;
+		switch( track.channel ) {
+			case SKELETON_CHANNEL_TRANSLATE:
+				poseX[ bone ] += value1;
+				poseY[ bone ] += value2;
+				break;
+			case SKELETON_CHANNEL_ROTATE:
+				poseRotation[ bone ] += value1;
+				break;
+			case SKELETON_CHANNEL_SCALE:
+				poseScaleX[ bone ] *= value1;
+				poseScaleY[ bone ] *= value2;
+				break;
+			case SKELETON_CHANNEL_ALPHA:
+				poseAlpha[ bone ] = value1;
+				break;
+			default:
+				break;
+		}
+	}
+}
+
+void Skeleton::UpdateTransforms()
+{
+	// the node itself is the root of the skeleton
+	Transform_t root;
+	Coord_t position	= GetWorldPosition();
+	float radians		= angle * (float)M_PI / 180.0f;
+	float cosine		= cosf( radians );
+	float sine			= sinf( radians );
+	root.a		= cosine * sizeX;
+	root.b		= -sine * sizeY;
+	root.c		= sine * sizeX;
+	root.d		= cosine * sizeY;
+	root.tx		= position.x;
+	root.ty		= position.y;
+	root.alpha	= alpha / 255.0f;
+
+	// parents always come before their children, so a single pass computes all transforms
+	for( int i = 0; i < data->totalBones; i++ ) {
+		int parentIndex = data->bones[ i ].parent;
+		const Transform_t &parent = ( parentIndex < 0 ? root : world[ parentIndex ] );
+		// local transform of the bone
+		radians		= poseRotation[ i ] * (float)M_PI / 180.0f;
+		cosine		= cosf( radians );
+		sine		= sinf( radians );
+		float la	= cosine * poseScaleX[ i ];
+		float lb	= -sine * poseScaleY[ i ];
+		float lc	= sine * poseScaleX[ i ];
+		float ld	= cosine * poseScaleY[ i ];
+		// world = parent * local
+		Transform_t &t = world[ i ];
+		t.a		= parent.a * la + parent.b * lc;
+		t.b		= parent.a * lb + parent.b * ld;
+		t.c		= parent.c * la + parent.d * lc;
+		t.d		= parent.c * lb + parent.d * ld;
+		t.tx	= parent.a * poseX[ i ] + parent.b * poseY[ i ] + parent.tx;
+		t.ty	= parent.c * poseX[ i ] + parent.d * poseY[ i ] + parent.ty;
+		t.alpha	= parent.alpha * poseAlpha[ i ] / 255.0f;
+	}
+}
+
+void Skeleton::DrawAttachments()
+{
+	SDL_Renderer *renderer = Engine::GetRenderer();
+
+#ifdef SKELETON_USE_RENDER_GEOMETRY
+	// consecutive attachments of the same page are drawn with a single call
+	int totalQuads	= 0;
+	int batchPage	= -1;
+	for( int i = 0; i <= data->totalAttachments; i++ ) {
+		// flush the batch at the end or when the page changes
+		if( ( i == data->totalAttachments ) || ( ( batchPage >= 0 ) && ( data->attachments[ i ].page != batchPage ) ) ) {
+			if( totalQuads > 0 ) {
+				SDL_SetTextureAlphaMod( data->pages[ batchPage ], 255 );
+				SDL_RenderGeometry( renderer, data->pages[ batchPage ], vertices, totalQuads * 4, indices, totalQuads * 6 );
+			}
+			totalQuads = 0;
+			if( i == data->totalAttachments ) {
+				break;
+			}
+		}
+		const SkeletonData::Attachment_t &attachment = data->attachments[ i ];
+		const Transform_t &t = world[ attachment.bone ];
+		batchPage = attachment.page;
+		if( t.alpha <= 0 ) {
+			continue;
+		}
+		// corners of the image in bone space and their texture coordinates
+		float x0 = attachment.x;
+		float y0 = attachment.y;
+		float x1 = attachment.x + attachment.source.w;
+		float y1 = attachment.y + attachment.source.h;
+		float u0 = (float)attachment.source.x / data->pageWidth[ attachment.page ];
+		float v0 = (float)attachment.source.y / data->pageHeight[ attachment.page ];
+		float u1 = (float)( attachment.source.x + attachment.source.w ) / data->pageWidth[ attachment.page ];
+		float v1 = (float)( attachment.source.y + attachment.source.h ) / data->pageHeight[ attachment.page ];
+		float cx[ 4 ] = { x0, x1, x1, x0 };
+		float cy[ 4 ] = { y0, y0, y1, y1 };
+		float cu[ 4 ] = { u0, u1, u1, u0 };
+		float cv[ 4 ] = { v0, v0, v1, v1 };
+		Uint8 vertexAlpha = (Uint8)( t.alpha * 255 );
+		SDL_Vertex *v = &vertices[ totalQuads * 4 ];
+		for( int j = 0; j < 4; j++ ) {
+			v[ j ].position.x	= t.a * cx[ j ] + t.b * cy[ j ] + t.tx;
+			v[ j ].position.y	= t.c * cx[ j ] + t.d * cy[ j ] + t.ty;
+			v[ j ].color.r		= 255;
+			v[ j ].color.g		= 255;
+			v[ j ].color.b		= 255;
+			v[ j ].color.a		= vertexAlpha;
+			v[ j ].tex_coord.x	= cu[ j ];
+			v[ j ].tex_coord.y	= cv[ j ];
+		}
+		totalQuads += 1;
+	}
+#else
+	// without SDL_RenderGeometry each attachment is drawn rotated, scaled and flipped around its center (no skew)
+	for( int i = 0; i < data->totalAttachments; i++ ) {
+		const SkeletonData::Attachment_t &attachment = data->attachments[ i ];
+		const Transform_t &t = world[ attachment.bone ];
+		if( t.alpha <= 0 ) {
+			continue;
+		}
+		float centerX	= attachment.x + attachment.source.w / 2.0f;
+		float centerY	= attachment.y + attachment.source.h / 2.0f;
+		float worldX	= t.a * centerX + t.b * centerY + t.tx;
+		float worldY	= t.c * centerX + t.d * centerY + t.ty;
+		float scaleX	= sqrtf( t.a * t.a + t.c * t.c );
+		float scaleY	= sqrtf( t.b * t.b + t.d * t.d );
+		// a negative determinant means the bone is mirrored: the y axis is flipped after the rotation
+		// of the x axis (a mirrored x axis is the same flip rotated by 180 degrees)
+		SDL_RendererFlip flip = ( t.a * t.d - t.b * t.c < 0 ? SDL_FLIP_VERTICAL : SDL_FLIP_NONE );
+		SDL_Rect dstrect;
+		dstrect.w	= (int)( attachment.source.w * scaleX );
+		dstrect.h	= (int)( attachment.source.h * scaleY );
+		dstrect.x	= (int)( worldX - dstrect.w / 2.0f );
+		dstrect.y	= (int)( worldY - dstrect.h / 2.0f );
+		SDL_SetTextureAlphaMod( data->pages[ attachment.page ], (Uint8)( t.alpha * 255 ) );
+		SDL_RenderCopyEx( renderer, data->pages[ attachment.page ], &attachment.source, &dstrect, atan2f( t.c, t.a ) * 180.0f / (float)M_PI, NULL, flip );
+	}
+#endif
+}
+
+void Skeleton::Draw()
+{
+	// evaluate all bones and draw them
+	UpdatePose( (float)Clock::GetSceneDeltaTime() );
+	UpdateTransforms();
+	DrawAttachments();
+}
@@ -0,0 +1,232 @@
+/*
+ 	The information contained herein is confidential.
+ 	The use, copying, transfer or disclosure of such information is proibited
+ 	except by press written agreement with the author
+*/
+
+#ifndef _SKELETON_H_INCLUDE
+#define _SKELETON_H_INCLUDE
+
+#include <SDL.h>
+#include <vector>
+#include "Node.h"
+
+// maximum number of atlas pages of a skeleton
+#define SKELETON_MAX_PAGES				4
+// maximum number of bones of a skeleton
+#define SKELETON_MAX_BONES				64
+// maximum number of attachments (images) of a skeleton
+#define SKELETON_MAX_ATTACHMENTS		128
+// maximum number of animations of a skeleton
+#define SKELETON_MAX_ANIMATIONS			32
+
+// SDL_RenderGeometry is available from SDL 2.0.18, older versions draw each attachment with SDL_RenderCopyEx
+#if SDL_VERSION_ATLEAST( 2, 0, 18 )
+#define SKELETON_USE_RENDER_GEOMETRY
+#endif
+
+// animated property of a bone
+typedef enum {
+	SKELETON_CHANNEL_TRANSLATE,		// offset (x, y) added to the setup position
+	SKELETON_CHANNEL_ROTATE,		// angle (degrees) added to the setup rotation
+	SKELETON_CHANNEL_SCALE,			// scale (x, y) multiplied by the setup scale
+	SKELETON_CHANNEL_ALPHA,			// alpha (0 ... 255) of the bone, inherited by children
+	SKELETON_CHANNEL_TOTAL
+} SkeletonChannel_t;
+
+/*
+	SkeletonData describes a cutout character: a hierarchy of bones, the images (attachments) bound to the bones
+	and the keyframed animations of the bones. Images are portions of a few atlas textures (pages).
+	Data is built once and shared by any number of Skeleton nodes, it must not be deleted while they exist.
+	Example:
+		SkeletonData *data = new SkeletonData();
+		int page	= data->AddPage( atlasTexture );
+		int body	= data->AddBone( -1, 0, 0, 0, 1, 1 );
+		int arm		= data->AddBone( body, 20, -10, 0, 1, 1 );
+		data->AddAttachment( body, page, bodyRect, -30, -40 );
+		data->AddAttachment( arm, page, armRect, 0, -5 );
+		int wave	= data->AddAnimation( 1000 );
+		data->AddKey( wave, arm, SKELETON_CHANNEL_ROTATE, 0, 0 );
+		data->AddKey( wave, arm, SKELETON_CHANNEL_ROTATE, 500, 45 );
+		data->AddKey( wave, arm, SKELETON_CHANNEL_ROTATE, 1000, 0 );
+*/
+class SkeletonData {
+
+public:
+
+	// constructor
+	SkeletonData();
+
+	// add an atlas texture, returns the index of the page or -1 on error
+	int				AddPage( SDL_Texture *texture );
+
+	// add a bone with its setup pose (relative to the parent bone, -1 for the root), returns the index
+	// of the bone or -1 on error; the parent must be added before its children
+	int				AddBone( int parent, float x, float y, float rotation, float scaleX, float scaleY );
+
+	// add an image (a rect of a page) bound to a bone, x and y are the top left corner in bone space;
+	// attachments are drawn in the order they are added, returns the index of the attachment or -1 on error
+	int				AddAttachment( int bone, int page, SDL_Rect source, float x, float y );
+
+	// add an animation, returns the index of the animation or -1 on error
+	int				AddAnimation( float duration );
+
+	// add a keyframe (time in milliseconds) to an animation, keys of a bone channel must be added in time order;
+	// value2 is used only by translate and scale channels
+	bool			AddKey( int animation, int bone, SkeletonChannel_t channel, float time, float value1, float value2 = 0 );
+
+	// returns total number of bones
+	int				GetTotalBones();
+
+	// returns duration of an animation (milliseconds)
+	float			GetAnimationDuration( int animation );
+
+private:
+
+	friend class Skeleton;
+
+	// bone setup pose
+	typedef struct {
+		int			parent;
+		float		x;
+		float		y;
+		float		rotation;
+		float		scaleX;
+		float		scaleY;
+	} Bone_t;
+
+	// image bound to a bone
+	typedef struct {
+		int			bone;
+		int			page;
+		SDL_Rect	source;
+		float		x;
+		float		y;
+	} Attachment_t;
+
+	// a key of a track
+	typedef struct {
+		float		time;
+		float		value1;
+		float		value2;
+	} Key_t;
+
+	// keys of a channel of a bone
+	typedef struct {
+		int					bone;
+		SkeletonChannel_t	channel;
+		std::vector<Key_t>	keys;
+	} Track_t;
+
+	// animation
+	typedef struct {
+		float					duration;
+		std::vector<Track_t>	tracks;
+	} Animation_t;
+
+	SDL_Texture		*pages[ SKELETON_MAX_PAGES ];
+	int				pageWidth[ SKELETON_MAX_PAGES ];
+	int				pageHeight[ SKELETON_MAX_PAGES ];
+	int				totalPages;
+
+	Bone_t			bones[ SKELETON_MAX_BONES ];
+	int				totalBones;
+
+	Attachment_t	attachments[ SKELETON_MAX_ATTACHMENTS ];
+	int				totalAttachments;
+
+	Animation_t		animations[ SKELETON_MAX_ANIMATIONS ];
+	int				totalAnimations;
+
+	// incremented each time a key is added, skeletons reset their track cursors when it changes
+	unsigned int	keysVersion;
+};
+
+/*
+	Skeleton is a node that plays the animations of a SkeletonData.
+	Each frame all bones are evaluated in a single pass (animation keys, then world transforms from parents to
+	children) and all attachments sharing a page are drawn with a single SDL_RenderGeometry call.
+	The position, angle, size and alpha of the node are applied to the whole skeleton.
+	Without SDL_RenderGeometry (SDL older than 2.0.18) each attachment is drawn with SDL_RenderCopyEx: rotation,
+	scale and mirroring of the bones are kept but skew (non uniform scale of a rotated parent) is not supported.
+*/
+class Skeleton : public Node {
+
+public:
+
+	// constructor
+	Skeleton( SkeletonData *data, unsigned int tag, unsigned int zOrder );
+
+	// play an animation once or continuously
+	void			Play( int animation, bool loop );
+
+	// stop the animation and return to the setup pose
+	void			Stop();
+
+	// returns true if an animation is playing
+	bool			IsPlaying();
+
+	// ========================= functions below are used internally, don't use in the game =======================
+
+	// function called each frame (override of function in Node class)
+	void			Draw();
+
+	// perform action if object is touched by the user
+	void			OnClick();
+
+private:
+
+	// world transform of a bone: x' = a * x + b * y + tx, y' = c * x + d * y + ty
+	typedef struct {
+		float		a;
+		float		b;
+		float		c;
+		float		d;
+		float		tx;
+		float		ty;
+		float		alpha;
+	} Transform_t;
+
+	// shared data
+	SkeletonData	*data;
+	// current animation (-1 if none)
+	int				animation;
+	// current time of the animation
+	float			time;
+	// true if the animation restarts when completed
+	bool			loop;
+	// true while the animation is running (a completed animation keeps its last pose)
+	bool			playing;
+	// index of the current key of each track of the animation (tracks are searched from here)
+	std::vector<unsigned int>	cursors;
+	// keysVersion of the data when the cursors have been reset
+	unsigned int	cursorsVersion;
+
+	// current local pose of the bones
+	float			poseX[ SKELETON_MAX_BONES ];
+	float			poseY[ SKELETON_MAX_BONES ];
+	float			poseRotation[ SKELETON_MAX_BONES ];
+	float			poseScaleX[ SKELETON_MAX_BONES ];
+	float			poseScaleY[ SKELETON_MAX_BONES ];
+	float			poseAlpha[ SKELETON_MAX_BONES ];
+	// world transforms of the bones
+	Transform_t		world[ SKELETON_MAX_BONES ];
+
+#ifdef SKELETON_USE_RENDER_GEOMETRY
+	// vertices of the current batch (4 for each attachment)
+	SDL_Vertex		vertices[ SKELETON_MAX_ATTACHMENTS * 4 ];
+	// indices of the quads (the same for every frame)
+	int				indices[ SKELETON_MAX_ATTACHMENTS * 6 ];
+#endif
+
+	// advance the animation and compute the local pose of all bones
+	void			UpdatePose( float deltaTime );
+
+	// compute world transforms of all bones
+	void			UpdateTransforms();
+
+	// draw all attachments
+	void			DrawAttachments();
+};
+
+#endif
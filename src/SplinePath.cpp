@@ -0,0 +1,184 @@
+/*
+ 	The information contained herein is confidential.
+ 	The use, copying, transfer or disclosure of such information is proibited
+ 	except by press written agreement with the author
+*/
+
+#include <stdio.h>
+#include <math.h>
+#include "SplinePath.h"
+
+// if the cursor is farther than this number of samples from the searched distance a binary search is performed
+#define SPLINEPATH_CURSOR_MAX_STEPS			8
+
+SplinePath::SplinePath( unsigned int totalPoints, const Coord_t *points, float tension )
+{
+	refCount		= 1;
+	segments		= NULL;
+	totalSegments	= 0;
+	lengths			= NULL;
+	totalSamples	= 0;
+	start.x			= 0;
+	start.y			= 0;
+
+	if( totalPoints == 0 ) {
+		printf( "SplinePath: no points\n" );
+		return;
+	}
+	start = points[ 0 ];
+	if( totalPoints == 1 ) {
+		return;
+	}
+
+	// compute the coefficients of each segment (from point i to point i + 1), first and last points are 
+	// repeated to have the neighbors of the first and last segments
+	float s = ( 1 - tension ) / 2;
+	totalSegments	= totalPoints - 1;
+	segments		= new Segment_t[ totalSegments ];
+	for( unsigned int i = 0; i < totalSegments; i++ ) {
+		const Coord_t &p0 = points[ i > 0 ? i - 1 : 0 ];
+		const Coord_t &p1 = points[ i ];
+		const Coord_t &p2 = points[ i + 1 ];
+		const Coord_t &p3 = points[ i + 2 < totalPoints ? i + 2 : totalPoints - 1 ];
+		segments[ i ].a.x = -s * p0.x + ( 2 - s ) * p1.x + ( s - 2 ) * p2.x + s * p3.x;
+		segments[ i ].a.y = -s * p0.y + ( 2 - s ) * p1.y + ( s - 2 ) * p2.y + s * p3.y;
+		segments[ i ].b.x = 2 * s * p0.x + ( s - 3 ) * p1.x + ( 3 - 2 * s ) * p2.x - s * p3.x;
+		segments[ i ].b.y = 2 * s * p0.y + ( s - 3 ) * p1.y + ( 3 - 2 * s ) * p2.y - s * p3.y;
+		segments[ i ].c.x = -s * p0.x + s * p2.x;
+		segments[ i ].c.y = -s * p0.y + s * p2.y;
+		segments[ i ].d.x = p1.x;
+		segments[ i ].d.y = p1.y;
+	}
+
+	// measure the path: cumulative length at each sample
+	totalSamples	= totalSegments * SPLINEPATH_SAMPLES_PER_SEGMENT;
+	lengths			= new float[ totalSamples + 1 ];
+	lengths[ 0 ]	= 0;
+	Coord_t previous = start;
+	for( unsigned int i = 1; i <= totalSamples; i++ ) {
+		unsigned int segment = ( i - 1 ) / SPLINEPATH_SAMPLES_PER_SEGMENT;
+		float t = (float)( i - segment * SPLINEPATH_SAMPLES_PER_SEGMENT ) / SPLINEPATH_SAMPLES_PER_SEGMENT;
+		Coord_t current = GetSegmentPosition( segment, t );
+		float dx = current.x - previous.x;
+		float dy = current.y - previous.y;
+		lengths[ i ] = lengths[ i - 1 ] + sqrtf( dx * dx + dy * dy );
+		previous = current;
+	}
+}
+
+SplinePath::~SplinePath()
+{
+	delete [] segments;
+	delete [] lengths;
+}
+
+void SplinePath::Retain()
+{
+	refCount += 1;
+}
+
+void SplinePath::Release()
+{
+	refCount -= 1;
+	if( refCount <= 0 ) {
+		delete this;
+	}
+}
+
+float SplinePath::GetLength()
+{
+	return ( totalSamples > 0 ? lengths[ totalSamples ] : 0 );
+}
+
+unsigned int SplinePath::GetTotalPoints()
+{
+	return ( segments != NULL ? totalSegments + 1 : 1 );
+}
+
+Coord_t SplinePath::GetSegmentPosition( unsigned int segment, float t )
+{
+	const Segment_t &seg = segments[ segment ];
+	Coord_t result;
+	result.x = ( ( seg.a.x * t + seg.b.x ) * t + seg.c.x ) * t + seg.d.x;
+	result.y = ( ( seg.a.y * t + seg.b.y ) * t + seg.c.y ) * t + seg.d.y;
+	return result;
+}
+
+// returns the index i of the sample such as lengths[ i ] <= distance <= lengths[ i + 1 ]
+unsigned int SplinePath::FindSample( float distance, unsigned int cursor )
+{
+	if( cursor >= totalSamples ) {
+		cursor = totalSamples - 1;
+	}
+	// objects moving along the path usually are in the same sample or a few samples ahead
+	for( int steps = 0; steps < SPLINEPATH_CURSOR_MAX_STEPS; steps++ ) {
+		if( distance < lengths[ cursor ] ) {
+			if( cursor == 0 ) {
+				return 0;
+			}
+			cursor -= 1;
+		} else if( distance > lengths[ cursor + 1 ] ) {
+			if( cursor == totalSamples - 1 ) {
+				return cursor;
+			}
+			cursor += 1;
+		} else {
+			return cursor;
+		}
+	}
+	// too far from the cursor: binary search
+	unsigned int low	= 0;
+	unsigned int high	= totalSamples;
+	while( high - low > 1 ) {
+		unsigned int middle = ( low + high ) / 2;
+		if( lengths[ middle ] <= distance ) {
+			low = middle;
+		} else {
+			high = middle;
+		}
+	}
+	return ( low < totalSamples ? low : totalSamples - 1 );
+}
+
+Coord_t SplinePath::GetPositionAt( float distance, Coord_t *tangent, unsigned int *cursor )
+{
+	// a path with a single point has no direction
+	if( totalSamples == 0 ) {
+		if( tangent != NULL ) {
+			tangent->x = 1;
+			tangent->y = 0;
+		}
+		return start;
+	}
+	// clamp distance to the path
+	if( distance < 0 ) {
+		distance = 0;
+	} else if( distance > lengths[ totalSamples ] ) {
+		distance = lengths[ totalSamples ];
+	}
+	// find the sample and the position inside the sample
+	unsigned int sample = FindSample( distance, ( cursor != NULL ? *cursor : 0 ) );
+	if( cursor != NULL ) {
+		*cursor = sample;
+	}
+	float sampleLength	= lengths[ sample + 1 ] - lengths[ sample ];
+	float fraction		= ( sampleLength > 0 ? ( distance - lengths[ sample ] ) / sampleLength : 0 );
+	// convert into segment and t of the segment
+	unsigned int segment = sample / SPLINEPATH_SAMPLES_PER_SEGMENT;
+	float t = ( sample - segment * SPLINEPATH_SAMPLES_PER_SEGMENT + fraction ) / SPLINEPATH_SAMPLES_PER_SEGMENT;
+	// the tangent is the derivative of the segment
+	if( tangent != NULL ) {
+		const Segment_t &seg = segments[ segment ];
+		float dx = ( 3 * seg.a.x * t + 2 * seg.b.x ) * t + seg.c.x;
+		float dy = ( 3 * seg.a.y * t + 2 * seg.b.y ) * t + seg.c.y;
+		float length = sqrtf( dx * dx + dy * dy );
+		if( length > 0 ) {
+			tangent->x = dx / length;
+			tangent->y = dy / length;
+		} else {
+			tangent->x = 1;
+			tangent->y = 0;
+		}
+	}
+	return GetSegmentPosition( segment, t );
+}
@@ -0,0 +1,84 @@
+/*
+ 	The information contained herein is confidential.
+ 	The use, copying, transfer or disclosure of such information is proibited
+ 	except by press written agreement with the author
+*/
+
+#ifndef _SPLINEPATH_H_INCLUDE
+#define _SPLINEPATH_H_INCLUDE
+
+#include "EngineCommon.h"
+
+// number of samples of each segment of the path used to measure its length
+#define SPLINEPATH_SAMPLES_PER_SEGMENT		16
+
+/*
+	SplinePath is an immutable Cardinal spline passing through a list of points, built once and shared by
+	any number of actions (see SplineTo).
+	The constructor computes the coefficients of each segment and a table of the cumulative length of the 
+	path, so the path can be evaluated by distance from the start: objects following it move at constant
+	speed whatever the distance between points is.
+	The path is reference counted: it is created with one reference (owned by the creator), each action 
+	using it takes its own reference and the path is deleted when the last reference is released.
+*/
+class SplinePath {
+
+public:
+
+	// constructor: tension 0.0 is a Catmull-Rom spline, 1.0 gives straight segments
+	SplinePath( unsigned int totalPoints, const Coord_t *points, float tension );
+
+	// add a reference to the path
+	void			Retain();
+
+	// remove a reference to the path, the path is deleted when no references remain
+	void			Release();
+
+	// returns total length of the path
+	float			GetLength();
+
+	// returns total number of points of the path
+	unsigned int	GetTotalPoints();
+
+	/*
+		returns the position at a distance from the start of the path (clamped to the path length)
+		- tangent : if not NULL receives the direction (normalized) of the path at the position
+		- cursor : if not NULL it is used as starting point of the search and updated, objects moving along
+		  the path should keep it to find their position in constant time
+	*/
+	Coord_t			GetPositionAt( float distance, Coord_t *tangent, unsigned int *cursor );
+
+private:
+
+	// the path must be deleted through Release()
+	~SplinePath();
+
+	// coefficients of a segment of the path: position is ( ( a * t + b ) * t + c ) * t + d with t from 0.0 to 1.0
+	typedef struct {
+		Coord_t		a;
+		Coord_t		b;
+		Coord_t		c;
+		Coord_t		d;
+	} Segment_t;
+
+	// number of references to the path
+	int				refCount;
+	// segments of the path
+	Segment_t		*segments;
+	// total number of segments (number of points - 1)
+	unsigned int	totalSegments;
+	// cumulative length of the path at each sample (totalSegments * SPLINEPATH_SAMPLES_PER_SEGMENT + 1 values)
+	float			*lengths;
+	// total number of samples
+	unsigned int	totalSamples;
+	// position of the first point, used if the path has a single point
+	Coord_t			start;
+
+	// returns position of a segment at t
+	Coord_t			GetSegmentPosition( unsigned int segment, float t );
+
+	// find the sample interval containing a distance
+	unsigned int	FindSample( float distance, unsigned int cursor );
+};
+
+#endif
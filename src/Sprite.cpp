@@ -24,6 +24,11 @@ void Sprite::SetTexture( SDL_Texture *texture )
 	this->texture = texture;
 }
 
+SDL_Texture* Sprite::GetTexture()
+{
+	return texture;
+}
+
 // called if the Sprite is set as clickable and the player touch it
 void Sprite::OnClick()
 {
@@ -22,8 +22,9 @@ public:
 	*/
 	Sprite( SDL_Texture *texture, unsigned int tag, unsigned int zOrder );
 
-	// set a new texture 
+	// set/get the texture 
 	void SetTexture( SDL_Texture *texture );
+	SDL_Texture* GetTexture();
 
 	// ========================= functions below are used internally, don't use in the game =======================
 
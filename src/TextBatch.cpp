@@ -0,0 +1,148 @@
+/*
+ 	The information contained herein is confidential.
+ 	The use, copying, transfer or disclosure of such information is proibited
+ 	except by press written agreement with the author
+*/
+
+#define _USE_MATH_DEFINES
+#include <math.h>
+#include <vector>
+#include "TextBatch.h"
+#include "Engine.h"
+
+#ifndef M_PI
+#define M_PI		3.14159265358979323846
+#endif
+
+// glyph to draw
+typedef struct {
+	SDL_Texture			*texture;
+	SDL_Rect			source;
+	SDL_Rect			destination;
+	double				angle;
+	SDL_Point			center;
+	SDL_RendererFlip	flip;
+	SDL_Color			color;
+} BatchQuad_t;
+
+// glyphs added since last flush
+static std::vector<BatchQuad_t>		quads;
+
+#ifdef TEXTBATCH_USE_RENDER_GEOMETRY
+// vertices and indices (two triangles for each glyph) of the glyphs of a texture
+static std::vector<SDL_Vertex>		vertices;
+static std::vector<int>				indices;
+
+// draw quads [ first, last ) that share the same texture
+static void DrawGeometry( SDL_Renderer *renderer, int first, int last )
+{
+	SDL_Texture *texture = quads[ first ].texture;
+	int textureWidth, textureHeight;
+	int total = last - first;
+
+	SDL_QueryTexture( texture, NULL, NULL, &textureWidth, &textureHeight );
+	vertices.resize( total * 4 );
+	if( (int)indices.size() < total * 6 ) {
+		int previous = (int)indices.size() / 6;
+		indices.resize( total * 6 );
+		for( int i = previous; i < total; i++ ) {
+			indices[ i * 6 + 0 ] = i * 4 + 0;
+			indices[ i * 6 + 1 ] = i * 4 + 1;
+			indices[ i * 6 + 2 ] = i * 4 + 2;
+			indices[ i * 6 + 3 ] = i * 4 + 2;
+			indices[ i * 6 + 4 ] = i * 4 + 3;
+			indices[ i * 6 + 5 ] = i * 4 + 0;
+		}
+	}
+	for( int i = 0; i < total; i++ ) {
+		const BatchQuad_t &quad = quads[ first + i ];
+		// corners relative to the rotation center and texture coordinates (swapped when flipped)
+		float x0 = (float)-quad.center.x;
+		float y0 = (float)-quad.center.y;
+		float x1 = x0 + quad.destination.w;
+		float y1 = y0 + quad.destination.h;
+		float u0 = (float)quad.source.x / textureWidth;
+		float v0 = (float)quad.source.y / textureHeight;
+		float u1 = (float)( quad.source.x + quad.source.w ) / textureWidth;
+		float v1 = (float)( quad.source.y + quad.source.h ) / textureHeight;
+		if( quad.flip & SDL_FLIP_HORIZONTAL ) {
+			float swap = u0; u0 = u1; u1 = swap;
+		}
+		if( quad.flip & SDL_FLIP_VERTICAL ) {
+			float swap = v0; v0 = v1; v1 = swap;
+		}
+		float cx[ 4 ] = { x0, x1, x1, x0 };
+		float cy[ 4 ] = { y0, y0, y1, y1 };
+		float cu[ 4 ] = { u0, u1, u1, u0 };
+		float cv[ 4 ] = { v0, v0, v1, v1 };
+		float radians	= (float)( quad.angle * M_PI / 180.0 );
+		float cosine	= cosf( radians );
+		float sine		= sinf( radians );
+		float pivotX	= (float)( quad.destination.x + quad.center.x );
+		float pivotY	= (float)( quad.destination.y + quad.center.y );
+		SDL_Vertex *v = &vertices[ i * 4 ];
+		for( int j = 0; j < 4; j++ ) {
+			v[ j ].position.x	= pivotX + cx[ j ] * cosine - cy[ j ] * sine;
+			v[ j ].position.y	= pivotY + cx[ j ] * sine + cy[ j ] * cosine;
+			v[ j ].color		= quad.color;
+			v[ j ].tex_coord.x	= cu[ j ];
+			v[ j ].tex_coord.y	= cv[ j ];
+		}
+	}
+	// color is in the vertices
+	SDL_SetTextureColorMod( texture, 255, 255, 255 );
+	SDL_SetTextureAlphaMod( texture, 255 );
+	SDL_RenderGeometry( renderer, texture, &vertices[ 0 ], total * 4, &indices[ 0 ], total * 6 );
+}
+#endif
+
+void TextBatch::Add( SDL_Texture *texture, const SDL_Rect *source, const SDL_Rect *destination, double angle, const SDL_Point *center, SDL_RendererFlip flip, SDL_Color color )
+{
+	BatchQuad_t quad;
+	quad.texture		= texture;
+	quad.source			= *source;
+	quad.destination	= *destination;
+	quad.angle			= angle;
+	quad.flip			= flip;
+	quad.color			= color;
+	if( center != NULL ) {
+		quad.center		= *center;
+	} else {
+		quad.center.x	= destination->w / 2;
+		quad.center.y	= destination->h / 2;
+	}
+	quads.push_back( quad );
+}
+
+void TextBatch::Flush()
+{
+	if( quads.empty() ) {
+		return;
+	}
+	SDL_Renderer *renderer = Engine::GetRenderer();
+#ifdef TEXTBATCH_USE_RENDER_GEOMETRY
+	// consecutive glyphs of the same texture are drawn with a single call
+	int first = 0;
+	for( int i = 1; i <= (int)quads.size(); i++ ) {
+		if( ( i == (int)quads.size() ) || ( quads[ i ].texture != quads[ first ].texture ) ) {
+			DrawGeometry( renderer, first, i );
+			first = i;
+		}
+	}
+#else
+	// modulation is changed only when texture or color change
+	SDL_Texture *texture = NULL;
+	SDL_Color color = { 0, 0, 0, 0 };
+	for( size_t i = 0; i < quads.size(); i++ ) {
+		const BatchQuad_t &quad = quads[ i ];
+		if( ( quad.texture != texture ) || ( quad.color.r != color.r ) || ( quad.color.g != color.g ) || ( quad.color.b != color.b ) || ( quad.color.a != color.a ) ) {
+			texture	= quad.texture;
+			color	= quad.color;
+			SDL_SetTextureColorMod( texture, color.r, color.g, color.b );
+			SDL_SetTextureAlphaMod( texture, color.a );
+		}
+		SDL_RenderCopyEx( renderer, texture, &quad.source, &quad.destination, quad.angle, &quad.center, quad.flip );
+	}
+#endif
+	quads.clear();
+}
@@ -0,0 +1,32 @@
+/*
+ 	The information contained herein is confidential.
+ 	The use, copying, transfer or disclosure of such information is proibited
+ 	except by press written agreement with the author
+*/
+
+#ifndef _TEXTBATCH_H_INCLUDE
+#define _TEXTBATCH_H_INCLUDE
+
+#include <SDL.h>
+
+// SDL_RenderGeometry is available from SDL 2.0.18, older versions draw each glyph with SDL_RenderCopyEx (bitmap font
+// labels are then drawn from a texture of their text, see BMPLabelText)
+#if SDL_VERSION_ATLEAST( 2, 0, 18 )
+#define TEXTBATCH_USE_RENDER_GEOMETRY
+#endif
+
+/*
+	TextBatch collects the glyphs drawn by labels (bitmap fonts and glyph atlases) and draws them later, consecutive
+	glyphs of the same texture with a single call. Labels add their glyphs in Draw and the batch is drawn before the
+	next node that is not batched is drawn (see Node::Visit) and at the end of the scene, so the drawing order is kept.
+*/
+namespace TextBatch {
+
+	// add a glyph, parameters are the same of SDL_RenderCopyEx, color (and alpha) modulates the texture
+	void Add( SDL_Texture *texture, const SDL_Rect *source, const SDL_Rect *destination, double angle, const SDL_Point *center, SDL_RendererFlip flip, SDL_Color color );
+
+	// draw all glyphs added since previous call
+	void Flush();
+}
+
+#endif
@@ -0,0 +1,177 @@
+/*
+ 	The information contained herein is confidential.
+ 	The use, copying, transfer or disclosure of such information is proibited
+ 	except by press written agreement with the author
+*/
+
+#include <stdio.h>
+#include <string.h>
+#include <map>
+#include <list>
+#include "TextCache.h"
+#include "Engine.h"
+
+// order of keys (only the used part of the text is compared)
+struct KeyLess {
+	bool operator()( const TextCacheKey_t &a, const TextCacheKey_t &b ) const {
+		if( a.fontId != b.fontId )			return a.fontId < b.fontId;
+		if( a.fontSize != b.fontSize )		return a.fontSize < b.fontSize;
+		if( a.color != b.color )			return a.color < b.color;
+		if( a.encoding != b.encoding )		return a.encoding < b.encoding;
+		if( a.length != b.length )			return a.length < b.length;
+		return memcmp( a.text, b.text, a.length * sizeof( Uint16 ) ) < 0;
+	}
+};
+
+// cached texture
+struct Entry_t {
+	TextCacheKey_t				key;
+	SDL_Texture					*texture;
+	long						bytes;
+	int							references;
+	std::list<Entry_t*>::iterator	unused;		// position in the list of unused textures (when references is 0)
+};
+
+// textures by key and by pointer
+static std::map<TextCacheKey_t, Entry_t*, KeyLess>	entries;
+static std::map<SDL_Texture*, Entry_t*>				textures;
+// textures not referenced by any label, the most recently used first
+static std::list<Entry_t*>							unusedEntries;
+
+static long					budget		= TEXTCACHE_DEFAULT_BUDGET;
+static long					totalBytes	= 0;
+static long					unusedBytes	= 0;
+static long					hits		= 0;
+static long					misses		= 0;
+static long					evictions	= 0;
+
+// destroy a texture and remove it from the cache
+static void Destroy( Entry_t *entry )
+{
+	totalBytes -= entry->bytes;
+	entries.erase( entry->key );
+	textures.erase( entry->texture );
+	SDL_DestroyTexture( entry->texture );
+	delete entry;
+}
+
+// destroy least recently used textures until the budget is respected
+static void Evict()
+{
+	while( ( unusedBytes > budget ) && !unusedEntries.empty() ) {
+		Entry_t *entry = unusedEntries.back();
+		unusedEntries.pop_back();
+		unusedBytes -= entry->bytes;
+		evictions	+= 1;
+		Destroy( entry );
+	}
+}
+
+SDL_Texture* TextCache::Acquire( const TextCacheKey_t *key )
+{
+	std::map<TextCacheKey_t, Entry_t*, KeyLess>::iterator item = entries.find( *key );
+	if( item == entries.end() ) {
+		misses += 1;
+		return NULL;
+	}
+	Entry_t *entry = item->second;
+	if( entry->references == 0 ) {
+		unusedEntries.erase( entry->unused );
+		unusedBytes -= entry->bytes;
+	}
+	entry->references += 1;
+	hits += 1;
+	return entry->texture;
+}
+
+SDL_Texture* TextCache::Insert( const TextCacheKey_t *key, SDL_Surface *surface )
+{
+	SDL_Texture *texture = SDL_CreateTextureFromSurface( Engine::GetRenderer(), surface );
+	if( texture == NULL ) {
+		return NULL;
+	}
+	// if the text was already cached (e.g. Insert without Acquire) the old texture is kept by who uses it
+	std::map<TextCacheKey_t, Entry_t*, KeyLess>::iterator item = entries.find( *key );
+	if( item != entries.end() ) {
+		Entry_t *old = item->second;
+		entries.erase( item );
+		if( old->references == 0 ) {
+			unusedEntries.erase( old->unused );
+			unusedBytes -= old->bytes;
+			Destroy( old );
+		}
+	}
+	Entry_t *entry		= new Entry_t;
+	entry->key			= *key;
+	entry->texture		= texture;
+	entry->bytes		= surface->w * surface->h * 4;
+	entry->references	= 1;
+	entries[ *key ]		= entry;
+	textures[ texture ]	= entry;
+	totalBytes += entry->bytes;
+	return texture;
+}
+
+void TextCache::Release( SDL_Texture *texture )
+{
+	std::map<SDL_Texture*, Entry_t*>::iterator item = textures.find( texture );
+	if( item == textures.end() ) {
+		return;
+	}
+	Entry_t *entry = item->second;
+	entry->references -= 1;
+	if( entry->references == 0 ) {
+		// a replaced texture is no longer reachable by its key
+		std::map<TextCacheKey_t, Entry_t*, KeyLess>::iterator current = entries.find( entry->key );
+		if( ( current == entries.end() ) || ( current->second != entry ) ) {
+			totalBytes -= entry->bytes;
+			textures.erase( item );
+			SDL_DestroyTexture( texture );
+			delete entry;
+			return;
+		}
+		unusedEntries.push_front( entry );
+		entry->unused = unusedEntries.begin();
+		unusedBytes += entry->bytes;
+		Evict();
+	}
+}
+
+void TextCache::SetBudget( long bytes )
+{
+	budget = bytes;
+	Evict();
+}
+
+void TextCache::GetStatistics( TextCacheStatistics_t *statistics )
+{
+	statistics->hits			= hits;
+	statistics->misses			= misses;
+	statistics->evictions		= evictions;
+	statistics->totalTextures	= (int)textures.size();
+	statistics->usedTextures	= (int)( textures.size() - unusedEntries.size() );
+	statistics->totalBytes		= totalBytes;
+	statistics->unusedBytes		= unusedBytes;
+}
+
+void TextCache::PrintStatistics()
+{
+	long requests = hits + misses;
+	printf( "TextCache: %ld requests, hit rate %.1f%%, %ld evictions - %d textures (%d used), %ld bytes (%ld unused, budget %ld)\n",
+		requests, ( requests > 0 ? 100.0f * hits / requests : 0.0f ), evictions, (int)textures.size(),
+		(int)( textures.size() - unusedEntries.size() ), totalBytes, unusedBytes, budget );
+}
+
+void TextCache::Terminate()
+{
+	std::map<SDL_Texture*, Entry_t*>::iterator item;
+	for( item = textures.begin(); item != textures.end(); ++item ) {
+		SDL_DestroyTexture( item->first );
+		delete item->second;
+	}
+	entries.clear();
+	textures.clear();
+	unusedEntries.clear();
+	totalBytes	= 0;
+	unusedBytes	= 0;
+}
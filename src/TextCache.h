@@ -0,0 +1,75 @@
+/*
+ 	The information contained herein is confidential.
+ 	The use, copying, transfer or disclosure of such information is proibited
+ 	except by press written agreement with the author
+*/
+
+#ifndef _TEXTCACHE_H_INCLUDE
+#define _TEXTCACHE_H_INCLUDE
+
+#include <SDL.h>
+
+// maximum length of a cached text
+#define TEXTCACHE_MAX_TEXT_LENGTH		128
+// default memory used by textures not referenced by any label (bytes)
+#define TEXTCACHE_DEFAULT_BUDGET		( 4 * 1024 * 1024 )
+
+// encoding of the text (the same characters can be rendered differently)
+typedef enum {
+	TEXTCACHE_ENCODING_LATIN1,		// rendered with TTF_RenderText
+	TEXTCACHE_ENCODING_UTF16,		// rendered with TTF_RenderUNICODE
+	TEXTCACHE_ENCODING_MAX
+} TextEncoding_t;
+
+// what identifies a rasterized text
+typedef struct {
+	int			fontId;
+	int			fontSize;
+	Uint32		color;
+	int			encoding;
+	int			length;
+	Uint16		text[ TEXTCACHE_MAX_TEXT_LENGTH ];
+} TextCacheKey_t;
+
+// cache statistics
+typedef struct {
+	long		hits;			// requests found in the cache
+	long		misses;			// requests that needed a new texture
+	long		evictions;		// textures destroyed to stay within the budget
+	int			totalTextures;	// textures in the cache
+	int			usedTextures;	// textures referenced by at least a label
+	long		totalBytes;		// memory of all textures
+	long		unusedBytes;	// memory of textures not referenced by any label
+} TextCacheStatistics_t;
+
+/*
+	TextCache shares the textures of rasterized texts: labels showing the same text with the same font, size and
+	color use the same texture. Textures are reference counted, when no label uses a texture it stays in the cache
+	(so showing the text again doesn't need a new rasterization) until the memory of unused textures exceeds the
+	budget, then the least recently used are destroyed.
+*/
+namespace TextCache {
+
+	// returns the texture of a text and adds a reference, NULL if the text is not in the cache
+	SDL_Texture* Acquire( const TextCacheKey_t *key );
+
+	// create the texture of a text from its surface (with one reference), NULL if the texture can't be created
+	SDL_Texture* Insert( const TextCacheKey_t *key, SDL_Surface *surface );
+
+	// remove a reference from a texture returned by Acquire or Insert
+	void Release( SDL_Texture *texture );
+
+	// set the maximum memory (bytes) of textures not referenced by any label
+	void SetBudget( long bytes );
+
+	// get current statistics
+	void GetStatistics( TextCacheStatistics_t *statistics );
+
+	// print current statistics
+	void PrintStatistics();
+
+	// destroy all textures
+	void Terminate();
+}
+
+#endif
@@ -0,0 +1,192 @@
+/*
+ 	The information contained herein is confidential.
+ 	The use, copying, transfer or disclosure of such information is proibited
+ 	except by press written agreement with the author
+*/
+
+#include <stdio.h>
+#include "ThreadPool.h"
+
+// tasks of the same ParallelFor
+typedef struct {
+	ThreadPoolFunction_t	function;
+	void					*data;
+	SDL_atomic_t			remaining;		// tasks not yet completed
+} ThreadPoolJob_t;
+
+// a task waiting into the queue
+typedef struct {
+	ThreadPoolJob_t			*job;
+	int						index;
+} ThreadPoolTask_t;
+
+// worker threads
+static SDL_Thread			*threads[ THREADPOOL_MAX_THREADS ];
+static int					totalThreads	= 0;
+// circular queue of tasks
+static ThreadPoolTask_t		tasks[ THREADPOOL_MAX_TASKS ];
+static int					firstTask		= 0;
+static int					totalTasks		= 0;
+// protects the queue
+static SDL_mutex			*queueMutex		= NULL;
+// counts tasks into the queue (and wakes up workers when terminating)
+static SDL_sem				*queueSemaphore	= NULL;
+// signaled (with queueMutex) when a job is completed or new tasks are queued, wakes up the callers of ParallelFor
+static SDL_cond				*waitCondition	= NULL;
+// not 0 when workers must exit
+static SDL_atomic_t			terminating;
+
+// remove a task from the queue, returns false if the queue is empty
+static bool PopTask( ThreadPoolTask_t *task )
+{
+	bool result = false;
+	SDL_LockMutex( queueMutex );
+	if( totalTasks > 0 ) {
+		*task		= tasks[ firstTask ];
+		firstTask	= ( firstTask + 1 ) % THREADPOOL_MAX_TASKS;
+		totalTasks	-= 1;
+		result		= true;
+	}
+	SDL_UnlockMutex( queueMutex );
+	return result;
+}
+
+// execute a task and signal its completion
+static void RunTask( ThreadPoolTask_t *task )
+{
+	task->job->function( task->job->data, task->index );
+	// the caller may be waiting for the last task of the job (the job must not be used after the decrement)
+	if( SDL_AtomicAdd( &task->job->remaining, -1 ) == 1 ) {
+		SDL_LockMutex( queueMutex );
+		SDL_CondBroadcast( waitCondition );
+		SDL_UnlockMutex( queueMutex );
+	}
+}
+
+// main function of worker threads
+static int WorkerThread( void * )
+{
+	ThreadPoolTask_t task;
+	while( true ) {
+		SDL_SemWait( queueSemaphore );
+		if( PopTask( &task ) ) {
+			RunTask( &task );
+		} else if( SDL_AtomicGet( &terminating ) != 0 ) {
+			break;
+		}
+	}
+	return 0;
+}
+
+void ThreadPool::Initialize( int threadsCount )
+{
+	Terminate();
+	if( threadsCount <= 0 ) {
+		threadsCount = SDL_GetCPUCount() - 1;
+	}
+	threadsCount = ( threadsCount < THREADPOOL_MAX_THREADS ? threadsCount : THREADPOOL_MAX_THREADS );
+	queueMutex		= SDL_CreateMutex();
+	queueSemaphore	= SDL_CreateSemaphore( 0 );
+	waitCondition	= SDL_CreateCond();
+	firstTask		= 0;
+	totalTasks		= 0;
+	SDL_AtomicSet( &terminating, 0 );
+	if( ( queueMutex == NULL ) || ( queueSemaphore == NULL ) || ( waitCondition == NULL ) ) {
+		printf( "ThreadPool::Initialize: unable to create mutex, semaphore or condition, tasks will run on the caller thread\n" );
+		return;
+	}
+	for( int i = 0; i < threadsCount; i++ ) {
+		threads[ totalThreads ] = SDL_CreateThread( WorkerThread, "ThreadPool", NULL );
+		if( threads[ totalThreads ] == NULL ) {
+			printf( "ThreadPool::Initialize: unable to create thread %d\n", i );
+			break;
+		}
+		totalThreads += 1;
+	}
+}
+
+void ThreadPool::Terminate()
+{
+	// wake up all workers and wait their exit
+	SDL_AtomicSet( &terminating, 1 );
+	for( int i = 0; i < totalThreads; i++ ) {
+		SDL_SemPost( queueSemaphore );
+	}
+	for( int i = 0; i < totalThreads; i++ ) {
+		SDL_WaitThread( threads[ i ], NULL );
+		threads[ i ] = NULL;
+	}
+	totalThreads = 0;
+	if( queueSemaphore != NULL ) {
+		SDL_DestroySemaphore( queueSemaphore );
+		queueSemaphore = NULL;
+	}
+	if( waitCondition != NULL ) {
+		SDL_DestroyCond( waitCondition );
+		waitCondition = NULL;
+	}
+	if( queueMutex != NULL ) {
+		SDL_DestroyMutex( queueMutex );
+		queueMutex = NULL;
+	}
+}
+
+int ThreadPool::GetTotalThreads()
+{
+	return totalThreads;
+}
+
+void ThreadPool::ParallelFor( ThreadPoolFunction_t function, void *data, int count )
+{
+	// without workers (or with a single task) everything is executed here
+	if( ( totalThreads == 0 ) || ( count <= 1 ) ) {
+		for( int i = 0; i < count; i++ ) {
+			function( data, i );
+		}
+		return;
+	}
+	ThreadPoolJob_t job;
+	job.function	= function;
+	job.data		= data;
+	SDL_AtomicSet( &job.remaining, count );
+
+	// queue all tasks (tasks that don't fit into the queue are executed here)
+	int queued = 0;
+	SDL_LockMutex( queueMutex );
+	while( ( queued < count ) && ( totalTasks < THREADPOOL_MAX_TASKS ) ) {
+		ThreadPoolTask_t &task = tasks[ ( firstTask + totalTasks ) % THREADPOOL_MAX_TASKS ];
+		task.job	= &job;
+		task.index	= queued;
+		totalTasks	+= 1;
+		queued		+= 1;
+	}
+	// callers waiting for their jobs can help with the new tasks
+	SDL_CondBroadcast( waitCondition );
+	SDL_UnlockMutex( queueMutex );
+	for( int i = 0; i < queued; i++ ) {
+		SDL_SemPost( queueSemaphore );
+	}
+	for( int i = queued; i < count; i++ ) {
+		ThreadPoolTask_t task;
+		task.job	= &job;
+		task.index	= i;
+		RunTask( &task );
+	}
+
+	// help the workers until all tasks of the job are completed (tasks of other jobs may be executed too)
+	while( SDL_AtomicGet( &job.remaining ) > 0 ) {
+		ThreadPoolTask_t task;
+		if( SDL_SemTryWait( queueSemaphore ) == 0 ) {
+			if( PopTask( &task ) ) {
+				RunTask( &task );
+			}
+		} else {
+			// the remaining tasks have been taken by other threads: sleep until a job is completed or new tasks are queued
+			SDL_LockMutex( queueMutex );
+			if( SDL_AtomicGet( &job.remaining ) > 0 ) {
+				SDL_CondWait( waitCondition, queueMutex );
+			}
+			SDL_UnlockMutex( queueMutex );
+		}
+	}
+}
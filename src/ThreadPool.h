@@ -0,0 +1,41 @@
+/*
+ 	The information contained herein is confidential.
+ 	The use, copying, transfer or disclosure of such information is proibited
+ 	except by press written agreement with the author
+*/
+
+#ifndef _THREADPOOL_H_INCLUDE
+#define _THREADPOOL_H_INCLUDE
+
+#include <SDL.h>
+
+// maximum number of worker threads
+#define THREADPOOL_MAX_THREADS			16
+// maximum number of tasks waiting to be executed (tasks exceeding this are executed by the caller)
+#define THREADPOOL_MAX_TASKS			1024
+
+// function executed by the pool: data is shared by all tasks of a ParallelFor, index is the task number
+typedef void (*ThreadPoolFunction_t)( void *data, int index );
+
+/*
+	ThreadPool is a set of worker threads executing short tasks for the engine (e.g. particle simulation).
+	ParallelFor splits a job in tasks and returns when all of them are completed: the calling thread executes
+	tasks too while it waits, so ParallelFor can be called from inside a task without blocking the pool.
+	Tasks must not call SDL render functions (the renderer is not thread safe).
+*/
+namespace ThreadPool {
+
+	// create worker threads (0 = one for each core except the main one)
+	void Initialize( int totalThreads );
+
+	// stop and destroy worker threads
+	void Terminate();
+
+	// returns the number of worker threads (0 if all tasks are executed by the caller)
+	int GetTotalThreads();
+
+	// execute function( data, i ) for each i in [0, count) and wait their completion
+	void ParallelFor( ThreadPoolFunction_t function, void *data, int count );
+}
+
+#endif
@@ -0,0 +1,215 @@
+/*
+ 	The information contained herein is confidential.
+ 	The use, copying, transfer or disclosure of such information is proibited
+ 	except by press written agreement with the author
+*/
+
+#include <stdio.h>
+#include "TimelineManager.h"
+#include "ActionManager.h"
+#include "Misc.h"
+
+// loaded timelines
+static SequenceTemplate		*timelines[ TIMELINEMANAGER_MAX_TIMELINES ];
+// total number of loaded timelines
+static unsigned int			totalTimelines = 0;
+
+// create the action of a record, returns NULL if the record is invalid
+static Action* CreateAction( const TimelineActionRecord_t *record, Node *target, SplinePath **paths, unsigned int totalPaths, void ( *callback )( int, int ) )
+{
+	Action			*action = NULL;
+	const TimelineArg_t	*args = record->args;
+
+	switch( record->opcode ) {
+		case TIMELINE_OP_MOVE_TO:				action = new MoveTo( record->tag, target, args[ 0 ].f, args[ 1 ].f, record->duration );			break;
+		case TIMELINE_OP_ROTATE_TO:				action = new RotateTo( record->tag, target, args[ 0 ].f, record->duration );					break;
+		case TIMELINE_OP_SCALE_TO:				action = new ScaleTo( record->tag, target, args[ 0 ].f, record->duration );						break;
+		case TIMELINE_OP_SCALE_X_TO:			action = new ScaleXTo( record->tag, target, args[ 0 ].f, record->duration );					break;
+		case TIMELINE_OP_SCALE_Y_TO:			action = new ScaleYTo( record->tag, target, args[ 0 ].f, record->duration );					break;
+		case TIMELINE_OP_ALPHA_TO:				action = new AlphaTo( record->tag, target, args[ 0 ].i, record->duration );						break;
+		case TIMELINE_OP_BLINK:
+			// the duration of a blink is the duration of the action divided by the number of blinks
+			if( args[ 0 ].i <= 0 ) {
+				printf( "TimelineManager: invalid number of blinks %d\n", args[ 0 ].i );
+				return NULL;
+			}
+			action = new Blink( record->tag, target, args[ 0 ].i, record->duration );
+			break;
+		case TIMELINE_OP_SHAKE:					action = new Shake( record->tag, target, args[ 0 ].f, record->duration );						break;
+		case TIMELINE_OP_DELAY:					action = new DelayTime( record->duration );														break;
+		case TIMELINE_OP_SHOW:					action = new Show( target );																	break;
+		case TIMELINE_OP_HIDE:					action = new Hide( target );																	break;
+		case TIMELINE_OP_PLACE:					action = new Place( target, args[ 0 ].f, args[ 1 ].f );											break;
+		case TIMELINE_OP_ROTATE:				action = new Rotate( target, args[ 0 ].f );														break;
+		case TIMELINE_OP_SCALE:					action = new Scale( target, args[ 0 ].f );														break;
+		case TIMELINE_OP_ALPHA:					action = new Alpha( target, args[ 0 ].i );														break;
+		case TIMELINE_OP_REPEAT_FOREVER:		action = new RepeatForever();																	break;
+		case TIMELINE_OP_REPEAT_COUNT:
+			// the count is decremented before being checked, zero would wrap and repeat (almost) forever
+			if( args[ 0 ].u == 0 ) {
+				printf( "TimelineManager: invalid number of repeats %d\n", args[ 0 ].u );
+				return NULL;
+			}
+			action = new RepeatCount( args[ 0 ].u );
+			break;
+		case TIMELINE_OP_REPEAT_BACK_COUNT:
+			if( args[ 1 ].u == 0 ) {
+				printf( "TimelineManager: invalid number of repeats %d\n", args[ 1 ].u );
+				return NULL;
+			}
+			action = new RepeatBackCount( args[ 0 ].u, args[ 1 ].u );
+			break;
+		case TIMELINE_OP_CALLBACK:				action = new CallbackInteger( args[ 0 ].i, callback, args[ 1 ].i );								break;
+		case TIMELINE_OP_TINT_TO:
+			action = new SpriteTintTo( record->tag, target, (unsigned char)args[ 0 ].u, (unsigned char)args[ 1 ].u, (unsigned char)args[ 2 ].u, record->duration );
+			break;
+		case TIMELINE_OP_SPLINE_TO:
+			if( args[ 0 ].u >= totalPaths ) {
+				printf( "TimelineManager: invalid path index %d\n", args[ 0 ].u );
+				return NULL;
+			}
+			action = new SplineTo( record->tag, target, paths[ args[ 0 ].u ], record->duration, args[ 1 ].u != 0 );
+			break;
+		default:
+			printf( "TimelineManager: unknown opcode %d\n", record->opcode );
+			return NULL;
+	}
+	// set interpolation of interval actions
+	if( action->GetType() == ACTIONTYPE_INTERVAL ) {
+		static_cast< ActionInterval* >( action )->SetInterpolation( (Interpolation_t)record->interpolation );
+	}
+	return action;
+}
+
+bool TimelineManager::Load( const char *filename, void ( *callback )( int, int ) )
+{
+	Misc::MappedFile_t		file;
+	SplinePath				*paths[ TIMELINEMANAGER_MAX_PATHS ];
+	unsigned int			totalPaths = 0;
+	// timelines loaded before this file (the ones of this file are removed if the file is invalid)
+	unsigned int			firstTimeline = totalTimelines;
+	bool					result = false;
+
+	if( !Misc::MapFile( filename, &file ) ) {
+		return false;
+	}
+	const unsigned char *p		= file.data;
+	const unsigned char *end	= file.data + file.size;
+
+	do {
+		// check the header
+		if( end - p < (int)sizeof( TimelineFileHeader_t ) ) {
+			printf( "TimelineManager: %s is too short\n", filename );
+			break;
+		}
+		const TimelineFileHeader_t *header = (const TimelineFileHeader_t *)p;
+		p += sizeof( TimelineFileHeader_t );
+		if( ( header->magic != TIMELINE_FILE_MAGIC ) || ( header->version != TIMELINE_FILE_VERSION ) ) {
+			printf( "TimelineManager: %s is not a valid timelines file\n", filename );
+			break;
+		}
+		if( ( header->totalPaths > TIMELINEMANAGER_MAX_PATHS ) || ( header->totalTimelines > TIMELINEMANAGER_MAX_TIMELINES - totalTimelines ) ) {
+			printf( "TimelineManager: too many paths or timelines in %s\n", filename );
+			break;
+		}
+
+		// build the paths, their points are read straight from the file
+		bool valid = true;
+		for( unsigned int i = 0; valid && ( i < header->totalPaths ); i++ ) {
+			const TimelinePathHeader_t *pathHeader = (const TimelinePathHeader_t *)p;
+			if( ( end - p < (int)sizeof( TimelinePathHeader_t ) ) || 
+				( (unsigned int)( end - p - sizeof( TimelinePathHeader_t ) ) / sizeof( Coord_t ) < pathHeader->totalPoints ) ) {
+				printf( "TimelineManager: invalid path %d in %s\n", i, filename );
+				valid = false;
+				break;
+			}
+			p += sizeof( TimelinePathHeader_t );
+			paths[ totalPaths ] = new SplinePath( pathHeader->totalPoints, (const Coord_t *)p, pathHeader->tension );
+			totalPaths += 1;
+			p += pathHeader->totalPoints * sizeof( Coord_t );
+		}
+
+		// build a template for each timeline
+		for( unsigned int i = 0; valid && ( i < header->totalTimelines ); i++ ) {
+			const TimelineHeader_t *timelineHeader = (const TimelineHeader_t *)p;
+			if( ( end - p < (int)sizeof( TimelineHeader_t ) ) ||
+				( (unsigned int)( end - p - sizeof( TimelineHeader_t ) ) / sizeof( TimelineActionRecord_t ) < timelineHeader->totalActions ) ) {
+				printf( "TimelineManager: invalid timeline %d in %s\n", i, filename );
+				valid = false;
+				break;
+			}
+			// ids are unique among all loaded timelines
+			if( GetTimeline( timelineHeader->id ) != NULL ) {
+				printf( "TimelineManager: duplicate timeline %d in %s\n", timelineHeader->id, filename );
+				valid = false;
+				break;
+			}
+			p += sizeof( TimelineHeader_t );
+			SequenceTemplate *timeline = new SequenceTemplate( timelineHeader->id );
+			const TimelineActionRecord_t *records = (const TimelineActionRecord_t *)p;
+			for( unsigned int j = 0; j < timelineHeader->totalActions; j++ ) {
+				Action *action = CreateAction( &records[ j ], timeline->GetTarget(), paths, totalPaths, callback );
+				if( ( action == NULL ) || !timeline->AddAction( action ) ) {
+					delete action;
+					valid = false;
+					break;
+				}
+			}
+			p += timelineHeader->totalActions * sizeof( TimelineActionRecord_t );
+			if( !valid ) {
+				printf( "TimelineManager: invalid action in timeline %d of %s\n", timelineHeader->id, filename );
+				delete timeline;
+				break;
+			}
+			timelines[ totalTimelines ] = timeline;
+			totalTimelines += 1;
+		}
+		result = valid;
+	} while( false );
+
+	// a file is loaded entirely or not at all
+	if( !result ) {
+		for( unsigned int i = firstTimeline; i < totalTimelines; i++ ) {
+			delete timelines[ i ];
+			timelines[ i ] = NULL;
+		}
+		totalTimelines = firstTimeline;
+	}
+
+	// the actions keep their own reference to the paths they use
+	for( unsigned int i = 0; i < totalPaths; i++ ) {
+		paths[ i ]->Release();
+	}
+	Misc::UnmapFile( &file );
+	return result;
+}
+
+void TimelineManager::Unload()
+{
+	for( unsigned int i = 0; i < totalTimelines; i++ ) {
+		delete timelines[ i ];
+		timelines[ i ] = NULL;
+	}
+	totalTimelines = 0;
+}
+
+SequenceTemplate* TimelineManager::GetTimeline( unsigned int id )
+{
+	for( unsigned int i = 0; i < totalTimelines; i++ ) {
+		if( timelines[ i ]->GetTag() == id ) {
+			return timelines[ i ];
+		}
+	}
+	return NULL;
+}
+
+bool TimelineManager::Run( unsigned int id, Node *target, float timeOffset )
+{
+	SequenceTemplate *timeline = GetTimeline( id );
+	if( timeline == NULL ) {
+		printf( "TimelineManager: timeline %d not loaded\n", id );
+		return false;
+	}
+	ActionManager::RunTemplate( timeline, target, timeOffset );
+	return true;
+}
@@ -0,0 +1,114 @@
+/*
+ 	The information contained herein is confidential.
+ 	The use, copying, transfer or disclosure of such information is proibited
+ 	except by press written agreement with the author
+*/
+
+#ifndef _TIMELINEMANAGER_H_INCLUDE
+#define _TIMELINEMANAGER_H_INCLUDE
+
+#include "EngineCommon.h"
+#include "Actions.h"
+
+// maximum number of timelines loaded at the same time
+#define TIMELINEMANAGER_MAX_TIMELINES		256
+
+// maximum number of paths loaded at the same time
+#define TIMELINEMANAGER_MAX_PATHS			256
+
+/*
+	Binary format of the timelines file (all values are 32 bit little endian, floats are IEEE 754):
+
+	header				TimelineFileHeader_t
+	paths				for each path: TimelinePathHeader_t followed by totalPoints couples of floats (x, y)
+	timelines			for each timeline: TimelineHeader_t followed by totalActions TimelineActionRecord_t
+
+	Actions of a timeline are applied to the node the timeline is run on.
+*/
+
+// "ATL1"
+#define TIMELINE_FILE_MAGIC			0x314C5441
+#define TIMELINE_FILE_VERSION		1
+
+typedef struct {
+	uint32_t	magic;
+	uint32_t	version;
+	uint32_t	totalPaths;
+	uint32_t	totalTimelines;
+} TimelineFileHeader_t;
+
+typedef struct {
+	uint32_t	totalPoints;
+	float		tension;
+} TimelinePathHeader_t;
+
+typedef struct {
+	uint32_t	id;				// unique among all loaded timelines
+	uint32_t	totalActions;
+} TimelineHeader_t;
+
+// opcodes of the actions (parameters are listed in brackets)
+typedef enum {
+	TIMELINE_OP_MOVE_TO = 1,			// x, y
+	TIMELINE_OP_ROTATE_TO,				// angle
+	TIMELINE_OP_SCALE_TO,				// scale
+	TIMELINE_OP_SCALE_X_TO,				// scale
+	TIMELINE_OP_SCALE_Y_TO,				// scale
+	TIMELINE_OP_ALPHA_TO,				// alpha (integer)
+	TIMELINE_OP_SPLINE_TO,				// path index (integer), orient to path (integer 0 or 1)
+	TIMELINE_OP_BLINK,					// blinks (integer, > 0)
+	TIMELINE_OP_SHAKE,					// radius
+	TIMELINE_OP_TINT_TO,				// r, g, b (integers), target must be a Sprite
+	TIMELINE_OP_DELAY,					// -
+	TIMELINE_OP_SHOW,					// -
+	TIMELINE_OP_HIDE,					// -
+	TIMELINE_OP_PLACE,					// x, y
+	TIMELINE_OP_ROTATE,					// angle
+	TIMELINE_OP_SCALE,					// scale
+	TIMELINE_OP_ALPHA,					// alpha (integer)
+	TIMELINE_OP_REPEAT_FOREVER,			// -
+	TIMELINE_OP_REPEAT_COUNT,			// times (integer, > 0)
+	TIMELINE_OP_REPEAT_BACK_COUNT,		// actions back (integer), times (integer, > 0)
+	TIMELINE_OP_CALLBACK,				// callback id (integer), value (integer)
+} TimelineOpcode_t;
+
+typedef union {
+	float		f;
+	uint32_t	u;
+	int32_t		i;
+} TimelineArg_t;
+
+// a single action (32 bytes)
+typedef struct {
+	uint16_t		opcode;				// see TimelineOpcode_t
+	uint16_t		interpolation;		// see Interpolation_t (interval actions only)
+	uint32_t		tag;				// tag of the action
+	float			duration;			// milliseconds (interval actions only)
+	TimelineArg_t	args[ 4 ];			// parameters
+	uint32_t		reserved;
+} TimelineActionRecord_t;
+
+/*
+	This is the TimelineManager, it loads animations (timelines) from a binary file instead of building them in code.
+	The file is mapped in memory and each timeline is converted once into a SequenceTemplate (see Actions.h): 
+	running a timeline costs the same as running a template, no parsing nor allocation is done at run time.
+	Callbacks are identified by an id: when the timeline reaches a callback action, the callback passed to 
+	Load is called with the id and the value of the action.
+*/
+namespace TimelineManager {
+
+	// load all timelines of a file (callback may be NULL), returns false if the file is invalid (in that case
+	// no timeline of the file is loaded)
+	bool Load( const char *filename, void ( *callback )( int, int ) );
+
+	// unload all timelines (no timeline must be running)
+	void Unload();
+
+	// returns the template of a timeline, NULL if not loaded
+	SequenceTemplate* GetTimeline( unsigned int id );
+
+	// run a timeline on a node after timeOffset milliseconds, returns false if the timeline is not loaded
+	bool Run( unsigned int id, Node *target, float timeOffset = 0 );
+};
+
+#endif